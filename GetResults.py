@@ -1,4 +1,5 @@
 import os
+import re
 import glob
 import time
 import numpy as np
@@ -127,7 +128,13 @@ def testWorld(size, cost, startWorldId):
 
 
 def runAlgorithm(algorithm, world):
+    # Parallel algorithms are listed as <executable>_<number of threads>,
+    # which is also the name their results are written under
     command = "./" + algorithm + " " + world
+    threads = re.match(r"^(\w+?)_(\d+)$", algorithm)
+    if threads:
+        command = "./" + threads.group(1) + " " + world + " --threads " \
+            + threads.group(2)
     runCommand(command)
 
     startX = ""
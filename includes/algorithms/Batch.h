@@ -0,0 +1,56 @@
+/**
+ * File        : Batch.h
+ * Description : Solves a whole file of queries on one world that is loaded
+ *               once. The queries are spread over several workers, each with
+ *               its own solver, and every result is written out as soon as
+ *               it is found.
+ */
+
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "algorithms/Solver.h"
+#include "common/Queries.h"
+#include "common/World.h"
+
+namespace pathFind
+{
+
+typedef struct batchResult_t
+{
+    size_t numSolved = 0;
+    uint numWorkers = 0;
+    // Wall clock time of the whole batch
+    double seconds = 0;
+    // Microseconds each query took from asking its solver to getting the
+    // path back, in the order of the queries
+    std::vector<uint> latencies;
+} batchResult_t;
+
+/**
+ * Solves every query with the named algorithm from the default registry.
+ * Results are written to out in the order they finish, one line per query:
+ * "<query index> <total cost> <microseconds>" followed by the path from start
+ * to end as "<x> <y>" pairs if writePaths is set, or "<query index> none
+ * <microseconds>" when there is no path. Throws std::out_of_range if there is
+ * no such algorithm and std::invalid_argument if the world's neighbor masks
+ * have not been built. Each worker's solver is prepared for worldFile, the
+ * file world was loaded from, before it solves anything.
+ * @param numWorkers    Queries solved at once, 0 for enough to keep every
+ *                      core busy with the threads each search uses.
+ */
+batchResult_t solveBatch (const std::string& algName, const World& world, const std::string& worldFile,
+                          const std::vector<query_t>& queries, std::ostream& out,
+                          uint numWorkers = 0, const solveOptions_t& options = solveOptions_t (),
+                          bool writePaths = false);
+
+// Latency that fraction (in [0, 1]) of the queries finished within
+uint getLatencyPercentile (const std::vector<uint>& latencies, double fraction);
+
+} /* namespace pathFind */
+
+#endif /* BATCH_H_ */
@@ -0,0 +1,108 @@
+/**
+ * File        : Solver.h
+ * Description : The interface every path-finding algorithm implements, so an
+ *               algorithm can be run in process on a world that is already
+ *               loaded instead of through its executable. Solvers are made
+ *               by name through the SolverRegistry.
+ */
+
+#ifndef SOLVER_H_
+#define SOLVER_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/Point.h"
+#include "common/Results.h"
+#include "common/World.h"
+
+namespace pathFind
+{
+
+typedef struct solveOptions_t
+{
+    // Number of threads a parallel algorithm runs with, 0 keeps the number
+    // the algorithm was registered with (or the number of cores if it was
+    // registered without one). Serial algorithms ignore it.
+    uint numThreads = 0;
+} solveOptions_t;
+
+typedef struct pathResult_t
+{
+    // False if no path was found, the rest is then left empty
+    bool found = false;
+    // From the end back to the start
+    std::vector<Point> path;
+    // Cost of every tile entered except the end
+    uint totalCost = 0;
+    // Time the search itself took, without setting up or reading back the path
+    uint ms = 0;
+    // Tiles each thread touched, only filled in builds with GEN_STATS
+    std::vector<std::unordered_map<tileId_t, StatPoint>> stats;
+} pathResult_t;
+
+class Solver
+{
+public:
+
+    Solver () = delete;
+    virtual ~Solver ();
+
+    Solver (const Solver&) = delete;
+    Solver& operator= (const Solver&) = delete;
+
+    // The name results are written under, e.g. "aStar_4ary"
+    const std::string& getName () const;
+    // Whether solveOptions_t::numThreads means anything to this solver
+    virtual bool isParallel () const;
+    // The number of threads a search with these options keeps busy
+    virtual uint getThreadsPerSearch (const solveOptions_t& options) const;
+
+    /**
+     * Finds a path from start to end. A solver runs one search at a time, so
+     * searching from several threads at once needs one solver per thread.
+     * @param world     Must have its neighbor masks built, otherwise
+     *                  std::invalid_argument is thrown.
+     * @param start     Start of the path, must be an open tile.
+     * @param end       End of the path, must be an open tile.
+     * @param options   Tuning that applies to this search only.
+     * @return          The path found, with found false if the end can not
+     *                  be reached from the start.
+     */
+    pathResult_t solve (const World& world, const Point& start, const Point& end,
+                        const solveOptions_t& options = solveOptions_t ());
+
+    /**
+     * Lets a solver that precomputes data about a world do so before its
+     * searches, saving the data next to the world file and loading it back on
+     * later runs. Solvers that precompute nothing ignore it, and ones that
+     * are not prepared for the world they search precompute in memory.
+     * @param worldFile The file the world was loaded from.
+     * @return          False if the precomputed data could not be saved.
+     */
+    virtual bool prepare (const World& world, const std::string& worldFile);
+
+protected:
+
+    explicit Solver (const std::string& name);
+
+    // The number of threads to search with: the one asked for in options,
+    // else registeredThreads, else one per core
+    static uint getNumThreads (const solveOptions_t& options, uint registeredThreads);
+
+    // Runs the algorithm, solve has already ruled out points the world's
+    // component labels say are not connected. Worlds without labels still
+    // get those, so a search must end unfound once it runs out of tiles.
+    // Queries that start at their end are answered without a search.
+    virtual pathResult_t search (const World& world, const Point& start, const Point& end,
+                                 const solveOptions_t& options) = 0;
+
+private:
+
+    std::string m_name;
+};
+
+} /* namespace pathFind */
+
+#endif /* SOLVER_H_ */
@@ -0,0 +1,80 @@
+/**
+ * File        : SolverRegistry.h
+ * Description : Maps algorithm names (the names of their executables and of
+ *               their result files, e.g. "dijkstra" or "aStar_4ary") to
+ *               factories for their solvers, and runs a query through an
+ *               algorithm picked by name.
+ */
+
+#ifndef SOLVERREGISTRY_H_
+#define SOLVERREGISTRY_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "algorithms/Solver.h"
+
+namespace pathFind
+{
+
+class SolverRegistry
+{
+public:
+
+    typedef std::function<std::unique_ptr<Solver> ()> factory_t;
+
+    // An empty registry, see getDefault for one with every algorithm in it
+    SolverRegistry ();
+
+    // The registry of every algorithm this project implements
+    static const SolverRegistry& getDefault ();
+
+    // Replaces any factory already added under the same name
+    void add (const std::string& name, factory_t factory);
+    // Adds a factory that makes a SolverType from the name followed by args
+    template <class SolverType, class... Args>
+    void emplace (const std::string& name, Args... args);
+    bool contains (const std::string& name) const;
+    // Returns a null pointer if no algorithm is called name
+    std::unique_ptr<Solver> create (const std::string& name) const;
+    // In alphabetical order
+    std::vector<std::string> getNames () const;
+
+private:
+
+    std::map<std::string, factory_t> m_factories;
+};
+
+template <class SolverType, class... Args>
+void SolverRegistry::emplace (const std::string& name, Args... args)
+{
+    add (name, [name, args...] ()
+    {
+        return std::unique_ptr<Solver> (new SolverType (name, args...));
+    });
+}
+
+/**
+ * Solves a single query with a new solver for the named algorithm from the
+ * default registry. Throws std::out_of_range if there is no such algorithm.
+ * Running several queries through one solver from SolverRegistry::create
+ * saves setting a new one up for each.
+ */
+pathResult_t solve (const std::string& algName, const World& world,
+                    const Point& start, const Point& end,
+                    const solveOptions_t& options = solveOptions_t ());
+
+/**
+ * What every algorithm executable runs: loads the world named on the command
+ * line, reads the start and end points from the command line or the world's
+ * .path file, solves the query with the named algorithm and writes the path
+ * and performance files under results/.
+ */
+int runSolverMain (const std::string& algName, int args, char* argv[]);
+
+} /* namespace pathFind */
+
+#endif /* SOLVERREGISTRY_H_ */
@@ -0,0 +1,472 @@
+/**
+ * File        : BucketQueue.h
+ * Description : A bucket queue (Dial's algorithm) with the same interface as
+ *               the PriorityQueue. Tile costs and the Manhattan heuristic are
+ *               small integers, so every tile is kept in a bucket for its
+ *               combined heuristic and the queue just walks the buckets in
+ *               order. Lowering the cost of a tile adds a new entry and leaves
+ *               the old one behind to be skipped when it is reached.
+ */
+
+#ifndef BUCKETQUEUE_H_
+#define BUCKETQUEUE_H_
+
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <new>
+#include <vector>
+#include <memory>
+
+#include "algorithms/tools/Heuristics.h"
+#include "algorithms/tools/PathTile.h"
+#include "common/World.h"
+
+namespace pathFind
+{
+
+// Order in which tiles with the same combined heuristic leave a bucket.
+// LIFO hands back the most recently reached tile first, which for A* is
+// usually the one closest to the goal.
+enum class TieBreak
+{
+    LIFO,
+    FIFO
+};
+
+template <class Heuristic = ZeroHeuristic>
+class BucketQueue
+{
+public:
+
+    typedef Heuristic heuristic_t;
+
+    BucketQueue () = delete;
+    BucketQueue (size_t worldWidth, size_t worldHeight,
+                 Heuristic heuristic = Heuristic (),
+                 TieBreak tieBreak = TieBreak::LIFO);
+    BucketQueue (const World& world,
+                 Heuristic heuristic = Heuristic (),
+                 TieBreak tieBreak = TieBreak::LIFO);
+
+    void push (const World::tile_t& tile, const Point& xy, uint bestCost = PathTile::INF);
+    void push (const World::tile_t& tile, const Point& xy, uint bestCost,
+               const Point& bestTile);
+    void push (const PathTile& tile);
+    void pop ();
+    PathTile top () const;
+    bool empty () const;
+
+    void changeBestCost (uint x, uint y, uint bestCost);
+    void tryUpdateBestCost (const World::tile_t& tile, const Point& targetXY,
+                            const PathTile& bestTile);
+
+    bool isValid (uint x, uint y) const;
+    // Assumes that user already checked that (x, y) is valid
+    PathTile getPathTile (uint x, uint y) const;
+
+    // Empties the queue for a new search that uses a new heuristic. Only
+    // costs as much as the tiles left in the queue.
+    void reset (Heuristic heuristic);
+
+private:
+
+    const static uint32_t NO_SLOT = 0;
+    // Enough for the spread of combined heuristics in the queue at any one
+    // time when tiles cost at most 255 and the heuristic is consistent
+    const static size_t INITIAL_BUCKETS = 512;
+
+    struct freeDeleter_t
+    {
+        void operator() (uint32_t* slots) const
+        {
+            std::free (slots);
+        }
+    };
+
+    struct bucket_t
+    {
+        std::vector<uint32_t> nodes;
+        size_t head = 0;
+    };
+
+    bool findNode (uint x, uint y, uint32_t& node) const;
+    // A node is live until it is popped or its tile is pushed again
+    bool isLive (uint32_t node) const;
+
+    bool isEmpty (const bucket_t& bucket) const;
+    uint32_t front (const bucket_t& bucket) const;
+    void dropFront (bucket_t& bucket);
+
+    // Put a live node in the bucket for its combined heuristic
+    void enqueue (uint32_t node);
+    // Rebuild the buckets with room for every key between m_current and
+    // m_maxKey
+    void grow ();
+    // Drop dead entries until the front of the current bucket (or of the
+    // unreached tiles once no finite keys are left) is live
+    void settle ();
+
+    size_t m_worldWidth;
+    size_t m_worldHeight;
+
+    TieBreak m_tieBreak;
+
+    // Every tile ever pushed, entries of the buckets index into this
+    std::vector<PathTile> m_nodes;
+    // Node + 1 for every tile id currently in the queue, see PriorityQueue
+    std::unique_ptr<uint32_t, freeDeleter_t> m_slots;
+
+    // Keys are stored modulo the (power of two) number of buckets
+    std::vector<bucket_t> m_buckets;
+    size_t m_bucketMask;
+    uint m_current;
+    uint m_maxKey;
+
+    // Tiles whose best cost is still INF
+    bucket_t m_unreached;
+    size_t m_numUnreached;
+    size_t m_size;
+
+    Heuristic m_heurFunct;
+};
+
+template <class Heuristic>
+BucketQueue<Heuristic>::BucketQueue (size_t worldWidth, size_t worldHeight,
+                                     Heuristic heuristic,
+                                     TieBreak tieBreak)
+    : m_worldWidth (worldWidth),
+      m_worldHeight (worldHeight),
+      m_tieBreak (tieBreak),
+      m_slots (static_cast<uint32_t*> (std::calloc (worldWidth * worldHeight, sizeof (uint32_t)))),
+      m_buckets (INITIAL_BUCKETS),
+      m_bucketMask (INITIAL_BUCKETS - 1),
+      m_current (0),
+      m_maxKey (0),
+      m_numUnreached (0),
+      m_size (0),
+      m_heurFunct (heuristic)
+{
+    if (!m_slots && worldWidth * worldHeight != 0)
+    {
+        throw std::bad_alloc ();
+    }
+}
+
+template <class Heuristic>
+BucketQueue<Heuristic>::BucketQueue (const World& world, Heuristic heuristic,
+                                     TieBreak tieBreak)
+    : BucketQueue (world.getWidth (), world.getHeight (), heuristic, tieBreak)
+{
+    m_nodes.reserve (world.getNumOpenTiles ());
+    for (uint y = 0; y < m_worldHeight; ++y)
+    {
+        for (uint x = 0; x < m_worldWidth; ++x)
+        {
+            World::tile_t t = world (x, y);
+            if (t.cost != 0)
+            {
+                push (PathTile {t, {x, y}, m_heurFunct (x, y)});
+            }
+        }
+    }
+}
+
+template <class Heuristic>
+void BucketQueue<Heuristic>::push (const World::tile_t& tile, const Point& xy, uint bestCost)
+{
+    PathTile p {tile, xy, m_heurFunct (xy.x, xy.y)};
+    p.setBestCost (bestCost);
+    push (p);
+}
+
+template <class Heuristic>
+void BucketQueue<Heuristic>::push (const World::tile_t& tile, const Point& xy,
+                                   uint bestCost, const Point& bestTile)
+{
+    PathTile p {tile, xy, m_heurFunct (xy.x, xy.y)};
+    p.setBestCost (bestCost);
+    p.setBestTile (bestTile);
+    push (p);
+}
+
+template <class Heuristic>
+void BucketQueue<Heuristic>::push (const PathTile& tile)
+{
+    // Pushing a tile that is already queued replaces it
+    uint32_t old;
+    if (findNode (tile.xy ().x, tile.xy ().y, old))
+    {
+        --m_size;
+        if (m_nodes[old].getCombinedHeuristic () == PathTile::INF)
+        {
+            --m_numUnreached;
+        }
+    }
+
+    uint32_t node = m_nodes.size ();
+    m_nodes.push_back (tile);
+    m_slots.get ()[tile.getTile ().id] = node + 1;
+    ++m_size;
+    enqueue (node);
+    settle ();
+}
+
+template <class Heuristic>
+void BucketQueue<Heuristic>::pop ()
+{
+    if (m_size == 0)
+    {
+        return;
+    }
+
+    bool unreached = m_size == m_numUnreached;
+    bucket_t& bucket = unreached ? m_unreached : m_buckets[m_current & m_bucketMask];
+    uint32_t node = front (bucket);
+    if (unreached)
+    {
+        --m_numUnreached;
+    }
+    m_slots.get ()[m_nodes[node].getTile ().id] = NO_SLOT;
+    --m_size;
+    dropFront (bucket);
+    settle ();
+}
+
+template <class Heuristic>
+PathTile BucketQueue<Heuristic>::top () const
+{
+    if (m_size > m_numUnreached)
+    {
+        return m_nodes[front (m_buckets[m_current & m_bucketMask])];
+    }
+    return m_nodes[front (m_unreached)];
+}
+
+template <class Heuristic>
+bool BucketQueue<Heuristic>::empty () const
+{
+    return m_size == 0;
+}
+
+template <class Heuristic>
+void BucketQueue<Heuristic>::changeBestCost (uint x, uint y, uint bestCost)
+{
+    uint32_t node;
+    if (findNode (x, y, node))
+    {
+        if (m_nodes[node].getCombinedHeuristic () == PathTile::INF)
+        {
+            --m_numUnreached;
+        }
+        m_nodes[node].setBestCost (bestCost);
+        enqueue (node);
+        settle ();
+    }
+}
+
+template <class Heuristic>
+void BucketQueue<Heuristic>::tryUpdateBestCost (const World::tile_t& tile, const Point& targetXY,
+                                                const PathTile& bestTile)
+{
+    uint32_t node;
+    if (findNode (targetXY.x, targetXY.y, node))
+    {
+        PathTile& target = m_nodes[node];
+        uint totalCost = bestTile.getBestCost () + target.getTile ().cost;
+        if (totalCost < target.getBestCost ())
+        {
+            if (target.getBestCost () == PathTile::INF)
+            {
+                --m_numUnreached;
+            }
+            target.setBestTile (bestTile.xy ());
+            target.setBestCost (totalCost);
+            enqueue (node);
+            settle ();
+        }
+    }
+    else
+    {
+        push (tile, targetXY, tile.cost + bestTile.getBestCost (), bestTile.xy ());
+    }
+}
+
+template <class Heuristic>
+bool BucketQueue<Heuristic>::isValid (uint x, uint y) const
+{
+    uint32_t node;
+    return findNode (x, y, node);
+}
+
+template <class Heuristic>
+PathTile BucketQueue<Heuristic>::getPathTile (uint x, uint y) const
+{
+    uint32_t node = 0;
+    findNode (x, y, node);
+    return m_nodes[node];
+}
+
+template <class Heuristic>
+void BucketQueue<Heuristic>::reset (Heuristic heuristic)
+{
+    // Nodes are never removed from m_nodes, so it holds every tile that
+    // may still have a slot
+    for (uint32_t node = 0; node < m_nodes.size (); ++node)
+    {
+        if (isLive (node))
+        {
+            m_slots.get ()[m_nodes[node].getTile ().id] = NO_SLOT;
+        }
+    }
+    m_nodes.clear ();
+    for (bucket_t& bucket : m_buckets)
+    {
+        bucket.nodes.clear ();
+        bucket.head = 0;
+    }
+    m_unreached.nodes.clear ();
+    m_unreached.head = 0;
+    m_current = 0;
+    m_maxKey = 0;
+    m_numUnreached = 0;
+    m_size = 0;
+    m_heurFunct = heuristic;
+}
+
+template <class Heuristic>
+bool BucketQueue<Heuristic>::findNode (uint x, uint y, uint32_t& node) const
+{
+    if (x < m_worldWidth && y < m_worldHeight)
+    {
+        uint32_t slot = m_slots.get ()[(m_worldWidth * y) + x];
+        if (slot != NO_SLOT)
+        {
+            node = slot - 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <class Heuristic>
+bool BucketQueue<Heuristic>::isLive (uint32_t node) const
+{
+    return m_slots.get ()[m_nodes[node].getTile ().id] == node + 1;
+}
+
+template <class Heuristic>
+bool BucketQueue<Heuristic>::isEmpty (const bucket_t& bucket) const
+{
+    return bucket.head == bucket.nodes.size ();
+}
+
+template <class Heuristic>
+uint32_t BucketQueue<Heuristic>::front (const bucket_t& bucket) const
+{
+    return m_tieBreak == TieBreak::LIFO ? bucket.nodes.back () : bucket.nodes[bucket.head];
+}
+
+template <class Heuristic>
+void BucketQueue<Heuristic>::dropFront (bucket_t& bucket)
+{
+    if (m_tieBreak == TieBreak::LIFO)
+    {
+        bucket.nodes.pop_back ();
+    }
+    else if (++bucket.head == bucket.nodes.size ())
+    {
+        bucket.nodes.clear ();
+        bucket.head = 0;
+    }
+}
+
+template <class Heuristic>
+void BucketQueue<Heuristic>::enqueue (uint32_t node)
+{
+    uint key = m_nodes[node].getCombinedHeuristic ();
+    if (key == PathTile::INF)
+    {
+        m_unreached.nodes.push_back (node);
+        ++m_numUnreached;
+        return;
+    }
+
+    // The node being queued is already counted in m_size, so it is the
+    // only finite key if that is all that is left
+    if (m_size - m_numUnreached == 1)
+    {
+        m_current = key;
+        m_maxKey = key;
+    }
+    else if (key < m_current || key > m_maxKey)
+    {
+        m_current = std::min (m_current, key);
+        m_maxKey = std::max (m_maxKey, key);
+        if (m_maxKey - m_current > m_bucketMask)
+        {
+            grow ();
+            return;
+        }
+    }
+    m_buckets[key & m_bucketMask].nodes.push_back (node);
+}
+
+template <class Heuristic>
+void BucketQueue<Heuristic>::grow ()
+{
+    size_t numBuckets = m_buckets.size ();
+    while (m_maxKey - m_current >= numBuckets)
+    {
+        numBuckets *= 2;
+    }
+
+    // Only the live entry of each node needs to survive the move
+    m_buckets.assign (numBuckets, bucket_t ());
+    m_bucketMask = numBuckets - 1;
+    for (uint32_t node = 0; node < m_nodes.size (); ++node)
+    {
+        uint key = m_nodes[node].getCombinedHeuristic ();
+        if (key != PathTile::INF && isLive (node))
+        {
+            m_buckets[key & m_bucketMask].nodes.push_back (node);
+        }
+    }
+}
+
+template <class Heuristic>
+void BucketQueue<Heuristic>::settle ()
+{
+    if (m_size == m_numUnreached)
+    {
+        while (!isEmpty (m_unreached) &&
+               (!isLive (front (m_unreached)) ||
+                m_nodes[front (m_unreached)].getCombinedHeuristic () != PathTile::INF))
+        {
+            dropFront (m_unreached);
+        }
+        return;
+    }
+
+    // A live node always has an entry in the bucket of its current key, so
+    // the walk stops by m_maxKey at the latest
+    while (true)
+    {
+        bucket_t& bucket = m_buckets[m_current & m_bucketMask];
+        while (!isEmpty (bucket) &&
+               (!isLive (front (bucket)) ||
+                m_nodes[front (bucket)].getCombinedHeuristic () != m_current))
+        {
+            dropFront (bucket);
+        }
+        if (!isEmpty (bucket))
+        {
+            return;
+        }
+        ++m_current;
+    }
+}
+
+} /* namespace pathFind */
+
+#endif /* BUCKETQUEUE_H_ */
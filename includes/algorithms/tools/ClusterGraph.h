@@ -0,0 +1,185 @@
+/**
+ * File        : ClusterGraph.h
+ * Description : The abstract graph HPA* searches. The world is cut into square
+ *               clusters and wherever open tiles face each other across the
+ *               border of two clusters, a few of those pairs become entrances:
+ *               the middle pair of each run of open pairs, or both end pairs
+ *               of a wide one. Each tile of an entrance is a node, linked to
+ *               the tile across the border and to every other node of its
+ *               cluster by the cost of the cheapest path between them that
+ *               stays inside the cluster. Entrances and distances are found
+ *               for all clusters in parallel, and graphs are saved next to
+ *               their world (.hpa) and only loaded back for the exact world
+ *               they were built from.
+ */
+
+#ifndef CLUSTERGRAPH_H_
+#define CLUSTERGRAPH_H_
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "common/Point.h"
+#include "common/World.h"
+
+namespace pathFind
+{
+
+class ClusterGraph
+{
+public:
+
+    const static std::string CLUSTER_GRAPH_EXT;
+    const static uint DEFAULT_CLUSTER_SIZE = 64;
+    const static uint32_t NO_NODE = std::numeric_limits<uint32_t>::max();
+    const static uint32_t INF = std::numeric_limits<uint32_t>::max();
+
+    typedef struct node_t
+    {
+        uint32_t x;
+        uint32_t y;
+        // The node across the border to the east or west, then to the south
+        // or north, NO_NODE if the tile is not part of such an entrance
+        uint32_t links[2];
+    } node_t;
+
+    // Costs and parents of a searchCluster, by getLocalIndex
+    typedef struct clusterSearch_t
+    {
+        std::vector<uint32_t> costs;
+        std::vector<uint32_t> parents;
+    } clusterSearch_t;
+
+    // An empty graph, see build and load
+    ClusterGraph ();
+
+    ClusterGraph (const ClusterGraph&) = delete;
+    ClusterGraph& operator= (const ClusterGraph&) = delete;
+
+    /**
+     * Computes the graph from the world's neighbor masks, which must be built.
+     * @param numThreads  Clusters worked on at once, on the shared WorkerPool.
+     */
+    void build (const World& world, uint clusterSize = DEFAULT_CLUSTER_SIZE, uint numThreads = 1);
+
+    /**
+     * Loads a graph saved by save. Returns false, leaving the graph empty, if
+     * the file can't be read or was saved for a world with other dimensions
+     * or tile costs.
+     */
+    bool load (const std::string& fileName, const World& world);
+    bool save (const std::string& fileName, const World& world) const;
+
+    // Whether the graph was built for a world of these dimensions
+    bool fits (const World& world) const;
+
+    size_t getNumNodes () const;
+    uint getCluster (uint x, uint y) const;
+    // The nodes of a cluster are getFirstNode (cluster) up to but not
+    // including getFirstNode (cluster + 1)
+    uint32_t getFirstNode (uint cluster) const;
+    const node_t& getNode (uint32_t node) const;
+
+    // Cost of the cheapest path from one node to another of the same cluster
+    // that stays inside it, counting the tiles entered. INF if there is none.
+    uint32_t getDistance (uint32_t from, uint32_t to) const;
+
+    // Index of a tile within its cluster, for the results of searchCluster
+    uint getLocalIndex (uint x, uint y) const;
+
+    /**
+     * Dijkstra from a tile over the tiles of its cluster. Each parent is the
+     * local index of the tile the cheapest path came from, and the start is
+     * its own parent. If target is given the search stops once the cheapest
+     * path to it is known.
+     */
+    void searchCluster (const World& world, const Point& from, const Point* target,
+                        clusterSearch_t& search) const;
+
+    // Appends the path a searchCluster from from found to to, leaving out to
+    // and going back to from, which is appended last unless it is to itself
+    void getClusterPath (const clusterSearch_t& search, const Point& from, const Point& to,
+                         std::vector<Point>& path) const;
+
+private:
+
+    // Entrances narrower than this get one pair in their middle, wider ones
+    // a pair at each end
+    const static uint MAX_ENTRANCE_WIDTH = 6;
+
+    typedef struct fileHeader_t
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t clusterSize;
+        uint64_t width;
+        uint64_t height;
+        uint64_t checksum;
+        uint64_t numNodes;
+        uint64_t numDistances;
+    } fileHeader_t;
+
+    // A pair of facing open tiles that is an entrance, the first one is in
+    // the cluster the pair was found for and the second to its east or south
+    typedef struct transition_t
+    {
+        Point inside;
+        Point outside;
+    } transition_t;
+
+    void findTransitions (const World& world, uint cluster, std::vector<transition_t>& transitions) const;
+    uint32_t findNode (const Point& tile) const;
+
+    size_t m_clusterSize;
+    size_t m_width;
+    size_t m_height;
+    size_t m_clustersWide;
+    // Index of the first node of each cluster, with one past the last node
+    // at the end
+    std::vector<uint32_t> m_firstNodes;
+    // By cluster and then row major within it
+    std::vector<node_t> m_nodes;
+    // Where the distance matrix of each cluster starts, with the total at
+    // the end. A cluster of n nodes has n * n distances, row by row.
+    std::vector<uint64_t> m_distanceOffsets;
+    std::vector<uint32_t> m_distances;
+};
+
+inline size_t ClusterGraph::getNumNodes () const
+{
+    return m_nodes.size ();
+}
+
+inline uint ClusterGraph::getCluster (uint x, uint y) const
+{
+    return (y / m_clusterSize) * m_clustersWide + (x / m_clusterSize);
+}
+
+inline uint32_t ClusterGraph::getFirstNode (uint cluster) const
+{
+    return m_firstNodes[cluster];
+}
+
+inline const ClusterGraph::node_t& ClusterGraph::getNode (uint32_t node) const
+{
+    return m_nodes[node];
+}
+
+inline uint32_t ClusterGraph::getDistance (uint32_t from, uint32_t to) const
+{
+    uint cluster = getCluster (m_nodes[from].x, m_nodes[from].y);
+    uint32_t first = m_firstNodes[cluster];
+    uint32_t numNodes = m_firstNodes[cluster + 1] - first;
+    return m_distances[m_distanceOffsets[cluster] + static_cast<uint64_t> (from - first) * numNodes + (to - first)];
+}
+
+inline uint ClusterGraph::getLocalIndex (uint x, uint y) const
+{
+    return (y % m_clusterSize) * m_clusterSize + (x % m_clusterSize);
+}
+
+} /* namespace pathFind */
+
+#endif /* CLUSTERGRAPH_H_ */
@@ -0,0 +1,131 @@
+/**
+ * File        : CompactSearchState.h
+ * Description : A memory lean stand in for the SearchState. On a 4-connected
+ *               grid a tile is always reached from one of its four neighbors,
+ *               so instead of a best cost and a parent id per tile it keeps
+ *               2 bits for the direction of the parent and 1 bit for whether
+ *               the tile is closed. Best costs are left to the open list,
+ *               which only needs them for the frontier. Paths are rebuilt by
+ *               walking the directions back from the end.
+ */
+
+#ifndef COMPACTSEARCHSTATE_H_
+#define COMPACTSEARCHSTATE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "algorithms/tools/PathTile.h"
+#include "common/World.h"
+#include "common/Point.h"
+
+namespace pathFind
+{
+
+class CompactSearchState
+{
+public:
+
+    CompactSearchState () = delete;
+    CompactSearchState (size_t worldWidth, size_t worldHeight);
+    // Takes the same arguments as the SearchState so the two can be swapped
+    // in a SearchWorkspace. The bit planes always cover the whole world, so
+    // the expected number of tiles is not used.
+    CompactSearchState (const World& world, size_t expectedTiles = 0);
+
+    // Always true, see above
+    bool fits (size_t expectedTiles) const;
+
+    bool isClosed (tileId_t id) const;
+    // Closes a tile and remembers which neighbor it was reached from. A
+    // tile reached from itself is taken as the start of the search.
+    void close (const World& world, const PathTile& tile);
+
+    Point getPoint (tileId_t id) const;
+
+    /**
+     * Follows the parent directions back from a closed tile to the start.
+     * @param id    The tile to start from, usually the end of the search.
+     * @param path  Gets the points from id to the start (both included)
+     *              appended to it.
+     */
+    void getPath (tileId_t id, std::vector<Point>& path) const;
+
+    // Opens every tile again. Only the closed bits have to be cleared, the
+    // directions of tiles that are not closed are never read.
+    void reset ();
+
+private:
+
+    // Parent directions are stored as the bit index of the World::Direction
+    // pointing from a tile to its parent, 32 tiles to a word
+    const static uint DIRECTIONS_PER_WORD = 32;
+    const static uint CLOSED_PER_WORD = 64;
+
+    uint getDirection (tileId_t id) const;
+    void setDirection (tileId_t id, uint direction);
+
+    size_t m_worldWidth;
+    size_t m_worldHeight;
+
+    std::vector<uint64_t> m_directions;
+    std::vector<uint64_t> m_closed;
+    tileId_t m_start;
+};
+
+// Called for every neighbor of every expanded tile, so defined here to let
+// the compiler inline them
+
+inline bool CompactSearchState::isClosed (tileId_t id) const
+{
+    return (m_closed[id / CLOSED_PER_WORD] >> (id % CLOSED_PER_WORD)) & 1;
+}
+
+inline uint CompactSearchState::getDirection (tileId_t id) const
+{
+    return (m_directions[id / DIRECTIONS_PER_WORD] >> (2 * (id % DIRECTIONS_PER_WORD))) & 3;
+}
+
+inline void CompactSearchState::setDirection (tileId_t id, uint direction)
+{
+    uint64_t& word = m_directions[id / DIRECTIONS_PER_WORD];
+    uint shift = 2 * (id % DIRECTIONS_PER_WORD);
+    word = (word & ~(static_cast<uint64_t> (3) << shift)) | (static_cast<uint64_t> (direction) << shift);
+}
+
+inline void CompactSearchState::close (const World& world, const PathTile& tile)
+{
+    tileId_t id = tile.getTile ().id;
+    Point xy = tile.xy ();
+    Point best = tile.bestTile ();
+    if (best.x == xy.x + 1)
+    {
+        setDirection (id, 0);
+    }
+    else if (best.y == xy.y + 1)
+    {
+        setDirection (id, 1);
+    }
+    else if (best.x + 1 == xy.x)
+    {
+        setDirection (id, 2);
+    }
+    else if (best.y + 1 == xy.y)
+    {
+        setDirection (id, 3);
+    }
+    else
+    {
+        m_start = world.getID (xy.x, xy.y);
+    }
+    m_closed[id / CLOSED_PER_WORD] |= static_cast<uint64_t> (1) << (id % CLOSED_PER_WORD);
+}
+
+inline Point CompactSearchState::getPoint (tileId_t id) const
+{
+    return Point (id % m_worldWidth, id / m_worldWidth);
+}
+
+} /* namespace pathFind */
+
+#endif /* COMPACTSEARCHSTATE_H_ */
@@ -0,0 +1,423 @@
+/**
+ * File        : DaryHeap.h
+ * Description : A d-ary (4 or 8 children per node) version of the
+ *               PriorityQueue with the same interface. The combined
+ *               heuristic of every tile is kept in its own key array whose
+ *               child groups start on a multiple of D inside a cache line
+ *               aligned buffer, so picking the smallest child is a single
+ *               aligned SIMD load and a few compares instead of a compare
+ *               per child. Like the PriorityQueue, tiles are ordered by the
+ *               combined heuristic alone. Ties are not broken on the best
+ *               cost: the first of several equal children is taken and equal
+ *               keys never swap, so tiles of equal cost come out in an order
+ *               set by where they sit in the heap.
+ */
+
+#ifndef DARYHEAP_H_
+#define DARYHEAP_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <memory>
+#include <new>
+
+#if defined(__SSE4_1__) || defined(__AVX2__)
+    #include <immintrin.h>
+#endif
+
+#include "algorithms/tools/Heuristics.h"
+#include "algorithms/tools/PathTile.h"
+#include "common/World.h"
+
+namespace pathFind
+{
+
+template <uint D, class Heuristic = ZeroHeuristic>
+class DaryHeap
+{
+public:
+
+    typedef Heuristic heuristic_t;
+
+    static_assert (D >= 2, "A d-ary heap needs at least two children per node");
+
+    DaryHeap () = delete;
+    DaryHeap (size_t worldWidth, size_t worldHeight,
+              Heuristic heuristic = Heuristic ());
+    DaryHeap (const World& world,
+              Heuristic heuristic = Heuristic ());
+
+    void push (const World::tile_t& tile, const Point& xy, uint bestCost = PathTile::INF);
+    void push (const World::tile_t& tile, const Point& xy, uint bestCost,
+               const Point& bestTile);
+    void push (const PathTile& tile);
+    void pop ();
+    PathTile top () const;
+    bool empty () const;
+
+    void changeBestCost (uint x, uint y, uint bestCost);
+    void tryUpdateBestCost (const World::tile_t& tile, const Point& targetXY,
+                            const PathTile& bestTile);
+
+    bool isValid (uint x, uint y) const;
+    // Assumes that user already checked that (x, y) is valid
+    PathTile getPathTile (uint x, uint y) const;
+
+    // Empties the queue for a new search that uses a new heuristic. Only
+    // costs as much as the tiles left in the queue.
+    void reset (Heuristic heuristic);
+
+private:
+
+    const static uint32_t NO_SLOT = 0;
+    const static size_t KEY_ALIGNMENT = 64;
+
+    struct freeDeleter_t
+    {
+        void operator() (void* memory) const
+        {
+            std::free (memory);
+        }
+    };
+
+    // The key of heap position pos lives at pos + D - 1 so that the children
+    // of every node (D * pos + 1 ... D * pos + D) start on a multiple of D.
+    // The tile at pos is m_nodes[pos], read only once its key has won.
+    uint32_t& key (size_t pos);
+    uint32_t key (size_t pos) const;
+
+    bool findSlot (uint x, uint y, size_t& pos) const;
+    void place (size_t pos, const PathTile& tile);
+
+    // Heap position of the child of pos with the smallest key. Keys past the
+    // end of the heap are INF and lie after every real child, so the first
+    // minimum found always belongs to a real child.
+    size_t getMinChild (size_t pos) const;
+
+    // Grow the key buffer so the child group of every position below count
+    // is allocated, filling new keys with INF
+    void reserveKeys (size_t count);
+
+    void downHeap (size_t pos);
+    void upHeap (size_t pos);
+
+    size_t m_worldWidth;
+    size_t m_worldHeight;
+
+    std::vector<PathTile> m_nodes;
+    std::unique_ptr<uint32_t, freeDeleter_t> m_keys;
+    size_t m_keyCapacity;
+    // Heap position + 1 for every tile id, see PriorityQueue
+    std::unique_ptr<uint32_t, freeDeleter_t> m_slots;
+
+    Heuristic m_heurFunct;
+};
+
+// Index of the smallest of the D keys starting at group, the first one if
+// several are equal. group is aligned to D * sizeof (uint32_t).
+template <uint D>
+inline uint minKeyIndex (const uint32_t* group)
+{
+    uint best = 0;
+    for (uint i = 1; i < D; ++i)
+    {
+        if (group[i] < group[best])
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+#ifdef __SSE4_1__
+template <>
+inline uint minKeyIndex<4> (const uint32_t* group)
+{
+    __m128i keys = _mm_load_si128 (reinterpret_cast<const __m128i*> (group));
+    __m128i min = _mm_min_epu32 (keys, _mm_shuffle_epi32 (keys, _MM_SHUFFLE (1, 0, 3, 2)));
+    min = _mm_min_epu32 (min, _mm_shuffle_epi32 (min, _MM_SHUFFLE (2, 3, 0, 1)));
+    int mask = _mm_movemask_ps (_mm_castsi128_ps (_mm_cmpeq_epi32 (keys, min)));
+    return __builtin_ctz (mask);
+}
+#endif
+
+#ifdef __AVX2__
+template <>
+inline uint minKeyIndex<8> (const uint32_t* group)
+{
+    __m256i keys = _mm256_load_si256 (reinterpret_cast<const __m256i*> (group));
+    __m256i min = _mm256_min_epu32 (keys, _mm256_permute2x128_si256 (keys, keys, 1));
+    min = _mm256_min_epu32 (min, _mm256_shuffle_epi32 (min, _MM_SHUFFLE (1, 0, 3, 2)));
+    min = _mm256_min_epu32 (min, _mm256_shuffle_epi32 (min, _MM_SHUFFLE (2, 3, 0, 1)));
+    int mask = _mm256_movemask_ps (_mm256_castsi256_ps (_mm256_cmpeq_epi32 (keys, min)));
+    return __builtin_ctz (mask);
+}
+#endif
+
+template <uint D, class Heuristic>
+DaryHeap<D, Heuristic>::DaryHeap (size_t worldWidth, size_t worldHeight,
+                                  Heuristic heuristic)
+    : m_worldWidth (worldWidth),
+      m_worldHeight (worldHeight),
+      m_keyCapacity (0),
+      m_slots (static_cast<uint32_t*> (std::calloc (worldWidth * worldHeight, sizeof (uint32_t)))),
+      m_heurFunct (heuristic)
+{
+    if (!m_slots && worldWidth * worldHeight != 0)
+    {
+        throw std::bad_alloc ();
+    }
+    reserveKeys (1);
+}
+
+template <uint D, class Heuristic>
+DaryHeap<D, Heuristic>::DaryHeap (const World& world, Heuristic heuristic)
+    : DaryHeap (world.getWidth (), world.getHeight (), heuristic)
+{
+    m_nodes.reserve (world.getNumOpenTiles ());
+    for (uint y = 0; y < m_worldHeight; ++y)
+    {
+        for (uint x = 0; x < m_worldWidth; ++x)
+        {
+            World::tile_t t = world (x, y);
+            if (t.cost != 0)
+            {
+                push (PathTile {t, {x, y}, m_heurFunct (x, y)});
+            }
+        }
+    }
+}
+
+template <uint D, class Heuristic>
+void DaryHeap<D, Heuristic>::push (const World::tile_t& tile, const Point& xy, uint bestCost)
+{
+    PathTile p {tile, xy, m_heurFunct (xy.x, xy.y)};
+    p.setBestCost (bestCost);
+    push (p);
+}
+
+template <uint D, class Heuristic>
+void DaryHeap<D, Heuristic>::push (const World::tile_t& tile, const Point& xy,
+                                   uint bestCost, const Point& bestTile)
+{
+    PathTile p {tile, xy, m_heurFunct (xy.x, xy.y)};
+    p.setBestCost (bestCost);
+    p.setBestTile (bestTile);
+    push (p);
+}
+
+template <uint D, class Heuristic>
+void DaryHeap<D, Heuristic>::push (const PathTile& tile)
+{
+    m_nodes.push_back (tile);
+    reserveKeys (m_nodes.size ());
+    upHeap (m_nodes.size () - 1);
+}
+
+template <uint D, class Heuristic>
+void DaryHeap<D, Heuristic>::pop ()
+{
+    if (m_nodes.empty ())
+    {
+        return;
+    }
+
+    m_slots.get ()[m_nodes[0].getTile ().id] = NO_SLOT;
+    size_t last = m_nodes.size () - 1;
+    key (last) = PathTile::INF;
+    if (last != 0)
+    {
+        m_nodes[0] = m_nodes[last];
+    }
+    m_nodes.pop_back ();
+    if (!m_nodes.empty ())
+    {
+        downHeap (0);
+    }
+}
+
+template <uint D, class Heuristic>
+PathTile DaryHeap<D, Heuristic>::top () const
+{
+    return m_nodes[0];
+}
+
+template <uint D, class Heuristic>
+bool DaryHeap<D, Heuristic>::empty () const
+{
+    return m_nodes.empty ();
+}
+
+template <uint D, class Heuristic>
+void DaryHeap<D, Heuristic>::changeBestCost (uint x, uint y, uint bestCost)
+{
+    size_t pos;
+    if (findSlot (x, y, pos))
+    {
+        m_nodes[pos].setBestCost (bestCost);
+        upHeap (pos);
+    }
+}
+
+template <uint D, class Heuristic>
+void DaryHeap<D, Heuristic>::tryUpdateBestCost (const World::tile_t& tile, const Point& targetXY,
+                                                const PathTile& bestTile)
+{
+    size_t pos;
+    if (findSlot (targetXY.x, targetXY.y, pos))
+    {
+        PathTile& target = m_nodes[pos];
+        uint totalCost = bestTile.getBestCost () + target.getTile ().cost;
+        if (totalCost < target.getBestCost ())
+        {
+            target.setBestTile (bestTile.xy ());
+            target.setBestCost (totalCost);
+            upHeap (pos);
+        }
+    }
+    else
+    {
+        push (tile, targetXY, tile.cost + bestTile.getBestCost (), bestTile.xy ());
+    }
+}
+
+template <uint D, class Heuristic>
+bool DaryHeap<D, Heuristic>::isValid (uint x, uint y) const
+{
+    size_t pos;
+    return findSlot (x, y, pos);
+}
+
+template <uint D, class Heuristic>
+PathTile DaryHeap<D, Heuristic>::getPathTile (uint x, uint y) const
+{
+    size_t pos = 0;
+    findSlot (x, y, pos);
+    return m_nodes[pos];
+}
+
+template <uint D, class Heuristic>
+void DaryHeap<D, Heuristic>::reset (Heuristic heuristic)
+{
+    for (size_t pos = 0; pos < m_nodes.size (); ++pos)
+    {
+        m_slots.get ()[m_nodes[pos].getTile ().id] = NO_SLOT;
+        key (pos) = PathTile::INF;
+    }
+    m_nodes.clear ();
+    m_heurFunct = heuristic;
+}
+
+template <uint D, class Heuristic>
+inline uint32_t& DaryHeap<D, Heuristic>::key (size_t pos)
+{
+    return m_keys.get ()[pos + D - 1];
+}
+
+template <uint D, class Heuristic>
+inline uint32_t DaryHeap<D, Heuristic>::key (size_t pos) const
+{
+    return m_keys.get ()[pos + D - 1];
+}
+
+template <uint D, class Heuristic>
+inline bool DaryHeap<D, Heuristic>::findSlot (uint x, uint y, size_t& pos) const
+{
+    if (x < m_worldWidth && y < m_worldHeight)
+    {
+        uint32_t slot = m_slots.get ()[(m_worldWidth * y) + x];
+        if (slot != NO_SLOT)
+        {
+            pos = slot - 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <uint D, class Heuristic>
+inline void DaryHeap<D, Heuristic>::place (size_t pos, const PathTile& tile)
+{
+    m_nodes[pos] = tile;
+    key (pos) = tile.getCombinedHeuristic ();
+    m_slots.get ()[tile.getTile ().id] = pos + 1;
+}
+
+template <uint D, class Heuristic>
+inline size_t DaryHeap<D, Heuristic>::getMinChild (size_t pos) const
+{
+    size_t first = D * pos + 1;
+    return first + minKeyIndex<D> (&m_keys.get ()[first + D - 1]);
+}
+
+template <uint D, class Heuristic>
+void DaryHeap<D, Heuristic>::reserveKeys (size_t count)
+{
+    // The children of the last parent end at key index count + 2D - 3 at
+    // most, round that up to whole groups
+    size_t needed = ((count + 3 * D - 3) / D) * D;
+    if (needed <= m_keyCapacity)
+    {
+        return;
+    }
+
+    size_t capacity = std::max (needed, m_keyCapacity * 2);
+    void* memory = nullptr;
+    if (posix_memalign (&memory, KEY_ALIGNMENT, capacity * sizeof (uint32_t)) != 0)
+    {
+        throw std::bad_alloc ();
+    }
+    uint32_t* keys = static_cast<uint32_t*> (memory);
+    if (m_keyCapacity != 0)
+    {
+        std::memcpy (keys, m_keys.get (), m_keyCapacity * sizeof (uint32_t));
+    }
+    std::fill (keys + m_keyCapacity, keys + capacity, static_cast<uint32_t> (PathTile::INF));
+    m_keys.reset (keys);
+    m_keyCapacity = capacity;
+}
+
+template <uint D, class Heuristic>
+void DaryHeap<D, Heuristic>::downHeap (size_t pos)
+{
+    PathTile value = m_nodes[pos];
+    uint valueKey = value.getCombinedHeuristic ();
+    while (D * pos + 1 < m_nodes.size ())
+    {
+        size_t c = getMinChild (pos);
+        if (key (c) >= valueKey)
+        {
+            break;
+        }
+
+        place (pos, m_nodes[c]);
+        pos = c;
+    }
+    place (pos, value);
+}
+
+template <uint D, class Heuristic>
+void DaryHeap<D, Heuristic>::upHeap (size_t pos)
+{
+    PathTile value = m_nodes[pos];
+    uint valueKey = value.getCombinedHeuristic ();
+    while (pos != 0)
+    {
+        size_t p = (pos - 1) / D;
+        if (valueKey >= key (p))
+        {
+            break;
+        }
+
+        place (pos, m_nodes[p]);
+        pos = p;
+    }
+    place (pos, value);
+}
+
+} /* namespace pathFind */
+
+#endif /* DARYHEAP_H_ */
@@ -0,0 +1,275 @@
+/**
+ * File        : FlatHashMap.h
+ * Description : Open addressing hash map from tile ids to values, for search
+ *               state that only covers a small part of a large world. All
+ *               entries live inline in one array (no node per entry like the
+ *               std::unordered_map) and collisions are resolved with robin
+ *               hood linear probing, so a lookup is a multiply, a shift and
+ *               a short scan of neighboring slots. Erasing shifts the
+ *               following entries back instead of leaving tombstones.
+ */
+
+#ifndef FLATHASHMAP_H_
+#define FLATHASHMAP_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "common/World.h"
+
+namespace pathFind
+{
+
+template <class Value>
+class FlatHashMap
+{
+public:
+
+    // Reserves room for expectedSize entries up front
+    FlatHashMap (size_t expectedSize = 0);
+
+    Value* find (tileId_t key);
+    const Value* find (tileId_t key) const;
+    bool contains (tileId_t key) const;
+
+    // Inserts a default constructed value if key is not in the map yet
+    Value& operator[] (tileId_t key);
+    // Returns false (and leaves the map alone) if key is already in the map
+    bool insert (tileId_t key, const Value& value);
+    // Returns false if key was not in the map
+    bool erase (tileId_t key);
+
+    // Empties the map but keeps its slots for the next use
+    void clear ();
+    void reserve (size_t expectedSize);
+
+    size_t size () const;
+    bool empty () const;
+
+private:
+
+    typedef struct slot_t
+    {
+        tileId_t key;
+        // How far the slot is from the key's home slot plus one, 0 for an
+        // empty slot
+        uint32_t distance;
+        Value value;
+    } slot_t;
+
+    const static size_t MIN_CAPACITY = 16;
+    // Grow once the slots are more than MAX_LOAD_NUM / MAX_LOAD_DEN full
+    const static size_t MAX_LOAD_NUM = 7;
+    const static size_t MAX_LOAD_DEN = 8;
+
+    // Fibonacci hashing, the top bits of the product pick the home slot.
+    // Tile ids of a search are clustered rows of consecutive numbers, which
+    // the multiply spreads over the whole table.
+    size_t getHome (tileId_t key) const;
+    size_t findSlot (tileId_t key) const;
+    Value& insertNew (tileId_t key, const Value& value);
+    void rehash (size_t capacity);
+
+    std::vector<slot_t> m_slots;
+    size_t m_mask;
+    uint m_shift;
+    size_t m_size;
+};
+
+template <class Value>
+FlatHashMap<Value>::FlatHashMap (size_t expectedSize)
+    : m_mask (0),
+      m_shift (64),
+      m_size (0)
+{
+    reserve (expectedSize);
+}
+
+template <class Value>
+inline size_t FlatHashMap<Value>::getHome (tileId_t key) const
+{
+    return (key * static_cast<uint64_t> (11400714819323198485ull)) >> m_shift;
+}
+
+template <class Value>
+inline size_t FlatHashMap<Value>::findSlot (tileId_t key) const
+{
+    size_t index = getHome (key);
+    uint32_t distance = 1;
+    // Robin hood keeps every key at least as close to home as the keys
+    // after it, so the scan can stop at the first slot that is closer
+    while (m_slots[index].distance >= distance)
+    {
+        if (m_slots[index].key == key)
+        {
+            return index;
+        }
+        index = (index + 1) & m_mask;
+        ++distance;
+    }
+    return m_slots.size ();
+}
+
+template <class Value>
+inline Value* FlatHashMap<Value>::find (tileId_t key)
+{
+    size_t index = findSlot (key);
+    return index == m_slots.size () ? nullptr : &m_slots[index].value;
+}
+
+template <class Value>
+inline const Value* FlatHashMap<Value>::find (tileId_t key) const
+{
+    size_t index = findSlot (key);
+    return index == m_slots.size () ? nullptr : &m_slots[index].value;
+}
+
+template <class Value>
+inline bool FlatHashMap<Value>::contains (tileId_t key) const
+{
+    return findSlot (key) != m_slots.size ();
+}
+
+template <class Value>
+inline Value& FlatHashMap<Value>::operator[] (tileId_t key)
+{
+    Value* value = find (key);
+    return value != nullptr ? *value : insertNew (key, Value ());
+}
+
+template <class Value>
+bool FlatHashMap<Value>::insert (tileId_t key, const Value& value)
+{
+    if (contains (key))
+    {
+        return false;
+    }
+    insertNew (key, value);
+    return true;
+}
+
+template <class Value>
+Value& FlatHashMap<Value>::insertNew (tileId_t key, const Value& value)
+{
+    if ((m_size + 1) * MAX_LOAD_DEN > m_slots.size () * MAX_LOAD_NUM)
+    {
+        rehash (m_slots.empty () ? MIN_CAPACITY : m_slots.size () * 2);
+    }
+
+    slot_t carried {key, 1, value};
+    Value* placed = nullptr;
+    size_t index = getHome (key);
+    while (true)
+    {
+        slot_t& slot = m_slots[index];
+        if (slot.distance == 0)
+        {
+            slot = std::move (carried);
+            ++m_size;
+            return placed != nullptr ? *placed : slot.value;
+        }
+        // Take the slot from a key that is closer to its home and carry
+        // that key on instead
+        if (slot.distance < carried.distance)
+        {
+            std::swap (slot, carried);
+            if (placed == nullptr)
+            {
+                placed = &slot.value;
+            }
+        }
+        index = (index + 1) & m_mask;
+        ++carried.distance;
+    }
+}
+
+template <class Value>
+bool FlatHashMap<Value>::erase (tileId_t key)
+{
+    size_t index = findSlot (key);
+    if (index == m_slots.size ())
+    {
+        return false;
+    }
+
+    // Shift the run of displaced keys that follows back by one slot
+    size_t next = (index + 1) & m_mask;
+    while (m_slots[next].distance > 1)
+    {
+        m_slots[index] = std::move (m_slots[next]);
+        --m_slots[index].distance;
+        index = next;
+        next = (next + 1) & m_mask;
+    }
+    m_slots[index].distance = 0;
+    --m_size;
+    return true;
+}
+
+template <class Value>
+void FlatHashMap<Value>::clear ()
+{
+    if (m_size == 0)
+    {
+        return;
+    }
+    for (slot_t& slot : m_slots)
+    {
+        slot.distance = 0;
+    }
+    m_size = 0;
+}
+
+template <class Value>
+void FlatHashMap<Value>::reserve (size_t expectedSize)
+{
+    size_t capacity = MIN_CAPACITY;
+    while (capacity * MAX_LOAD_NUM < expectedSize * MAX_LOAD_DEN)
+    {
+        capacity *= 2;
+    }
+    if (capacity > m_slots.size ())
+    {
+        rehash (capacity);
+    }
+}
+
+template <class Value>
+void FlatHashMap<Value>::rehash (size_t capacity)
+{
+    std::vector<slot_t> oldSlots (capacity);
+    oldSlots.swap (m_slots);
+    m_mask = capacity - 1;
+    m_shift = 64;
+    while (capacity > 1)
+    {
+        capacity /= 2;
+        --m_shift;
+    }
+    m_size = 0;
+
+    for (slot_t& slot : oldSlots)
+    {
+        if (slot.distance != 0)
+        {
+            insertNew (slot.key, slot.value);
+        }
+    }
+}
+
+template <class Value>
+inline size_t FlatHashMap<Value>::size () const
+{
+    return m_size;
+}
+
+template <class Value>
+inline bool FlatHashMap<Value>::empty () const
+{
+    return m_size == 0;
+}
+
+} /* namespace pathFind */
+
+#endif /* FLATHASHMAP_H_ */
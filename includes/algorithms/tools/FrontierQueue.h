@@ -0,0 +1,261 @@
+/**
+ * File        : FrontierQueue.h
+ * Description : An open list with the same interface as the PriorityQueue
+ *               that keeps nothing per tile of the world. The best cost of
+ *               a tile is only remembered while the tile is in the queue (in
+ *               a FlatHashMap sized by the frontier), and like the LazyQueue a
+ *               tile reached more cheaply is pushed again with outdated
+ *               copies skipped when they come up. Paired with the
+ *               CompactSearchState this lets a search run on worlds whose
+ *               per tile arrays would not fit in memory.
+ */
+
+#ifndef FRONTIERQUEUE_H_
+#define FRONTIERQUEUE_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "algorithms/tools/FlatHashMap.h"
+#include "algorithms/tools/Heuristics.h"
+#include "algorithms/tools/PathTile.h"
+#include "common/World.h"
+
+namespace pathFind
+{
+
+template <class Heuristic = ZeroHeuristic>
+class FrontierQueue
+{
+public:
+
+    typedef Heuristic heuristic_t;
+
+    FrontierQueue () = delete;
+    FrontierQueue (size_t worldWidth, size_t worldHeight,
+                   Heuristic heuristic = Heuristic ());
+
+    void push (const World::tile_t& tile, const Point& xy, uint bestCost = PathTile::INF);
+    void push (const World::tile_t& tile, const Point& xy, uint bestCost,
+               const Point& bestTile);
+    void push (const PathTile& tile);
+    void pop ();
+    PathTile top () const;
+    bool empty () const;
+
+    void changeBestCost (uint x, uint y, uint bestCost);
+    // Popped tiles are forgotten, so callers have to skip tiles they have
+    // already closed or those tiles are opened again
+    void tryUpdateBestCost (const World::tile_t& tile, const Point& targetXY,
+                            const PathTile& bestTile);
+
+    // Tiles pushed with an INF cost are not counted as reached
+    bool isValid (uint x, uint y) const;
+    // Assumes that user already checked that (x, y) is valid. Has to search
+    // the heap for the live copy of the tile.
+    PathTile getPathTile (uint x, uint y) const;
+
+    // Empties the queue for a new search that uses a new heuristic
+    void reset (Heuristic heuristic);
+
+private:
+
+    // Compact once more than 1 / COMPACT_RATIO of the heap is stale, see
+    // LazyQueue
+    const static size_t COMPACT_RATIO = 2;
+    const static size_t COMPACT_MIN_SIZE = 1024;
+
+    // std heap functions build a max heap, so order by the greater tile
+    static bool greaterTile (const PathTile& lhs, const PathTile& rhs);
+
+    bool isStale (const PathTile& tile) const;
+    // Pop stale copies off the top so top () always returns a live tile
+    void skipStale ();
+    void compact ();
+
+    size_t m_worldWidth;
+    size_t m_worldHeight;
+
+    std::vector<PathTile> m_heap;
+    // Best cost of every tile in the queue
+    FlatHashMap<uint> m_bestCosts;
+    size_t m_numStale;
+
+    Heuristic m_heurFunct;
+};
+
+template <class Heuristic>
+bool FrontierQueue<Heuristic>::greaterTile (const PathTile& lhs, const PathTile& rhs)
+{
+    return rhs < lhs;
+}
+
+template <class Heuristic>
+FrontierQueue<Heuristic>::FrontierQueue (size_t worldWidth, size_t worldHeight,
+                                         Heuristic heuristic)
+    : m_worldWidth (worldWidth),
+      m_worldHeight (worldHeight),
+      m_numStale (0),
+      m_heurFunct (heuristic)
+{
+}
+
+template <class Heuristic>
+void FrontierQueue<Heuristic>::push (const World::tile_t& tile, const Point& xy, uint bestCost)
+{
+    PathTile p {tile, xy, m_heurFunct (xy.x, xy.y)};
+    p.setBestCost (bestCost);
+    push (p);
+}
+
+template <class Heuristic>
+void FrontierQueue<Heuristic>::push (const World::tile_t& tile, const Point& xy,
+                                     uint bestCost, const Point& bestTile)
+{
+    PathTile p {tile, xy, m_heurFunct (xy.x, xy.y)};
+    p.setBestCost (bestCost);
+    p.setBestTile (bestTile);
+    push (p);
+}
+
+template <class Heuristic>
+void FrontierQueue<Heuristic>::push (const PathTile& tile)
+{
+    uint* bestCost = m_bestCosts.find (tile.getTile ().id);
+    if (bestCost == nullptr)
+    {
+        m_bestCosts.insert (tile.getTile ().id, tile.getBestCost ());
+    }
+    else
+    {
+        // The copy already in the heap is superseded
+        ++m_numStale;
+        *bestCost = tile.getBestCost ();
+    }
+
+    m_heap.push_back (tile);
+    std::push_heap (m_heap.begin (), m_heap.end (), greaterTile);
+    skipStale ();
+}
+
+template <class Heuristic>
+void FrontierQueue<Heuristic>::pop ()
+{
+    if (m_heap.empty ())
+    {
+        return;
+    }
+
+    m_bestCosts.erase (m_heap.front ().getTile ().id);
+    std::pop_heap (m_heap.begin (), m_heap.end (), greaterTile);
+    m_heap.pop_back ();
+    skipStale ();
+}
+
+template <class Heuristic>
+PathTile FrontierQueue<Heuristic>::top () const
+{
+    return m_heap.front ();
+}
+
+template <class Heuristic>
+bool FrontierQueue<Heuristic>::empty () const
+{
+    return m_heap.empty ();
+}
+
+template <class Heuristic>
+void FrontierQueue<Heuristic>::changeBestCost (uint x, uint y, uint bestCost)
+{
+    if (isValid (x, y))
+    {
+        PathTile tile = getPathTile (x, y);
+        tile.setBestCost (bestCost);
+        push (tile);
+    }
+}
+
+template <class Heuristic>
+void FrontierQueue<Heuristic>::tryUpdateBestCost (const World::tile_t& tile, const Point& targetXY,
+                                                  const PathTile& bestTile)
+{
+    uint totalCost = tile.cost + bestTile.getBestCost ();
+    const uint* bestCost = m_bestCosts.find (tile.id);
+    if (bestCost == nullptr || totalCost < *bestCost)
+    {
+        push (tile, targetXY, totalCost, bestTile.xy ());
+    }
+}
+
+template <class Heuristic>
+bool FrontierQueue<Heuristic>::isValid (uint x, uint y) const
+{
+    if (x >= m_worldWidth || y >= m_worldHeight)
+    {
+        return false;
+    }
+    const uint* bestCost = m_bestCosts.find ((m_worldWidth * y) + x);
+    return bestCost != nullptr && *bestCost != PathTile::INF;
+}
+
+template <class Heuristic>
+PathTile FrontierQueue<Heuristic>::getPathTile (uint x, uint y) const
+{
+    for (const PathTile& tile : m_heap)
+    {
+        if (tile.xy ().x == x && tile.xy ().y == y && !isStale (tile))
+        {
+            return tile;
+        }
+    }
+    return PathTile ();
+}
+
+template <class Heuristic>
+void FrontierQueue<Heuristic>::reset (Heuristic heuristic)
+{
+    m_heap.clear ();
+    m_bestCosts.clear ();
+    m_numStale = 0;
+    m_heurFunct = heuristic;
+}
+
+template <class Heuristic>
+bool FrontierQueue<Heuristic>::isStale (const PathTile& tile) const
+{
+    const uint* bestCost = m_bestCosts.find (tile.getTile ().id);
+    return bestCost == nullptr || *bestCost != tile.getBestCost ();
+}
+
+template <class Heuristic>
+void FrontierQueue<Heuristic>::skipStale ()
+{
+    while (!m_heap.empty () && isStale (m_heap.front ()))
+    {
+        std::pop_heap (m_heap.begin (), m_heap.end (), greaterTile);
+        m_heap.pop_back ();
+        if (m_numStale != 0)
+        {
+            --m_numStale;
+        }
+    }
+
+    if (m_heap.size () >= COMPACT_MIN_SIZE && m_numStale * COMPACT_RATIO > m_heap.size ())
+    {
+        compact ();
+    }
+}
+
+template <class Heuristic>
+void FrontierQueue<Heuristic>::compact ()
+{
+    m_heap.erase (std::remove_if (m_heap.begin (), m_heap.end (),
+                                  [this] (const PathTile& tile) { return isStale (tile); }),
+                  m_heap.end ());
+    std::make_heap (m_heap.begin (), m_heap.end (), greaterTile);
+    m_numStale = 0;
+}
+
+} /* namespace pathFind */
+
+#endif /* FRONTIERQUEUE_H_ */
@@ -0,0 +1,66 @@
+/**
+ * File        : Heuristics.h
+ * Description : Heuristic functors the open lists are templated on. Each one
+ *               is called as heuristic (x, y) on every push, so they are
+ *               plain structs whose call operator the compiler can inline
+ *               instead of going through a std::function.
+ */
+
+#ifndef HEURISTICS_H_
+#define HEURISTICS_H_
+
+#include <algorithm>
+
+#include "common/Point.h"
+
+namespace pathFind
+{
+
+// Dijkstra, every tile is as good as any other
+struct ZeroHeuristic
+{
+    uint operator() (uint, uint) const
+    {
+        return 0;
+    }
+};
+
+// Manhattan distance to a single target
+struct ManhattanHeuristic
+{
+    ManhattanHeuristic (uint targetX, uint targetY)
+        : target (targetX, targetY)
+    {
+    }
+
+    uint operator() (uint x, uint y) const
+    {
+        return (x < target.x ? target.x - x : x - target.x) +
+               (y < target.y ? target.y - y : y - target.y);
+    }
+
+    Point target;
+};
+
+// Manhattan distance to the nearer of two targets, used when a search may
+// meet either of them (ParDivide)
+struct NearestManhattanHeuristic
+{
+    NearestManhattanHeuristic (const Point& first, const Point& second)
+        : first (first.x, first.y),
+          second (second.x, second.y)
+    {
+    }
+
+    uint operator() (uint x, uint y) const
+    {
+        return std::min (first (x, y), second (x, y));
+    }
+
+    ManhattanHeuristic first;
+    ManhattanHeuristic second;
+};
+
+} /* namespace pathFind */
+
+#endif /* HEURISTICS_H_ */
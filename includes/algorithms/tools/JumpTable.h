@@ -0,0 +1,109 @@
+/**
+ * File        : JumpTable.h
+ * Description : The distances JPS+ precomputes for every tile of a uniform
+ *               cost world: for each of the 4 directions, how far a jump in
+ *               that direction goes before it reaches a jump point, or how
+ *               many open tiles lie ahead before a wall if it never does.
+ *               Tables are saved next to their world (.jps) and only loaded
+ *               back for the exact world they were built from.
+ *
+ *               Jumps follow the canonical order of 4-connected Jump Point
+ *               Search, where paths move horizontally before vertically. A
+ *               tile is a vertical jump point when a horizontal neighbor is
+ *               open but the tile beside the one the jump came from is not,
+ *               and a horizontal jump point when a vertical jump from it
+ *               reaches a vertical jump point. Jumps ending at the goal are
+ *               left to the search, which knows where the goal is.
+ */
+
+#ifndef JUMPTABLE_H_
+#define JUMPTABLE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/World.h"
+
+namespace pathFind
+{
+
+class JumpTable
+{
+public:
+
+    const static std::string JUMP_TABLE_EXT;
+
+    // An empty table, see build and load
+    JumpTable ();
+
+    JumpTable (const JumpTable&) = delete;
+    JumpTable& operator= (const JumpTable&) = delete;
+
+    // Computes the table from the world's neighbor masks, which must be built
+    void build (const World& world);
+
+    /**
+     * Loads a table saved by save. Returns false, leaving the table empty, if
+     * the file can't be read or was saved for a world with other dimensions
+     * or tile costs.
+     */
+    bool load (const std::string& fileName, const World& world);
+    bool save (const std::string& fileName, const World& world) const;
+
+    // Whether the table was built for a world of these dimensions
+    bool fits (const World& world) const;
+
+    /**
+     * Positive: the number of steps in direction to the next jump point.
+     * Zero or negative: no jump point lies ahead and minus the value is the
+     * number of open tiles before a wall or the edge of the world.
+     * direction is one of World::Direction.
+     */
+    int32_t getDistance (uint x, uint y, uint direction) const;
+
+    // Whether a vertical jump from the tile with neighbor mask from onto the
+    // tile with mask to stops there: a horizontal neighbor of to is open while
+    // the one beside from is not, so the only shortest way there turns at to
+    static bool isVerticalJumpPoint (uint from, uint to);
+
+private:
+
+    const static uint NUM_DIRECTIONS = 4;
+
+    typedef struct fileHeader_t
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t width;
+        uint64_t height;
+        uint64_t checksum;
+    } fileHeader_t;
+
+    // Index of direction in the 4 distances of a tile
+    static uint getIndex (uint direction);
+
+    size_t m_width;
+    size_t m_height;
+    // NUM_DIRECTIONS distances per tile, by tile id
+    std::vector<int32_t> m_distances;
+};
+
+inline uint JumpTable::getIndex (uint direction)
+{
+    return __builtin_ctz (direction);
+}
+
+inline bool JumpTable::isVerticalJumpPoint (uint from, uint to)
+{
+    return (to & ~from & (World::EAST | World::WEST)) != 0;
+}
+
+inline int32_t JumpTable::getDistance (uint x, uint y, uint direction) const
+{
+    return m_distances[((y * m_width) + x) * NUM_DIRECTIONS + getIndex (direction)];
+}
+
+} /* namespace pathFind */
+
+#endif /* JUMPTABLE_H_ */
@@ -0,0 +1,123 @@
+/**
+ * File        : LPAStar.h
+ * Description : Lifelong Planning A* (LPA*). Finds a shortest path between two fixed
+ *               tiles like A* does, but keeps its search state afterwards so that
+ *               when some tile costs change only the part of the search those
+ *               changes affect is redone instead of the whole search.
+ */
+
+#ifndef LPASTAR_H_
+#define LPASTAR_H_
+
+#include <vector>
+#include <queue>
+
+#include "algorithms/tools/PathTile.h"
+#include "common/World.h"
+#include "common/Point.h"
+
+namespace pathFind
+{
+
+class LPAStar
+{
+public:
+
+    LPAStar () = delete;
+
+    /**
+     * Sets up a search between start and end. The world must have its neighbor
+     * masks built and must outlive the planner. Its costs may be changed through
+     * World::setCost between searches as long as every changed tile is reported
+     * through updateTile.
+     */
+    LPAStar (const World& world, const Point& start, const Point& end);
+
+    /**
+     * Runs (or repairs) the search until the shortest path to the end is known.
+     * @return True if the end can be reached from the start.
+     */
+    bool computePath ();
+
+    /**
+     * Tells the planner that the cost of the tile at (x, y) changed. Only marks the
+     * affected tiles, the next computePath does the actual repairing.
+     */
+    void updateTile (uint x, uint y);
+
+    /**
+     * Returns the cost of the current path in the same terms the other algorithms
+     * report it (the cost of every tile entered except the end).
+     */
+    uint getPathCost () const;
+
+    /**
+     * Returns the current path from the end back to the start.
+     */
+    std::vector<Point> getPath () const;
+
+    /**
+     * Returns the number of tiles expanded over every computePath so far.
+     */
+    size_t getExpansions () const;
+
+private:
+
+    // Tiles are ordered by (min (g, rhs) + h, min (g, rhs)). The second part breaks
+    // ties toward tiles closer to the start, which LPA* needs to stop correctly.
+    struct key_t
+    {
+        uint first;
+        uint second;
+
+        bool operator< (const key_t& rhs) const
+        {
+            return first < rhs.first || (first == rhs.first && second < rhs.second);
+        }
+    };
+
+    struct entry_t
+    {
+        key_t key;
+        tileId_t id;
+
+        bool operator> (const entry_t& rhs) const
+        {
+            return rhs.key < key;
+        }
+    };
+
+    key_t calculateKey (tileId_t id) const;
+    uint heuristic (tileId_t id) const;
+    void updateVertex (tileId_t id);
+    uint computeRhs (tileId_t id) const;
+    Point toPoint (tileId_t id) const;
+
+    // Drops entries whose tile became consistent or got a newer key since they were
+    // pushed, so the top of the queue is always a live entry.
+    void skipStaleEntries ();
+
+    const World& m_world;
+    Point m_start;
+    Point m_end;
+    tileId_t m_startId;
+    tileId_t m_endId;
+
+    // g is the cost the search settled on for a tile and rhs the best cost its
+    // neighbors currently offer. A tile needs expanding while the two differ.
+    std::vector<uint> m_g;
+    std::vector<uint> m_rhs;
+
+    // Entries are never removed or updated in place, stale ones are skipped
+    // instead, as in the LazyQueue. The PriorityQueue the other searches use
+    // orders tiles by cost plus heuristic alone and only ever lowers a cost,
+    // while LPA* needs both parts of its keys, keys that rise and tiles that
+    // leave the queue once they become consistent.
+    std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>> m_open;
+
+    size_t m_expansions;
+};
+
+} /* namespace pathFind */
+
+#endif /* LPASTAR_H_ */
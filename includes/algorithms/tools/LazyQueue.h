@@ -0,0 +1,350 @@
+/**
+ * File        : LazyQueue.h
+ * Description : An open list with the same interface as the PriorityQueue
+ *               that never changes the priority of a tile in place. When a
+ *               tile is reached more cheaply a new copy is pushed, and copies
+ *               that no longer match the best cost seen for their tile are
+ *               skipped when they reach the top. The heap is compacted once
+ *               most of it is made up of such stale copies. Best costs are
+ *               stamped with the search that set them like in the SearchState,
+ *               and which tiles are closed is left to the caller's
+ *               SearchState, so starting a new search is only a bump of the
+ *               current stamp.
+ */
+
+#ifndef LAZYQUEUE_H_
+#define LAZYQUEUE_H_
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <new>
+#include <vector>
+#include <memory>
+
+#include "algorithms/tools/Heuristics.h"
+#include "algorithms/tools/PathTile.h"
+#include "common/World.h"
+
+namespace pathFind
+{
+
+template <class Heuristic = ZeroHeuristic>
+class LazyQueue
+{
+public:
+
+    typedef Heuristic heuristic_t;
+
+    LazyQueue () = delete;
+    LazyQueue (size_t worldWidth, size_t worldHeight,
+               Heuristic heuristic = Heuristic ());
+    LazyQueue (const World& world,
+               Heuristic heuristic = Heuristic ());
+
+    void push (const World::tile_t& tile, const Point& xy, uint bestCost = PathTile::INF);
+    void push (const World::tile_t& tile, const Point& xy, uint bestCost,
+               const Point& bestTile);
+    void push (const PathTile& tile);
+    void pop ();
+    PathTile top () const;
+    bool empty () const;
+
+    // Leaves tiles that have been popped alone
+    void changeBestCost (uint x, uint y, uint bestCost);
+    // Only pushes when the new cost beats the best one seen for the tile.
+    // Popped tiles keep their best cost but are not told apart from open
+    // ones, so callers have to skip the tiles they have closed.
+    void tryUpdateBestCost (const World::tile_t& tile, const Point& targetXY,
+                            const PathTile& bestTile);
+
+    // Whether the tile has been reached in this search, popped or not. Tiles
+    // pushed with an INF cost are not counted as reached.
+    bool isValid (uint x, uint y) const;
+    // Assumes that user already checked that (x, y) is valid. Has to search
+    // the heap for the live copy of the tile, PathTile () if it was popped.
+    PathTile getPathTile (uint x, uint y) const;
+
+    // Empties the queue for a new search that uses a new heuristic. Costs
+    // about as much as the copies left in the heap.
+    void reset (Heuristic heuristic);
+
+    size_t getNumStale () const;
+
+private:
+
+    // Compact once more than 1 / COMPACT_RATIO of the heap is stale, but
+    // not for heaps small enough that it would not pay off
+    const static size_t COMPACT_RATIO = 2;
+    const static size_t COMPACT_MIN_SIZE = 1024;
+
+    // A best cost only counts in the search it was set in. Stamps start at
+    // zero and generations at one, so the zero filled memory calloc hands
+    // back reads as INF everywhere.
+    typedef struct bestCost_t
+    {
+        uint32_t stamp;
+        uint32_t bestCost;
+    } bestCost_t;
+
+    struct freeDeleter_t
+    {
+        void operator() (bestCost_t* bestCosts) const
+        {
+            std::free (bestCosts);
+        }
+    };
+
+    uint getBestCost (tileId_t id) const;
+    void setBestCost (tileId_t id, uint bestCost);
+    // The live copy of the tile in the heap, nullptr if there is none
+    const PathTile* findLive (uint x, uint y) const;
+
+    // std heap functions build a max heap, so order by the greater tile
+    static bool greaterTile (const PathTile& lhs, const PathTile& rhs);
+
+    bool isStale (const PathTile& tile) const;
+    // Pop stale copies off the top so top () always returns a live tile
+    void skipStale ();
+    void compact ();
+
+    size_t m_worldWidth;
+    size_t m_worldHeight;
+
+    std::vector<PathTile> m_heap;
+    std::unique_ptr<bestCost_t, freeDeleter_t> m_bestCosts;
+    uint32_t m_generation;
+    size_t m_numStale;
+
+    Heuristic m_heurFunct;
+};
+
+template <class Heuristic>
+bool LazyQueue<Heuristic>::greaterTile (const PathTile& lhs, const PathTile& rhs)
+{
+    return rhs < lhs;
+}
+
+template <class Heuristic>
+LazyQueue<Heuristic>::LazyQueue (size_t worldWidth, size_t worldHeight,
+                                 Heuristic heuristic)
+    : m_worldWidth (worldWidth),
+      m_worldHeight (worldHeight),
+      m_bestCosts (static_cast<bestCost_t*> (std::calloc (worldWidth * worldHeight, sizeof (bestCost_t)))),
+      m_generation (1),
+      m_numStale (0),
+      m_heurFunct (heuristic)
+{
+    if (!m_bestCosts && worldWidth * worldHeight != 0)
+    {
+        throw std::bad_alloc ();
+    }
+}
+
+template <class Heuristic>
+LazyQueue<Heuristic>::LazyQueue (const World& world, Heuristic heuristic)
+    : LazyQueue (world.getWidth (), world.getHeight (), heuristic)
+{
+    m_heap.reserve (world.getNumOpenTiles ());
+    for (uint y = 0; y < m_worldHeight; ++y)
+    {
+        for (uint x = 0; x < m_worldWidth; ++x)
+        {
+            World::tile_t t = world (x, y);
+            if (t.cost != 0)
+            {
+                m_heap.emplace_back (t, Point {x, y}, m_heurFunct (x, y));
+            }
+        }
+    }
+    std::make_heap (m_heap.begin (), m_heap.end (), greaterTile);
+}
+
+template <class Heuristic>
+void LazyQueue<Heuristic>::push (const World::tile_t& tile, const Point& xy, uint bestCost)
+{
+    PathTile p {tile, xy, m_heurFunct (xy.x, xy.y)};
+    p.setBestCost (bestCost);
+    push (p);
+}
+
+template <class Heuristic>
+void LazyQueue<Heuristic>::push (const World::tile_t& tile, const Point& xy,
+                                 uint bestCost, const Point& bestTile)
+{
+    PathTile p {tile, xy, m_heurFunct (xy.x, xy.y)};
+    p.setBestCost (bestCost);
+    p.setBestTile (bestTile);
+    push (p);
+}
+
+template <class Heuristic>
+void LazyQueue<Heuristic>::push (const PathTile& tile)
+{
+    tileId_t id = tile.getTile ().id;
+    if (getBestCost (id) != PathTile::INF)
+    {
+        // The copy already in the heap is superseded. Callers don't push
+        // tiles they have closed, so there is one.
+        ++m_numStale;
+    }
+    setBestCost (id, tile.getBestCost ());
+
+    m_heap.push_back (tile);
+    std::push_heap (m_heap.begin (), m_heap.end (), greaterTile);
+    skipStale ();
+}
+
+template <class Heuristic>
+void LazyQueue<Heuristic>::pop ()
+{
+    if (m_heap.empty ())
+    {
+        return;
+    }
+
+    std::pop_heap (m_heap.begin (), m_heap.end (), greaterTile);
+    m_heap.pop_back ();
+    skipStale ();
+}
+
+template <class Heuristic>
+PathTile LazyQueue<Heuristic>::top () const
+{
+    return m_heap.front ();
+}
+
+template <class Heuristic>
+bool LazyQueue<Heuristic>::empty () const
+{
+    return m_heap.empty ();
+}
+
+template <class Heuristic>
+void LazyQueue<Heuristic>::changeBestCost (uint x, uint y, uint bestCost)
+{
+    const PathTile* live = isValid (x, y) ? findLive (x, y) : nullptr;
+    if (live != nullptr)
+    {
+        PathTile tile = *live;
+        tile.setBestCost (bestCost);
+        push (tile);
+    }
+}
+
+template <class Heuristic>
+void LazyQueue<Heuristic>::tryUpdateBestCost (const World::tile_t& tile, const Point& targetXY,
+                                              const PathTile& bestTile)
+{
+    uint totalCost = tile.cost + bestTile.getBestCost ();
+    if (totalCost < getBestCost (tile.id))
+    {
+        push (tile, targetXY, totalCost, bestTile.xy ());
+    }
+}
+
+template <class Heuristic>
+bool LazyQueue<Heuristic>::isValid (uint x, uint y) const
+{
+    if (x >= m_worldWidth || y >= m_worldHeight)
+    {
+        return false;
+    }
+    return getBestCost ((m_worldWidth * y) + x) != PathTile::INF;
+}
+
+template <class Heuristic>
+PathTile LazyQueue<Heuristic>::getPathTile (uint x, uint y) const
+{
+    const PathTile* live = findLive (x, y);
+    return live != nullptr ? *live : PathTile ();
+}
+
+template <class Heuristic>
+const PathTile* LazyQueue<Heuristic>::findLive (uint x, uint y) const
+{
+    for (const PathTile& tile : m_heap)
+    {
+        if (tile.xy ().x == x && tile.xy ().y == y && !isStale (tile))
+        {
+            return &tile;
+        }
+    }
+    return nullptr;
+}
+
+template <class Heuristic>
+void LazyQueue<Heuristic>::reset (Heuristic heuristic)
+{
+    // Popped tiles are not in the heap any more, so their best costs are
+    // left behind under an old stamp. Only once the stamps run out are they
+    // cleared for real.
+    if (++m_generation == 0)
+    {
+        std::memset (m_bestCosts.get (), 0, m_worldWidth * m_worldHeight * sizeof (bestCost_t));
+        m_generation = 1;
+    }
+    m_heap.clear ();
+    m_numStale = 0;
+    m_heurFunct = heuristic;
+}
+
+template <class Heuristic>
+size_t LazyQueue<Heuristic>::getNumStale () const
+{
+    return m_numStale;
+}
+
+template <class Heuristic>
+uint LazyQueue<Heuristic>::getBestCost (tileId_t id) const
+{
+    const bestCost_t& entry = m_bestCosts.get ()[id];
+    return entry.stamp == m_generation ? entry.bestCost : PathTile::INF;
+}
+
+template <class Heuristic>
+void LazyQueue<Heuristic>::setBestCost (tileId_t id, uint bestCost)
+{
+    m_bestCosts.get ()[id] = bestCost_t {m_generation, bestCost};
+}
+
+template <class Heuristic>
+bool LazyQueue<Heuristic>::isStale (const PathTile& tile) const
+{
+    return tile.getBestCost () != getBestCost (tile.getTile ().id);
+}
+
+template <class Heuristic>
+void LazyQueue<Heuristic>::skipStale ()
+{
+    while (!m_heap.empty () && isStale (m_heap.front ()))
+    {
+        std::pop_heap (m_heap.begin (), m_heap.end (), greaterTile);
+        m_heap.pop_back ();
+        // Copies pushed with an INF cost are never counted as superseded
+        if (m_numStale != 0)
+        {
+            --m_numStale;
+        }
+    }
+
+    if (m_heap.size () >= COMPACT_MIN_SIZE && m_numStale * COMPACT_RATIO > m_heap.size ())
+    {
+        compact ();
+    }
+}
+
+template <class Heuristic>
+void LazyQueue<Heuristic>::compact ()
+{
+    m_heap.erase (std::remove_if (m_heap.begin (), m_heap.end (),
+                                  [this] (const PathTile& tile) { return isStale (tile); }),
+                  m_heap.end ());
+    std::make_heap (m_heap.begin (), m_heap.end (), greaterTile);
+    m_numStale = 0;
+}
+
+} /* namespace pathFind */
+
+#endif /* LAZYQUEUE_H_ */
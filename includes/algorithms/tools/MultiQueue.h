@@ -0,0 +1,208 @@
+/**
+ * File        : MultiQueue.h
+ * Description : A relaxed priority queue that many threads can push to and
+ *               pop from at once. Elements are spread over c * p binary
+ *               heaps (c per thread), each behind its own lock. A pop peeks
+ *               at the tops of two heaps picked at random and takes from the
+ *               better one, so it hands back an element close to, but not
+ *               always exactly, the smallest one while threads rarely wait
+ *               on the same lock.
+ */
+
+#ifndef MULTIQUEUE_H_
+#define MULTIQUEUE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "algorithms/tools/PathTile.h"
+
+namespace pathFind
+{
+
+template <class T>
+class MultiQueue
+{
+public:
+
+    MultiQueue () = delete;
+    // More heaps per thread means less contention but pops that stray
+    // further from the smallest key
+    MultiQueue (uint numThreads, uint queuesPerThread = 2);
+    ~MultiQueue ();
+
+    MultiQueue (const MultiQueue&) = delete;
+    MultiQueue& operator= (const MultiQueue&) = delete;
+
+    void push (uint key, const T& value);
+    // Takes the top of the better of two random heaps. Returns false when
+    // every heap was found empty.
+    bool tryPop (uint& key, T& value);
+
+private:
+
+    const static size_t QUEUE_ALIGNMENT = 64;
+
+    struct entry_t
+    {
+        uint key;
+        T value;
+    };
+
+    // Each heap sits on its own cache lines so threads working on different
+    // heaps do not keep stealing lines from each other
+    struct alignas (QUEUE_ALIGNMENT) queue_t
+    {
+        std::mutex lock;
+        std::vector<entry_t> heap;
+        // Key at the top of the heap, INF when empty. Only written with the
+        // lock held but read without it to pick a heap.
+        std::atomic<uint> topKey;
+    };
+
+    struct freeDeleter_t
+    {
+        void operator() (queue_t* queues) const
+        {
+            std::free (queues);
+        }
+    };
+
+    // std heap functions build a max heap, so order by the greater key
+    static bool greaterEntry (const entry_t& lhs, const entry_t& rhs);
+
+    // Per thread xorshift generator, seeded from the thread id
+    uint randomQueue () const;
+
+    // Pops the top of a heap whose lock is held and releases the lock
+    void popLocked (queue_t& queue, uint& key, T& value);
+
+    uint m_numQueues;
+    std::unique_ptr<queue_t, freeDeleter_t> m_queues;
+};
+
+template <class T>
+MultiQueue<T>::MultiQueue (uint numThreads, uint queuesPerThread)
+    : m_numQueues (std::max (numThreads * queuesPerThread, 2u))
+{
+    void* memory = nullptr;
+    if (posix_memalign (&memory, QUEUE_ALIGNMENT, m_numQueues * sizeof (queue_t)) != 0)
+    {
+        throw std::bad_alloc ();
+    }
+    m_queues.reset (static_cast<queue_t*> (memory));
+    for (uint i = 0; i < m_numQueues; ++i)
+    {
+        queue_t* queue = new (m_queues.get () + i) queue_t;
+        queue->topKey.store (PathTile::INF);
+    }
+}
+
+template <class T>
+MultiQueue<T>::~MultiQueue ()
+{
+    for (uint i = 0; i < m_numQueues; ++i)
+    {
+        m_queues.get ()[i].~queue_t ();
+    }
+}
+
+template <class T>
+void MultiQueue<T>::push (uint key, const T& value)
+{
+    queue_t* queue = m_queues.get () + randomQueue ();
+    while (!queue->lock.try_lock ())
+    {
+        queue = m_queues.get () + randomQueue ();
+    }
+
+    queue->heap.push_back (entry_t {key, value});
+    std::push_heap (queue->heap.begin (), queue->heap.end (), greaterEntry);
+    queue->topKey.store (queue->heap.front ().key, std::memory_order_relaxed);
+    queue->lock.unlock ();
+}
+
+template <class T>
+bool MultiQueue<T>::tryPop (uint& key, T& value)
+{
+    for (uint attempt = 0; attempt < m_numQueues; ++attempt)
+    {
+        queue_t& first = m_queues.get ()[randomQueue ()];
+        queue_t& second = m_queues.get ()[randomQueue ()];
+        queue_t& best = second.topKey.load (std::memory_order_relaxed) <
+                        first.topKey.load (std::memory_order_relaxed) ? second : first;
+
+        if (best.topKey.load (std::memory_order_relaxed) == PathTile::INF || !best.lock.try_lock ())
+        {
+            continue;
+        }
+        // The heap may have been emptied between the peek and the lock
+        if (best.heap.empty ())
+        {
+            best.lock.unlock ();
+            continue;
+        }
+        popLocked (best, key, value);
+        return true;
+    }
+
+    // Most heaps look empty, check all of them before giving up
+    for (uint i = 0; i < m_numQueues; ++i)
+    {
+        queue_t& queue = m_queues.get ()[i];
+        if (queue.topKey.load (std::memory_order_relaxed) == PathTile::INF)
+        {
+            continue;
+        }
+        queue.lock.lock ();
+        if (queue.heap.empty ())
+        {
+            queue.lock.unlock ();
+            continue;
+        }
+        popLocked (queue, key, value);
+        return true;
+    }
+    return false;
+}
+
+template <class T>
+bool MultiQueue<T>::greaterEntry (const entry_t& lhs, const entry_t& rhs)
+{
+    return rhs.key < lhs.key;
+}
+
+template <class T>
+uint MultiQueue<T>::randomQueue () const
+{
+    static thread_local uint32_t state =
+        static_cast<uint32_t> (std::hash<std::thread::id> () (std::this_thread::get_id ())) | 1;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state % m_numQueues;
+}
+
+template <class T>
+void MultiQueue<T>::popLocked (queue_t& queue, uint& key, T& value)
+{
+    std::pop_heap (queue.heap.begin (), queue.heap.end (), greaterEntry);
+    key = queue.heap.back ().key;
+    value = queue.heap.back ().value;
+    queue.heap.pop_back ();
+    queue.topKey.store (queue.heap.empty () ? PathTile::INF : queue.heap.front ().key,
+                        std::memory_order_relaxed);
+    queue.lock.unlock ();
+}
+
+} /* namespace pathFind */
+
+#endif /* MULTIQUEUE_H_ */
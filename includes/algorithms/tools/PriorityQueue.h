@@ -4,33 +4,40 @@
  *               Gives the ability to change the priority of an element while
  *               it is in the heap. Modified specificly for pathfinding in a
  *               "world" by holding onto information about a world.
+ *               The heap stores its tiles contiguously and finds them again
+ *               through a dense tile id to heap slot array, so pushing and
+ *               updating a tile never allocates once the heap has grown.
  */
 
 #ifndef PRIORITYQUEUE_H_
 #define PRIORITYQUEUE_H_
 
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
 #include <vector>
-#include <unordered_map>
-#include <functional>
 #include <memory>
 
+#include "algorithms/tools/Heuristics.h"
 #include "algorithms/tools/PathTile.h"
 #include "common/World.h"
 
 namespace pathFind
 {
 
+template <class Heuristic = ZeroHeuristic>
 class PriorityQueue
 {
 public:
 
+    typedef Heuristic heuristic_t;
+
     PriorityQueue () = delete;
     PriorityQueue (size_t worldWidth, size_t worldHeight,
-                   std::function<uint (uint, uint)> heuristicFunction =
-                   [](uint, uint) { return 0; });
+                   Heuristic heuristic = Heuristic ());
     PriorityQueue (const World& world,
-            std::function<uint (uint, uint)> heuristicFunction =
-                    [](uint, uint) { return 0; });
+                   Heuristic heuristic = Heuristic ());
 
     ~PriorityQueue ();
 
@@ -40,6 +47,8 @@ public:
     void push (const PathTile& tile);
     void pop ();
     PathTile top () const;
+    // top may only be called while the open list is not empty
+    bool empty () const;
 
     void changeBestCost (uint x, uint y, uint bestCost);
     void tryUpdateBestCost (const World::tile_t& tile, const Point& targetXY,
@@ -49,22 +58,30 @@ public:
     // Assumes that user already checked that (x, y) is valid
     PathTile getPathTile (uint x, uint y) const;
 
+    // Empties the queue for a new search that uses a new heuristic. Only
+    // costs as much as the tiles left in the queue.
+    void reset (Heuristic heuristic);
+
 private:
 
-    struct handle_t
+    // Slots are stored as heap index + 1 so that the zero filled memory
+    // calloc hands back already means "not in the heap"
+    const static uint32_t NO_SLOT = 0;
+
+    struct freeDeleter_t
     {
-        handle_t (PathTile p_tile, uint p_index)
-            : tile(p_tile), index(p_index)
+        void operator() (uint32_t* slots) const
         {
+            std::free (slots);
         }
-
-        PathTile tile;
-        uint index;
     };
 
-    // Get a handle of a PathTile at a specific position. If out
-    // of bounds or doesn't exist (is a wall) then nullptr returned
-    std::shared_ptr<handle_t> getHandle (uint x, uint y) const;
+    // Get the heap index of the PathTile at a specific position. If out
+    // of bounds or not in the heap then false is returned
+    bool findSlot (uint x, uint y, uint& index) const;
+
+    // Place a tile at a heap index and record where it went
+    void setSlot (uint index, const PathTile& tile);
 
     uint getLeftChild (uint index) const;
     uint getRightChild (uint index) const;
@@ -77,12 +94,262 @@ private:
     size_t m_worldWidth;
     size_t m_worldHeight;
 
-    std::vector<std::shared_ptr<handle_t>> m_heap;
-    std::unordered_map<uint, std::shared_ptr<handle_t>> m_hashTable;
+    std::vector<PathTile> m_heap;
+    // One entry per tile of the world, 4 bytes each. Pages that the search
+    // never touches are never faulted in, so a queue that only explores a
+    // corner of a huge world stays cheap.
+    std::unique_ptr<uint32_t, freeDeleter_t> m_slots;
 
-    std::function <uint (uint, uint)> m_heurFunct;
+    Heuristic m_heurFunct;
 };
 
+template <class Heuristic>
+PriorityQueue<Heuristic>::PriorityQueue (size_t worldWidth, size_t worldHeight,
+                                         Heuristic heuristic)
+    :m_worldWidth (worldWidth),
+     m_worldHeight (worldHeight),
+     m_slots (static_cast<uint32_t*> (std::calloc (worldWidth * worldHeight, sizeof (uint32_t)))),
+     m_heurFunct (heuristic)
+{
+    if (!m_slots && worldWidth * worldHeight != 0)
+    {
+        throw std::bad_alloc ();
+    }
+}
+
+template <class Heuristic>
+PriorityQueue<Heuristic>::PriorityQueue(const World& world, Heuristic heuristic)
+    : PriorityQueue (world.getWidth (), world.getHeight (), heuristic)
+{
+    m_heap.reserve(world.getNumOpenTiles ());
+    for (uint y = 0; y < m_worldHeight; ++y)
+    {
+        for (uint x = 0; x < m_worldWidth; ++x)
+        {
+            World::tile_t t = world (x, y);
+            if (t.cost != 0)
+            {
+                m_heap.emplace_back (t, Point {x, y}, m_heurFunct (x ,y));
+                m_slots.get ()[t.id] = m_heap.size ();
+            }
+        }
+    }
+    makeHeap();
+}
+
+template <class Heuristic>
+PriorityQueue<Heuristic>::~PriorityQueue ()
+{
+}
+
+template <class Heuristic>
+void PriorityQueue<Heuristic>::push (const World::tile_t& tile, const Point& xy, uint bestCost)
+{
+    PathTile p {tile, xy, m_heurFunct (xy.x, xy.y)};
+    p.setBestCost(bestCost);
+    push (p);
+}
+
+template <class Heuristic>
+void PriorityQueue<Heuristic>::push (const World::tile_t& tile, const Point& xy,
+                                     uint bestCost, const Point& bestTile)
+{
+    PathTile p {tile, xy, m_heurFunct (xy.x, xy.y)};
+    p.setBestCost (bestCost);
+    p.setBestTile (bestTile);
+    push (p);
+}
+
+template <class Heuristic>
+void PriorityQueue<Heuristic>::push (const PathTile& tile)
+{
+    m_heap.push_back (tile);
+    m_slots.get ()[tile.getTile ().id] = m_heap.size ();
+    upHeap (m_heap.size() - 1);
+}
+
+template <class Heuristic>
+void PriorityQueue<Heuristic>::pop ()
+{
+    if (m_heap.empty())
+    {
+        return;
+    }
+
+    m_slots.get ()[m_heap[0].getTile ().id] = NO_SLOT;
+    if (m_heap.size () == 1)
+    {
+        m_heap.pop_back ();
+        return;
+    }
+    m_heap[0] = m_heap.back ();
+    m_heap.pop_back ();
+    downHeap (0);
+}
+
+template <class Heuristic>
+PathTile PriorityQueue<Heuristic>::top () const
+{
+    return m_heap[0];
+}
+
+template <class Heuristic>
+bool PriorityQueue<Heuristic>::empty () const
+{
+    return m_heap.empty ();
+}
+
+template <class Heuristic>
+void PriorityQueue<Heuristic>::changeBestCost(uint x, uint y, uint bestCost)
+{
+    uint index;
+    if (findSlot (x, y, index))
+    {
+        m_heap[index].setBestCost(bestCost);
+        upHeap (index);
+    }
+}
+
+template <class Heuristic>
+void PriorityQueue<Heuristic>::tryUpdateBestCost (const World::tile_t& tile, const Point& targetXY,
+                                                  const PathTile& bestTile)
+{
+    uint index;
+    if (findSlot (targetXY.x, targetXY.y, index))
+    {
+        PathTile& target = m_heap[index];
+        uint totalCost = bestTile.getBestCost() + target.getTile().cost;
+        if (totalCost < target.getBestCost())
+        {
+            target.setBestTile (bestTile.xy ());
+            target.setBestCost(totalCost);
+            upHeap (index);
+        }
+    }
+    else
+    {
+        push (tile, targetXY, tile.cost + bestTile.getBestCost(), bestTile.xy ());
+    }
+}
+
+template <class Heuristic>
+bool PriorityQueue<Heuristic>::isValid (uint x, uint y) const
+{
+    uint index;
+    return findSlot (x, y, index);
+}
+
+template <class Heuristic>
+PathTile PriorityQueue<Heuristic>::getPathTile (uint x, uint y) const
+{
+    uint index = 0;
+    findSlot (x, y, index);
+    return m_heap[index];
+}
+
+template <class Heuristic>
+void PriorityQueue<Heuristic>::reset (Heuristic heuristic)
+{
+    for (const PathTile& tile : m_heap)
+    {
+        m_slots.get ()[tile.getTile ().id] = NO_SLOT;
+    }
+    m_heap.clear ();
+    m_heurFunct = heuristic;
+}
+
+template <class Heuristic>
+bool PriorityQueue<Heuristic>::findSlot (uint x, uint y, uint& index) const
+{
+    if (x < m_worldWidth && y < m_worldHeight)
+    {
+        uint32_t slot = m_slots.get ()[(m_worldWidth * y) + x];
+        if (slot != NO_SLOT)
+        {
+            index = slot - 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <class Heuristic>
+void PriorityQueue<Heuristic>::setSlot (uint index, const PathTile& tile)
+{
+    m_heap[index] = tile;
+    m_slots.get ()[tile.getTile ().id] = index + 1;
+}
+
+template <class Heuristic>
+uint PriorityQueue<Heuristic>::getLeftChild (uint index) const
+{
+    return 2 * index + 1;
+}
+
+template <class Heuristic>
+uint PriorityQueue<Heuristic>::getRightChild (uint index) const
+{
+    return 2 * index + 2;
+}
+
+template <class Heuristic>
+uint PriorityQueue<Heuristic>::getParent (uint index) const
+{
+    return ((index - 1) / 2);
+}
+
+template <class Heuristic>
+void PriorityQueue<Heuristic>::downHeap (uint index)
+{
+    PathTile value = m_heap[index];
+    size_t c;
+    while ((c = getLeftChild (index)) < m_heap.size ())
+    {
+        if (c + 1 < m_heap.size () && m_heap[c + 1] < m_heap[c])
+        {
+            ++c;
+        }
+
+        if (m_heap[c] >= value)
+        {
+            break;
+        }
+
+        // Every move inside the heap has to be mirrored in the slot array
+        // so that a later lookup of the tile lands on the right index.
+        setSlot (index, m_heap[c]);
+        index = c;
+    }
+    setSlot (index, value);
+}
+
+template <class Heuristic>
+void PriorityQueue<Heuristic>::upHeap (uint index)
+{
+    PathTile value = m_heap[index];
+    while (index != 0)
+    {
+        size_t p = getParent (index);
+        if (value >= m_heap[p])
+        {
+            break;
+        }
+
+        setSlot (index, m_heap[p]);
+        index = p;
+    }
+    setSlot (index, value);
+}
+
+template <class Heuristic>
+void PriorityQueue<Heuristic>::makeHeap ()
+{
+    for (int i = (m_heap.size () - 1) / 2; i >= 0; --i)
+    {
+        downHeap (i);
+    }
+}
+
 } /* namespace parPath */
 
 #endif /* PRIORITYQUEUE_H_ */
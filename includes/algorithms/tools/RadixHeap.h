@@ -0,0 +1,429 @@
+/**
+ * File        : RadixHeap.h
+ * Description : A radix heap with the same interface as the PriorityQueue.
+ *               Entries are kept in 33 buckets by the highest bit in which
+ *               their key differs from the last key popped, so as long as
+ *               keys never drop below that (true for Dijkstra and for A*
+ *               with a consistent heuristic) each entry only moves down a
+ *               few buckets over its whole life. Lowering the cost of a tile
+ *               adds a new entry and leaves the old one behind to be skipped.
+ */
+
+#ifndef RADIXHEAP_H_
+#define RADIXHEAP_H_
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <memory>
+
+#include "algorithms/tools/BucketQueue.h"
+#include "algorithms/tools/Heuristics.h"
+#include "algorithms/tools/PathTile.h"
+#include "common/World.h"
+
+namespace pathFind
+{
+
+template <class Heuristic = ZeroHeuristic>
+class RadixHeap
+{
+public:
+
+    typedef Heuristic heuristic_t;
+
+    RadixHeap () = delete;
+    RadixHeap (size_t worldWidth, size_t worldHeight,
+               Heuristic heuristic = Heuristic (),
+               TieBreak tieBreak = TieBreak::LIFO);
+    RadixHeap (const World& world,
+               Heuristic heuristic = Heuristic (),
+               TieBreak tieBreak = TieBreak::LIFO);
+
+    void push (const World::tile_t& tile, const Point& xy, uint bestCost = PathTile::INF);
+    void push (const World::tile_t& tile, const Point& xy, uint bestCost,
+               const Point& bestTile);
+    void push (const PathTile& tile);
+    void pop ();
+    PathTile top () const;
+    bool empty () const;
+
+    void changeBestCost (uint x, uint y, uint bestCost);
+    void tryUpdateBestCost (const World::tile_t& tile, const Point& targetXY,
+                            const PathTile& bestTile);
+
+    bool isValid (uint x, uint y) const;
+    // Assumes that user already checked that (x, y) is valid
+    PathTile getPathTile (uint x, uint y) const;
+
+    // Empties the queue for a new search that uses a new heuristic. Only
+    // costs as much as the tiles left in the queue.
+    void reset (Heuristic heuristic);
+
+private:
+
+    const static uint32_t NO_SLOT = 0;
+    // Bucket 0 holds keys equal to the last key, bucket i keys whose highest
+    // differing bit is i - 1
+    const static uint NUM_BUCKETS = 33;
+
+    struct freeDeleter_t
+    {
+        void operator() (uint32_t* slots) const
+        {
+            std::free (slots);
+        }
+    };
+
+    struct entry_t
+    {
+        uint key;
+        uint32_t node;
+    };
+
+    bool findNode (uint x, uint y, uint32_t& node) const;
+    // An entry is live while its node is queued and still has the same key
+    bool isLive (const entry_t& entry) const;
+
+    uint getBucket (uint key) const;
+
+    void enqueue (uint32_t node);
+    // Move every entry back into the buckets relative to m_last
+    void redistribute (std::vector<entry_t>& entries) const;
+    // Drop dead entries and refill bucket 0 until its front is live. This
+    // waits until top or pop needs the smallest key, as refilling moves
+    // m_last up and m_last has to stay at the last key taken out for the
+    // tiles pushed in the meantime to still fit.
+    void settle () const;
+
+    size_t m_worldWidth;
+    size_t m_worldHeight;
+
+    TieBreak m_tieBreak;
+
+    // Every tile ever pushed, entries index into this
+    std::vector<PathTile> m_nodes;
+    // Node + 1 for every tile id currently in the queue, see PriorityQueue
+    std::unique_ptr<uint32_t, freeDeleter_t> m_slots;
+
+    // Refilled by settle from top, hence mutable
+    mutable std::vector<entry_t> m_buckets[NUM_BUCKETS];
+    // Entries of bucket 0 before this one have already been taken (FIFO)
+    mutable size_t m_head;
+    mutable uint m_last;
+    size_t m_size;
+
+    Heuristic m_heurFunct;
+};
+
+template <class Heuristic>
+RadixHeap<Heuristic>::RadixHeap (size_t worldWidth, size_t worldHeight,
+                                 Heuristic heuristic,
+                                 TieBreak tieBreak)
+    : m_worldWidth (worldWidth),
+      m_worldHeight (worldHeight),
+      m_tieBreak (tieBreak),
+      m_slots (static_cast<uint32_t*> (std::calloc (worldWidth * worldHeight, sizeof (uint32_t)))),
+      m_head (0),
+      m_last (0),
+      m_size (0),
+      m_heurFunct (heuristic)
+{
+    if (!m_slots && worldWidth * worldHeight != 0)
+    {
+        throw std::bad_alloc ();
+    }
+}
+
+template <class Heuristic>
+RadixHeap<Heuristic>::RadixHeap (const World& world, Heuristic heuristic,
+                                 TieBreak tieBreak)
+    : RadixHeap (world.getWidth (), world.getHeight (), heuristic, tieBreak)
+{
+    m_nodes.reserve (world.getNumOpenTiles ());
+    for (uint y = 0; y < m_worldHeight; ++y)
+    {
+        for (uint x = 0; x < m_worldWidth; ++x)
+        {
+            World::tile_t t = world (x, y);
+            if (t.cost != 0)
+            {
+                push (PathTile {t, {x, y}, m_heurFunct (x, y)});
+            }
+        }
+    }
+}
+
+template <class Heuristic>
+void RadixHeap<Heuristic>::push (const World::tile_t& tile, const Point& xy, uint bestCost)
+{
+    PathTile p {tile, xy, m_heurFunct (xy.x, xy.y)};
+    p.setBestCost (bestCost);
+    push (p);
+}
+
+template <class Heuristic>
+void RadixHeap<Heuristic>::push (const World::tile_t& tile, const Point& xy,
+                                 uint bestCost, const Point& bestTile)
+{
+    PathTile p {tile, xy, m_heurFunct (xy.x, xy.y)};
+    p.setBestCost (bestCost);
+    p.setBestTile (bestTile);
+    push (p);
+}
+
+template <class Heuristic>
+void RadixHeap<Heuristic>::push (const PathTile& tile)
+{
+    // Pushing a tile that is already queued replaces it
+    uint32_t old;
+    if (findNode (tile.xy ().x, tile.xy ().y, old))
+    {
+        --m_size;
+    }
+
+    uint32_t node = m_nodes.size ();
+    m_nodes.push_back (tile);
+    m_slots.get ()[tile.getTile ().id] = node + 1;
+    ++m_size;
+    enqueue (node);
+}
+
+template <class Heuristic>
+void RadixHeap<Heuristic>::pop ()
+{
+    if (m_size == 0)
+    {
+        return;
+    }
+
+    settle ();
+    std::vector<entry_t>& bucket = m_buckets[0];
+    if (m_tieBreak == TieBreak::LIFO)
+    {
+        m_slots.get ()[m_nodes[bucket.back ().node].getTile ().id] = NO_SLOT;
+        bucket.pop_back ();
+    }
+    else
+    {
+        m_slots.get ()[m_nodes[bucket[m_head].node].getTile ().id] = NO_SLOT;
+        ++m_head;
+    }
+
+    if (--m_size == 0)
+    {
+        for (std::vector<entry_t>& stale : m_buckets)
+        {
+            stale.clear ();
+        }
+        m_head = 0;
+    }
+}
+
+template <class Heuristic>
+PathTile RadixHeap<Heuristic>::top () const
+{
+    settle ();
+    const std::vector<entry_t>& bucket = m_buckets[0];
+    return m_nodes[m_tieBreak == TieBreak::LIFO ? bucket.back ().node : bucket[m_head].node];
+}
+
+template <class Heuristic>
+bool RadixHeap<Heuristic>::empty () const
+{
+    return m_size == 0;
+}
+
+template <class Heuristic>
+void RadixHeap<Heuristic>::changeBestCost (uint x, uint y, uint bestCost)
+{
+    uint32_t node;
+    if (findNode (x, y, node))
+    {
+        m_nodes[node].setBestCost (bestCost);
+        enqueue (node);
+    }
+}
+
+template <class Heuristic>
+void RadixHeap<Heuristic>::tryUpdateBestCost (const World::tile_t& tile, const Point& targetXY,
+                                              const PathTile& bestTile)
+{
+    uint32_t node;
+    if (findNode (targetXY.x, targetXY.y, node))
+    {
+        PathTile& target = m_nodes[node];
+        uint totalCost = bestTile.getBestCost () + target.getTile ().cost;
+        if (totalCost < target.getBestCost ())
+        {
+            target.setBestTile (bestTile.xy ());
+            target.setBestCost (totalCost);
+            enqueue (node);
+        }
+    }
+    else
+    {
+        push (tile, targetXY, tile.cost + bestTile.getBestCost (), bestTile.xy ());
+    }
+}
+
+template <class Heuristic>
+bool RadixHeap<Heuristic>::isValid (uint x, uint y) const
+{
+    uint32_t node;
+    return findNode (x, y, node);
+}
+
+template <class Heuristic>
+PathTile RadixHeap<Heuristic>::getPathTile (uint x, uint y) const
+{
+    uint32_t node = 0;
+    findNode (x, y, node);
+    return m_nodes[node];
+}
+
+template <class Heuristic>
+void RadixHeap<Heuristic>::reset (Heuristic heuristic)
+{
+    for (uint32_t node = 0; node < m_nodes.size (); ++node)
+    {
+        if (m_slots.get ()[m_nodes[node].getTile ().id] == node + 1)
+        {
+            m_slots.get ()[m_nodes[node].getTile ().id] = NO_SLOT;
+        }
+    }
+    m_nodes.clear ();
+    for (std::vector<entry_t>& bucket : m_buckets)
+    {
+        bucket.clear ();
+    }
+    m_head = 0;
+    m_last = 0;
+    m_size = 0;
+    m_heurFunct = heuristic;
+}
+
+template <class Heuristic>
+bool RadixHeap<Heuristic>::findNode (uint x, uint y, uint32_t& node) const
+{
+    if (x < m_worldWidth && y < m_worldHeight)
+    {
+        uint32_t slot = m_slots.get ()[(m_worldWidth * y) + x];
+        if (slot != NO_SLOT)
+        {
+            node = slot - 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <class Heuristic>
+bool RadixHeap<Heuristic>::isLive (const entry_t& entry) const
+{
+    const PathTile& tile = m_nodes[entry.node];
+    return m_slots.get ()[tile.getTile ().id] == entry.node + 1 &&
+           tile.getCombinedHeuristic () == entry.key;
+}
+
+template <class Heuristic>
+uint RadixHeap<Heuristic>::getBucket (uint key) const
+{
+    return key == m_last ? 0 : 32 - __builtin_clz (key ^ m_last);
+}
+
+template <class Heuristic>
+void RadixHeap<Heuristic>::enqueue (uint32_t node)
+{
+    uint key = m_nodes[node].getCombinedHeuristic ();
+    if (key < m_last)
+    {
+        // Only an inconsistent heuristic gets here. Start over from the
+        // smaller key, every bucket has to be sorted again.
+        std::vector<entry_t> entries (m_buckets[0].begin () + m_head, m_buckets[0].end ());
+        m_buckets[0].clear ();
+        m_head = 0;
+        for (uint i = 1; i < NUM_BUCKETS; ++i)
+        {
+            entries.insert (entries.end (), m_buckets[i].begin (), m_buckets[i].end ());
+            m_buckets[i].clear ();
+        }
+        m_last = key;
+        redistribute (entries);
+    }
+    m_buckets[getBucket (key)].push_back ({key, node});
+}
+
+template <class Heuristic>
+void RadixHeap<Heuristic>::redistribute (std::vector<entry_t>& entries) const
+{
+    for (const entry_t& entry : entries)
+    {
+        if (isLive (entry))
+        {
+            m_buckets[getBucket (entry.key)].push_back (entry);
+        }
+    }
+}
+
+template <class Heuristic>
+void RadixHeap<Heuristic>::settle () const
+{
+    std::vector<entry_t>& bucket = m_buckets[0];
+    while (true)
+    {
+        if (m_tieBreak == TieBreak::LIFO)
+        {
+            while (!bucket.empty () && !isLive (bucket.back ()))
+            {
+                bucket.pop_back ();
+            }
+        }
+        else
+        {
+            while (m_head < bucket.size () && !isLive (bucket[m_head]))
+            {
+                ++m_head;
+            }
+            if (m_head == bucket.size ())
+            {
+                bucket.clear ();
+                m_head = 0;
+            }
+        }
+
+        if (m_head < bucket.size () || m_size == 0)
+        {
+            break;
+        }
+
+        // Bucket 0 ran dry, so the smallest live key sits in the first non
+        // empty bucket. Make it the new last key and spread that bucket out.
+        uint i = 1;
+        while (i < NUM_BUCKETS && m_buckets[i].empty ())
+        {
+            ++i;
+        }
+        std::vector<entry_t> entries;
+        entries.swap (m_buckets[i]);
+
+        bool found = false;
+        for (const entry_t& entry : entries)
+        {
+            if (isLive (entry) && (!found || entry.key < m_last))
+            {
+                m_last = entry.key;
+                found = true;
+            }
+        }
+        if (found)
+        {
+            redistribute (entries);
+        }
+    }
+}
+
+} /* namespace pathFind */
+
+#endif /* RADIXHEAP_H_ */
@@ -0,0 +1,227 @@
+/**
+ * File        : SearchState.h
+ * Description : Per tile search state (best cost, the tile it was reached
+ *               from and whether it has been expanded) kept as flat arrays
+ *               indexed by tile id. Replaces the hash maps of PathTiles the
+ *               algorithms used to keep, so marking and looking up a tile is
+ *               an array access instead of a hash and a node allocation.
+ *               Every tile is stamped with the search that last touched it,
+ *               so starting a new search only bumps the current stamp and
+ *               leftovers from earlier searches are ignored as they are read.
+ *               On worlds too big for the arrays to pay off, when a search
+ *               is only expected to touch a small part of the world, the
+ *               same state is kept in a FlatHashMap instead.
+ */
+
+#ifndef SEARCHSTATE_H_
+#define SEARCHSTATE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "algorithms/tools/FlatHashMap.h"
+#include "algorithms/tools/PathTile.h"
+#include "common/World.h"
+#include "common/Point.h"
+
+namespace pathFind
+{
+
+class SearchState
+{
+public:
+
+    SearchState () = delete;
+    // expectedTiles is a guess at how many tiles a search will touch, 0 if
+    // it could be any part of the world. See isDenseBetter.
+    SearchState (size_t worldWidth, size_t worldHeight, size_t expectedTiles = 0);
+    SearchState (const World& world, size_t expectedTiles = 0);
+
+    // Rough number of tiles a search from start to end touches. An informed
+    // search stays in a band around the line between the two, an
+    // uninformed one grows a diamond out to the distance of the end.
+    static size_t estimateTiles (const Point& start, const Point& end, bool informed);
+    // Arrays over the whole world while they are cheap or the search is
+    // expected to cover a good part of the world, a hash map of the touched
+    // tiles otherwise
+    static bool isDenseBetter (size_t numTiles, size_t expectedTiles);
+    bool isDense () const;
+    // Whether the state keeps its tiles the way isDenseBetter picks for a
+    // search expected to touch expectedTiles
+    bool fits (size_t expectedTiles) const;
+
+    // INF for tiles that have not been reached
+    uint getBestCost (tileId_t id) const;
+    // The tile id was reached from. The start of a search is reached
+    // from itself.
+    tileId_t getBestTile (tileId_t id) const;
+    void setBestCost (tileId_t id, uint bestCost, tileId_t bestTile);
+    bool isReached (tileId_t id) const;
+
+    bool isClosed (tileId_t id) const;
+    void close (tileId_t id);
+    // Records the best cost and best tile of an expanded tile and closes it
+    void close (const World& world, const PathTile& tile);
+    // Rebuilds the PathTile of a reached tile (without its heuristic)
+    PathTile getPathTile (const World& world, tileId_t id) const;
+
+    Point getPoint (tileId_t id) const;
+
+    // Starts a new search, every tile is unreached and open again
+    void reset ();
+
+    /**
+     * Follows the best tiles back from a tile to the start of the search.
+     * @param id    The tile to start from, usually the end of the search.
+     * @param path  Gets the points from id to the start (both included)
+     *              appended to it.
+     */
+    void getPath (tileId_t id, std::vector<Point>& path) const;
+
+private:
+
+    typedef struct sparseTile_t
+    {
+        uint bestCost;
+        bool closed;
+        tileId_t bestTile;
+    } sparseTile_t;
+
+    // Worlds up to this many tiles always get arrays (12 bytes a tile)
+    const static size_t DENSE_MAX_TILES = static_cast<size_t> (1) << 26;
+    // Larger worlds only get arrays if a search is expected to touch more
+    // than 1 / SPARSE_RATIO of them
+    const static size_t SPARSE_RATIO = 16;
+    // Band width of an informed search in estimateTiles
+    const static size_t INFORMED_WIDTH = 64;
+
+    // Whether the tile has been touched since the last reset
+    bool isCurrent (tileId_t id) const;
+
+    size_t m_worldWidth;
+    size_t m_worldHeight;
+    bool m_dense;
+
+    std::vector<uint> m_bestCosts;
+    // Ids are stored in 32 bits to halve the array, which is plenty for any
+    // world that fits in memory alongside it
+    std::vector<uint32_t> m_bestTiles;
+    // The generation a tile was last touched in shifted up by one, with its
+    // closed flag in the low bit. Stamps start at zero and generations at
+    // one so a new state has no current tiles.
+    std::vector<uint32_t> m_stamps;
+    uint32_t m_generation;
+
+    // Only used if the state is not dense
+    FlatHashMap<sparseTile_t> m_sparseTiles;
+};
+
+// Called for every neighbor of every expanded tile, so defined here to let
+// the compiler inline them
+
+inline bool SearchState::isCurrent (tileId_t id) const
+{
+    return (m_stamps[id] >> 1) == m_generation;
+}
+
+inline bool SearchState::isDense () const
+{
+    return m_dense;
+}
+
+inline uint SearchState::getBestCost (tileId_t id) const
+{
+    if (!m_dense)
+    {
+        const sparseTile_t* tile = m_sparseTiles.find (id);
+        return tile != nullptr ? tile->bestCost : PathTile::INF;
+    }
+    return isCurrent (id) ? m_bestCosts[id] : PathTile::INF;
+}
+
+inline tileId_t SearchState::getBestTile (tileId_t id) const
+{
+    if (!m_dense)
+    {
+        const sparseTile_t* tile = m_sparseTiles.find (id);
+        return tile != nullptr ? tile->bestTile : id;
+    }
+    return m_bestTiles[id];
+}
+
+inline void SearchState::setBestCost (tileId_t id, uint bestCost, tileId_t bestTile)
+{
+    if (!m_dense)
+    {
+        sparseTile_t* tile = m_sparseTiles.find (id);
+        if (tile == nullptr)
+        {
+            m_sparseTiles.insert (id, sparseTile_t {bestCost, false, bestTile});
+        }
+        else
+        {
+            tile->bestCost = bestCost;
+            tile->bestTile = bestTile;
+        }
+        return;
+    }
+    if (!isCurrent (id))
+    {
+        m_stamps[id] = m_generation << 1;
+    }
+    m_bestCosts[id] = bestCost;
+    m_bestTiles[id] = static_cast<uint32_t> (bestTile);
+}
+
+inline bool SearchState::isReached (tileId_t id) const
+{
+    return getBestCost (id) != PathTile::INF;
+}
+
+inline bool SearchState::isClosed (tileId_t id) const
+{
+    if (!m_dense)
+    {
+        const sparseTile_t* tile = m_sparseTiles.find (id);
+        return tile != nullptr && tile->closed;
+    }
+    return m_stamps[id] == ((m_generation << 1) | 1);
+}
+
+inline void SearchState::close (tileId_t id)
+{
+    if (!m_dense)
+    {
+        sparseTile_t* tile = m_sparseTiles.find (id);
+        if (tile == nullptr)
+        {
+            m_sparseTiles.insert (id, sparseTile_t {PathTile::INF, true, id});
+        }
+        else
+        {
+            tile->closed = true;
+        }
+        return;
+    }
+    if (!isCurrent (id))
+    {
+        m_bestCosts[id] = PathTile::INF;
+    }
+    m_stamps[id] = (m_generation << 1) | 1;
+}
+
+inline void SearchState::close (const World& world, const PathTile& tile)
+{
+    tileId_t id = tile.getTile ().id;
+    setBestCost (id, tile.getBestCost (), world.getID (tile.bestTile ().x, tile.bestTile ().y));
+    close (id);
+}
+
+inline Point SearchState::getPoint (tileId_t id) const
+{
+    return Point (id % m_worldWidth, id / m_worldWidth);
+}
+
+} /* namespace pathFind */
+
+#endif /* SEARCHSTATE_H_ */
@@ -0,0 +1,125 @@
+/**
+ * File        : SearchWorkspace.h
+ * Description : Everything one search needs besides the world: the per tile
+ *               SearchState and an open list. A workspace is built once for
+ *               a world and then reset between queries, which costs about as
+ *               much as the tiles the previous query left in its open list
+ *               instead of reallocating or clearing arrays the size of the
+ *               world. The per tile state can be swapped for the
+ *               CompactSearchState on worlds too big for the SearchState.
+ */
+
+#ifndef SEARCHWORKSPACE_H_
+#define SEARCHWORKSPACE_H_
+
+#include "algorithms/tools/Heuristics.h"
+#include "algorithms/tools/PriorityQueue.h"
+#include "algorithms/tools/SearchState.h"
+#include "common/World.h"
+
+namespace pathFind
+{
+
+template <class OpenList = PriorityQueue<ManhattanHeuristic>, class State = SearchState>
+class SearchWorkspace
+{
+public:
+
+    typedef typename OpenList::heuristic_t heuristic_t;
+
+    SearchWorkspace () = delete;
+    // The world must outlive the workspace
+    SearchWorkspace (const World& world, heuristic_t heuristic = heuristic_t ());
+    // Passes a guess at how many tiles a query touches on to the state, see
+    // SearchState::isDenseBetter
+    SearchWorkspace (const World& world, heuristic_t heuristic, size_t expectedTiles);
+
+    SearchWorkspace (const SearchWorkspace&) = delete;
+    SearchWorkspace& operator= (const SearchWorkspace&) = delete;
+
+    // Gets the workspace ready for a new query that uses a new heuristic
+    void reset (heuristic_t heuristic = heuristic_t ());
+
+    const World& getWorld () const;
+    // Whether the workspace can be reset for a search of world, which has to
+    // be the world it was built for with the same dimensions
+    bool isFor (const World& world) const;
+    // Also whether the state suits a query expected to touch expectedTiles.
+    // On huge worlds a short query wants a sparse state and a long one a
+    // dense one, so the workspace is built again when that changes.
+    bool isFor (const World& world, size_t expectedTiles) const;
+    OpenList& getOpenList ();
+    State& getSearchState ();
+
+private:
+
+    const World& m_world;
+    // The dimensions the state and open list were sized for, a world can be
+    // loaded again in place with others
+    size_t m_widthBuilt;
+    size_t m_heightBuilt;
+    State m_searchState;
+    OpenList m_openList;
+};
+
+template <class OpenList, class State>
+SearchWorkspace<OpenList, State>::SearchWorkspace (const World& world, heuristic_t heuristic)
+    : m_world (world),
+      m_widthBuilt (world.getWidth ()),
+      m_heightBuilt (world.getHeight ()),
+      m_searchState (world),
+      m_openList (world.getWidth (), world.getHeight (), heuristic)
+{
+}
+
+template <class OpenList, class State>
+SearchWorkspace<OpenList, State>::SearchWorkspace (const World& world, heuristic_t heuristic,
+                                                   size_t expectedTiles)
+    : m_world (world),
+      m_widthBuilt (world.getWidth ()),
+      m_heightBuilt (world.getHeight ()),
+      m_searchState (world, expectedTiles),
+      m_openList (world.getWidth (), world.getHeight (), heuristic)
+{
+}
+
+template <class OpenList, class State>
+void SearchWorkspace<OpenList, State>::reset (heuristic_t heuristic)
+{
+    m_searchState.reset ();
+    m_openList.reset (heuristic);
+}
+
+template <class OpenList, class State>
+const World& SearchWorkspace<OpenList, State>::getWorld () const
+{
+    return m_world;
+}
+
+template <class OpenList, class State>
+bool SearchWorkspace<OpenList, State>::isFor (const World& world) const
+{
+    return &world == &m_world && m_widthBuilt == world.getWidth () && m_heightBuilt == world.getHeight ();
+}
+
+template <class OpenList, class State>
+bool SearchWorkspace<OpenList, State>::isFor (const World& world, size_t expectedTiles) const
+{
+    return isFor (world) && m_searchState.fits (expectedTiles);
+}
+
+template <class OpenList, class State>
+OpenList& SearchWorkspace<OpenList, State>::getOpenList ()
+{
+    return m_openList;
+}
+
+template <class OpenList, class State>
+State& SearchWorkspace<OpenList, State>::getSearchState ()
+{
+    return m_searchState;
+}
+
+} /* namespace pathFind */
+
+#endif /* SEARCHWORKSPACE_H_ */
@@ -0,0 +1,90 @@
+/**
+ * File        : WorkerPool.h
+ * Description : Long lived worker threads, each pinned to a core, that the
+ *               parallel algorithms run their phases on instead of starting
+ *               and joining new threads for every search. The tasks of one
+ *               phase always run at the same time on different threads, so
+ *               they may wait on each other (e.g. at a barrier). Workers are
+ *               only started when every existing one is busy, so a process
+ *               that solves queries over and over pays for starting them
+ *               once.
+ */
+
+#ifndef WORKERPOOL_H_
+#define WORKERPOOL_H_
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pathFind
+{
+
+class WorkerPool
+{
+public:
+
+    // Called with the index of the task, from 0 to the number of tasks - 1
+    typedef std::function<void (uint)> task_t;
+
+    // Unless pinned is false, each worker is pinned to its own core of the
+    // ones the process may run on, leaving the first to the threads calling
+    // run. Workers started once every core has one are not pinned.
+    explicit WorkerPool (bool pinned = true);
+    ~WorkerPool ();
+
+    WorkerPool (const WorkerPool&) = delete;
+    WorkerPool& operator= (const WorkerPool&) = delete;
+
+    // The pool every algorithm runs on
+    static WorkerPool& getShared ();
+
+    /**
+     * Runs task (0) to task (numTasks - 1) all at once and returns when every
+     * one of them has. The calling thread runs task 0 itself and idle workers
+     * the rest, with new workers started if too few are idle. Several threads
+     * may run phases on the same pool at once. If a task throws, the first
+     * exception is rethrown here once the rest have finished.
+     */
+    void run (uint numTasks, const task_t& task);
+
+    // Number of workers started so far
+    size_t size () const;
+
+private:
+
+    struct phase_t;
+
+    // Core of a worker that is not pinned
+    const static int NO_CORE = -1;
+
+    typedef struct worker_t
+    {
+        std::thread thread;
+        std::mutex lock;
+        std::condition_variable wake;
+        // Set (under lock) to hand the worker a task, cleared once it ran it
+        phase_t* phase = nullptr;
+        uint index = 0;
+        bool stop = false;
+    } worker_t;
+
+    // Takes idle workers off m_idle, starting new ones until there are count
+    void claimWorkers (size_t count, std::vector<worker_t*>& workers);
+    void workerLoop (worker_t& worker, int core);
+
+    bool m_pinned;
+    // The cores the process was allowed to run on when the pool was made
+    std::vector<int> m_cores;
+    mutable std::mutex m_lock;
+    std::vector<std::unique_ptr<worker_t>> m_workers;
+    std::vector<worker_t*> m_idle;
+};
+
+} /* namespace pathFind */
+
+#endif /* WORKERPOOL_H_ */
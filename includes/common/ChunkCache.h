@@ -0,0 +1,142 @@
+/**
+ * File        : ChunkCache.h
+ * Description : Pages fixed size chunks of a world's cost plane in from disk on
+ *               demand and keeps the most recently used ones in memory under a
+ *               fixed memory budget. Used by World for worlds larger than RAM and
+ *               for compressed worlds, whose chunks are decompressed the first
+ *               time they are touched.
+ */
+
+#ifndef CHUNKCACHE_H_
+#define CHUNKCACHE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace pathFind
+{
+
+class ChunkCache
+{
+public:
+
+    /**
+     * Opens the file that holds the cost plane.
+     * @param fileName      The file to page chunks in from.
+     * @param dataOffset    Byte offset of the cost plane within the file.
+     * @param dataSize      Size of the cost plane in bytes.
+     * @param chunkSize     Size of a chunk in bytes.
+     * @param memoryBudget  Maximum number of bytes of chunks held in the cache,
+     *                      counting the chunk each reading thread holds on to.
+     *                      At least one chunk per reading thread is always held.
+     * @param chunkIndex    For compressed planes, the file offset of every run-length
+     *                      encoded chunk followed by the offset where the last one
+     *                      ends. Empty if the plane is stored raw at dataOffset.
+     */
+    ChunkCache (const std::string& fileName, uint64_t dataOffset, uint64_t dataSize,
+                size_t chunkSize, size_t memoryBudget,
+                std::vector<uint64_t> chunkIndex = std::vector<uint64_t> ());
+    ~ChunkCache ();
+
+    // The cache owns a file descriptor so it may not be copied
+    ChunkCache (const ChunkCache&) = delete;
+    ChunkCache& operator= (const ChunkCache&) = delete;
+
+    bool isOpen () const;
+
+    /**
+     * Returns the byte at the given offset of the cost plane, paging its chunk
+     * in (and the least recently used chunk out) if needed. Safe to call from
+     * several threads at once.
+     */
+    uint8_t get (uint64_t offset) const;
+
+    size_t getChunkSize () const;
+    size_t getCapacity () const;
+
+private:
+
+    typedef std::shared_ptr<const std::vector<uint8_t>> chunkPtr_t;
+
+    // Threads reading past this many at once read every byte through the lock
+    const static size_t NUM_PINS = 64;
+    // The pin of a thread that found every pin taken
+    const static size_t NO_PIN = NUM_PINS;
+
+    struct entry_t
+    {
+        uint64_t index;
+        chunkPtr_t data;
+    };
+
+    // The chunk a thread last read from. Padded to a cache line so threads
+    // don't share the lines of their pins.
+    struct pin_t
+    {
+        uint64_t index;
+        chunkPtr_t data;
+        char padding[64 - sizeof (uint64_t) - sizeof (chunkPtr_t)];
+    };
+
+    // The pins of one cache. A thread claims a free pin the first time it
+    // reads the cache and gives it back, unpinning its chunk, when it exits.
+    // Threads hold on to the table weakly so one outliving the cache has
+    // nothing to give back.
+    struct pinTable_t
+    {
+        explicit pinTable_t (size_t numPins);
+
+        // NO_PIN if every pin is taken
+        size_t claim ();
+        // Only called by the thread holding the pin
+        void release (size_t pin);
+
+        // Only the thread a pin belongs to uses it
+        std::vector<pin_t> pins;
+        // Pins holding a chunk, these count against the capacity
+        std::atomic<size_t> numPinned;
+        std::atomic<size_t> numFree;
+        std::mutex lock;
+        std::vector<size_t> freePins;
+    };
+
+    // The pins the calling thread holds in every cache it has read
+    class ThreadPins;
+    static ThreadPins& getThreadPins ();
+
+    // The pin of the calling thread, claimed on its first read of the cache
+    size_t getThreadPin () const;
+    chunkPtr_t getChunk (uint64_t index) const;
+    chunkPtr_t readChunk (uint64_t index) const;
+    void readBytes (uint8_t* dest, size_t size, uint64_t fileOffset, uint64_t index) const;
+
+    int m_fd;
+    uint64_t m_dataOffset;
+    uint64_t m_dataSize;
+    size_t m_chunkSize;
+    size_t m_capacity;
+    std::vector<uint64_t> m_chunkIndex;
+
+    // Tells caches apart in the threads, unlike their addresses it is
+    // never reused
+    uint64_t m_id;
+    // One pin per reading thread so that runs of reads within one chunk
+    // never touch the lock
+    std::shared_ptr<pinTable_t> m_pinTable;
+
+    // Front of the list is the most recently used chunk
+    mutable std::mutex m_lock;
+    mutable std::list<entry_t> m_lru;
+    mutable std::unordered_map<uint64_t, std::list<entry_t>::iterator> m_lookup;
+};
+
+} /* namespace pathFind */
+
+#endif /* CHUNKCACHE_H_ */
@@ -0,0 +1,59 @@
+/**
+ * File        : Queries.h
+ * Description : Reads and writes query files, lists of start and end points
+ *               to be solved in one batch. Each line of a query file holds
+ *               one query as "<start x> <start y> <end x> <end y>".
+ */
+
+#ifndef QUERIES_H_
+#define QUERIES_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "common/Point.h"
+
+namespace pathFind
+{
+
+const std::string QUERIES_EXT = ".queries";
+
+typedef struct query_t
+{
+    Point start;
+    Point end;
+} query_t;
+
+// Returns false if the file can't be opened or holds anything but whole queries
+inline bool readQueries (const std::string& fileName, std::vector<query_t>& queries)
+{
+    std::ifstream queryFile (fileName);
+    if (!queryFile)
+    {
+        return false;
+    }
+
+    queries.clear ();
+    query_t query;
+    while (queryFile >> query.start.x >> query.start.y >> query.end.x >> query.end.y)
+    {
+        queries.push_back (query);
+    }
+    return queryFile.eof ();
+}
+
+inline bool writeQueries (const std::string& fileName, const std::vector<query_t>& queries)
+{
+    std::ofstream queryFile (fileName);
+    for (const auto& query : queries)
+    {
+        queryFile << query.start.x << " " << query.start.y << " "
+                  << query.end.x << " " << query.end.y << "\n";
+    }
+    return static_cast<bool> (queryFile);
+}
+
+} /* namespace pathFind */
+
+#endif /* QUERIES_H_ */
@@ -17,6 +17,7 @@
 #include <boost/filesystem.hpp>
 
 #include "common/Point.h"
+#include "common/World.h"
 
 namespace pathFind
 {
@@ -38,7 +39,7 @@ struct StatPoint
 };
 
 inline void writeResults (const std::vector<Point>& path,
-                          const std::vector<std::unordered_map<uint, StatPoint>>& stats,
+                          const std::vector<std::unordered_map<tileId_t, StatPoint>>& stats,
                           const std::string& worldName, const std::string& algName, uint ms,
                           uint totalCost)
 {
@@ -63,7 +64,7 @@ inline void writeResults (const std::vector<Point>& path,
 
     std::stringstream threadInfo;
 
-    std::unordered_map<uint, StatPoint> combinedStats;
+    std::unordered_map<tileId_t, StatPoint> combinedStats;
     uint totalSpread = 0;
     uint totalWork = 0;
     for (uint i = 0; i < stats.size (); ++i)
@@ -129,7 +130,7 @@ inline void writeResults (const std::vector<Point>& path,
     performanceFile.close ();
 }
 
-inline bool readResults (std::vector<Point>& path, std::vector<std::unordered_map<uint, StatPoint>>& stats,
+inline bool readResults (std::vector<Point>& path, std::vector<std::unordered_map<tileId_t, StatPoint>>& stats,
                          uint& maxProcessCount, const Point& start, const Point& end,
                          const std::string& worldName, const std::string& algName)
 {
@@ -177,8 +178,8 @@ inline bool readResults (std::vector<Point>& path, std::vector<std::unordered_ma
         }
         else
         {
-            uint id, x, y, processCount;
-            id = std::stoi (token);
+            tileId_t id = std::stoull (token);
+            uint x, y, processCount;
             statFile >> x >> y >> processCount;
             if (processCount > maxProcessCount)
             {
@@ -0,0 +1,32 @@
+/**
+ * File        : RunLength.h
+ * Description : A small byte oriented run-length codec used to compress the chunks
+ *               of a world's cost plane. Runs of three or more equal bytes are
+ *               stored as a count and the byte, everything else is copied as is
+ *               behind a count so incompressible data grows by less than 1%.
+ */
+
+#ifndef RUNLENGTH_H_
+#define RUNLENGTH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pathFind
+{
+
+/**
+ * Appends the run-length encoding of size bytes starting at source to dest.
+ */
+void runLengthEncode (const uint8_t* source, size_t size, std::vector<uint8_t>& dest);
+
+/**
+ * Decodes sourceSize bytes of run-length encoded data into dest.
+ * @return True if the data decoded to exactly destSize bytes, false if it is corrupt.
+ */
+bool runLengthDecode (const uint8_t* source, size_t sourceSize, uint8_t* dest, size_t destSize);
+
+} /* namespace pathFind */
+
+#endif /* RUNLENGTH_H_ */
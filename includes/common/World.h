@@ -10,11 +10,21 @@
 
 #include <vector>
 #include <cstddef>
+#include <cstdint>
 #include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "common/ChunkCache.h"
+#include "common/Point.h"
 
 namespace pathFind
 {
 
+// Tile ids are 64 bits wide so that worlds past 65536x65536 tiles do not overflow
+typedef uint64_t tileId_t;
+
 /**
  * A World object is what represents the space in which the path-finding algorithms will
  * take place. It is essentially a grid of tiles with an associated cost for each. Some
@@ -29,29 +39,112 @@ public:
      */
     World ();
 
+    /**
+     * The order the tiles are stored in. Tile ids are always row-major, the layout
+     * only decides where in memory the cost of a tile lives.
+     * ROW_MAJOR - one row after another.
+     * BLOCKED   - square blocks of (1 << blockShift) tiles a side stored one after
+     *             another (row-major), each block stored row-major inside.
+     * MORTON    - same blocks as BLOCKED but the tiles inside a block are stored in
+     *             Z-order so that both axes stay close together in memory.
+     */
+    enum Layout {ROW_MAJOR, BLOCKED, MORTON};
+
     /**
      * Constructs a world object with the specified width and height.
      * Each tiles cost is set to 0 by default
-     * @param height   The height of the world.
-     * @param width    The width of the world.
+     * @param height      The height of the world.
+     * @param width       The width of the world.
+     * @param layout      The order the tiles are stored in memory.
+     * @param blockShift  Log2 of the block side for the BLOCKED and MORTON layouts.
      */
-    World (size_t width, size_t height);
+    World (size_t width, size_t height, Layout layout = ROW_MAJOR,
+           uint blockShift = DEFAULT_BLOCK_SHIFT);
+
+    /**
+     * Releases the memory mapping of a binary world if one is held.
+     */
+    ~World ();
 
     // We do not want copying to take place.
     World (const World&) = delete;
     World& operator= (const World&) = delete;
 
-    uint getID (uint x, uint y) const;
+    const static uint DEFAULT_BLOCK_SHIFT = 4;
+    const static uint MAX_BLOCK_SHIFT = 15;
+
+    // Passing this as the memory budget lets the world pick one from the
+    // amount of physical memory in the machine.
+    const static size_t AUTO_MEMORY_BUDGET = 0;
+
+    tileId_t getID (uint x, uint y) const;
+
+    /**
+     * Bits of a neighbor mask. A bit is set when the tile in that direction is inside
+     * the world and open. The bits are in the order the algorithms expand neighbors.
+     */
+    enum Direction {EAST = 1, SOUTH = 2, WEST = 4, NORTH = 8};
+
+    /**
+     * Precomputes the neighbor mask of every tile. The masks live in a grid padded
+     * with a border of walls so building them needs no bounds checks, and tiles on
+     * the edge of the world simply get no bits for the directions leading out of it.
+     * Must be called before getNeighborMask and again if the costs change.
+     */
+    void buildNeighborMasks ();
+    bool hasNeighborMasks () const;
+
+    /**
+     * Returns the mask of open neighbors of the tile at (x, y), see Direction. Walls
+     * have masks too, listing the open tiles around them.
+     */
+    uint getNeighborMask (uint x, uint y) const;
+
+    /**
+     * Returns the neighbor of point in the direction of the lowest bit set in mask and
+     * clears that bit. Calling this until mask is 0 visits every neighbor in the mask
+     * without any bounds checks or cost loads.
+     */
+    static Point nextNeighbor (const Point& point, uint& mask);
+
+    /**
+     * Labels every open tile with the connected component it belongs to. Each thread
+     * runs a union-find over its own band of rows and the bands are stitched together
+     * afterwards. Walls get the label 0 and components are numbered from 1 in the
+     * order their first tile appears row by row. writeBinary stores the labels as an
+     * extra section that loadFile maps back in.
+     * @param numThreads  Number of bands labeled at once.
+     */
+    void buildComponentLabels (uint numThreads = 1);
+    bool hasComponentLabels () const;
+
+    // Drops the component labels, they will not be written out by writeBinary
+    void releaseLabels ();
+    size_t getNumComponents () const;
+
+    /**
+     * Returns the component label of the tile at (x, y), 0 for walls.
+     */
+    uint32_t getComponent (uint x, uint y) const;
+
+    /**
+     * Checks in O(1) whether a path from start to end can exist. Without component
+     * labels only the bounds can be checked.
+     * @return False if either end is outside the world, is a wall or they lie in
+     *         different components.
+     */
+    bool isReachable (uint startX, uint startY, uint endX, uint endY) const;
 
     /**
      * Struct meant to represent a tile in the world where path-finding takes place.
      * Each tile has a cost to enter, but some may not be able to be entered in which
-     * case the cost has no meaning and is set to zero.
+     * case the cost has no meaning and is set to zero. Tiles are not stored like this,
+     * the world only keeps one byte of cost per tile and builds these on request.
      */
     struct tile_t
     {
         uint cost = 0;
-        uint id;
+        tileId_t id;
     };
 
     /**
@@ -63,8 +156,79 @@ public:
     tile_t
     operator() (uint column, uint row) const;
 
+    /**
+     * Carves a random, connected area out of an all-wall world. Uses a seed taken
+     * from std::random_device on a single thread.
+     */
     void generateMap (float percentCarved, uint maxTileCost);
 
+    /**
+     * Carves a random, connected area out of an all-wall world. The world is split into
+     * square cells that are each carved by their own drunkard's walk, spread over
+     * numThreads threads, and then joined up by corridors. The result only depends
+     * on the dimensions, percentCarved, maxTileCost and seed, never on numThreads, so
+     * a world can be regenerated bit for bit from its seed.
+     * @param percentCarved  Fraction of each cell's tiles that are carved open.
+     * @param maxTileCost    Open tiles get a cost within [1, maxTileCost].
+     * @param seed           Seed the walkers derive their random numbers from.
+     * @param numThreads     Number of threads carving cells at once.
+     */
+    void generateMap (float percentCarved, uint maxTileCost, uint64_t seed, uint numThreads = 1);
+
+    /**
+     * Changes the cost of a single tile, 0 turning it into a wall. A mapped or chunked
+     * world is first copied into memory. Neighbor masks are kept up to date, but
+     * component labels are dropped once a tile turns from open to wall or back since
+     * the components may have changed. Throws std::out_of_range for costs above 255,
+     * the most a tile can cost.
+     */
+    void setCost (uint x, uint y, uint cost);
+
+    /**
+     * Loads a world file of either format. Binary worlds are mapped read-only into
+     * memory and every tile is served straight from the mapping. Binary worlds whose
+     * cost plane does not fit in the memory budget are instead paged in chunk by chunk
+     * through a ChunkCache holding at most memoryBudget bytes, as are compressed
+     * worlds, whose chunks are decompressed on first use. Legacy worlds are
+     * parsed into memory just like operator>> does.
+     * @param fileName        The path of the world file.
+     * @param verifyChecksum  Whether or not to check the cost plane of a binary world
+     *                        against the checksum stored in its header.
+     * @param memoryBudget    Most bytes of a binary world's cost plane to keep in memory.
+     *                        By default half of the physical memory.
+     * @return True if the world was loaded, false if the file could not be opened
+     *         or is not a valid world.
+     */
+    bool loadFile (const std::string& fileName, bool verifyChecksum = false,
+                   size_t memoryBudget = AUTO_MEMORY_BUDGET);
+
+    /**
+     * Writes the world in the binary format: a fixed size header followed by the
+     * cost plane with one byte per tile in the world's layout.
+     * @param compress  Whether to store the cost plane as independently run-length
+     *                  encoded chunks behind a chunk index. Compressed worlds are much
+     *                  smaller on disk but are always loaded through a ChunkCache.
+     */
+    void writeBinary (std::ostream& stream, bool compress = false) const;
+
+    /**
+     * Computes a 64 bit FNV-1a hash over the cost plane of the world.
+     */
+    uint64_t computeChecksum () const;
+
+    bool isMapped () const;
+    bool isChunked () const;
+
+    /**
+     * Rearranges the tiles into a different layout. A mapped world is copied into
+     * memory in the process.
+     * @param layout      The order the tiles should be stored in.
+     * @param blockShift  Log2 of the block side for the BLOCKED and MORTON layouts.
+     */
+    void setLayout (Layout layout, uint blockShift = DEFAULT_BLOCK_SHIFT);
+    Layout getLayout () const;
+    uint getBlockShift () const;
+
     size_t getWidth () const;
     size_t getHeight () const;
     size_t getNumOpenTiles () const;
@@ -73,21 +237,140 @@ public:
     friend std::ostream& operator<< (std::ostream& stream, const World& world);
     friend std::istream& operator>> (std::istream& stream, World& world);
 
-    std::vector<tile_t>::iterator begin ();
-    std::vector<tile_t>::const_iterator begin () const;
-
-    std::vector<tile_t>::iterator end ();
-    std::vector<tile_t>::const_iterator end () const;
+    // Iterate over the raw cost plane in storage order. Blocked layouts pad the
+    // world out to whole blocks, the padding tiles have a cost of 0. Chunked
+    // worlds have no plane in memory and iterate over nothing.
+    const uint8_t* begin () const;
+    const uint8_t* end () const;
 private:
 
-    std::vector<tile_t> m_tiles;
+    bool loadBinary (const std::string& fileName, bool verifyChecksum, size_t memoryBudget);
+    void releaseFile ();
+    void makeWritable ();
+    Point carveCell (size_t cellX, size_t cellY, float percentCarved, uint64_t seed);
+    void carveCorridor (uint from, uint to, uint fixed, bool horizontal, std::minstd_rand0& gen);
+    void encodeCompressed (std::vector<uint8_t>& section) const;
+    bool mapLabels (int fd, uint64_t labelsOffset, uint64_t fileSize);
+    bool readChunkIndex (int fd, uint64_t dataOffset, uint64_t fileSize,
+                         size_t& chunkSize, std::vector<uint64_t>& chunkIndex);
+
+    uint8_t getCostAt (size_t offset) const;
+
+    // Where the cost of tile (x, y) lives in the cost plane
+    size_t getOffset (uint x, uint y) const;
+    size_t getPlaneSize () const;
+    size_t getChunkSize () const;
+    void setLayoutFields (Layout layout, uint blockShift);
+
+    // One byte of cost per tile. m_costs points either into m_costPlane or,
+    // when a binary world is mapped, into the mapping (m_costPlane is then empty).
+    // Chunked worlds leave m_costs null and page costs in through m_chunks.
+    std::vector<uint8_t> m_costPlane;
+    const uint8_t* m_costs;
+    std::unique_ptr<ChunkCache> m_chunks;
+
+    void* m_mapping;
+    size_t m_mappingSize;
+
+    // Component label of every tile by tile id. m_labels points either into
+    // m_labelPlane or into a mapping of the label section of the world file.
+    std::vector<uint32_t> m_labelPlane;
+    const uint32_t* m_labels;
+    void* m_labelMapping;
+    size_t m_labelMappingSize;
+    size_t m_numComponents;
+
     size_t m_width;
     size_t m_height;
 
     size_t m_openTiles;
     uint m_maxTileCost;
+
+    Layout m_layout;
+    uint m_blockShift;
+    uint m_blockMask;
+    size_t m_blocksPerRow;
+
+    // Row-major grid of (m_width + 2) x (m_height + 2) neighbor masks, the outer
+    // ring being the wall border. Empty until buildNeighborMasks is called.
+    std::vector<uint8_t> m_neighborMasks;
 };
 
+// The accessors below sit in the inner loop of every algorithm so they are
+// defined here to let the compiler inline them.
+
+inline tileId_t World::getID (uint x, uint y) const
+{
+    return (static_cast<tileId_t> (m_width) * y) + x;
+}
+
+inline size_t World::getOffset (uint x, uint y) const
+{
+    if (m_layout == ROW_MAJOR)
+    {
+        return (m_width * y) + x;
+    }
+
+    size_t block = (static_cast<size_t> (y >> m_blockShift) * m_blocksPerRow) + (x >> m_blockShift);
+    uint innerX = x & m_blockMask;
+    uint innerY = y & m_blockMask;
+    size_t inner;
+    if (m_layout == BLOCKED)
+    {
+        inner = (innerY << m_blockShift) | innerX;
+    }
+    else
+    {
+        // Spread the bits of each coordinate out and interleave them
+        // (x in the even bits, y in the odd bits)
+        uint spreadX = innerX, spreadY = innerY;
+        spreadX = (spreadX | (spreadX << 8)) & 0x00FF00FF;
+        spreadX = (spreadX | (spreadX << 4)) & 0x0F0F0F0F;
+        spreadX = (spreadX | (spreadX << 2)) & 0x33333333;
+        spreadX = (spreadX | (spreadX << 1)) & 0x55555555;
+        spreadY = (spreadY | (spreadY << 8)) & 0x00FF00FF;
+        spreadY = (spreadY | (spreadY << 4)) & 0x0F0F0F0F;
+        spreadY = (spreadY | (spreadY << 2)) & 0x33333333;
+        spreadY = (spreadY | (spreadY << 1)) & 0x55555555;
+        inner = spreadX | (spreadY << 1);
+    }
+    return (block << (2 * m_blockShift)) | inner;
+}
+
+inline uint8_t World::getCostAt (size_t offset) const
+{
+    if (m_costs != nullptr)
+    {
+        return m_costs[offset];
+    }
+    return m_chunks->get (offset);
+}
+
+inline uint World::getNeighborMask (uint x, uint y) const
+{
+    return m_neighborMasks[((y + 1) * (m_width + 2)) + x + 1] & (EAST | SOUTH | WEST | NORTH);
+}
+
+inline Point World::nextNeighbor (const Point& point, uint& mask)
+{
+    // Steps for each direction in bit order. Adding ~0u wraps around to a step back.
+    static const uint stepX[4] = {1, 0, ~0u, 0};
+    static const uint stepY[4] = {0, 1, 0, ~0u};
+    uint direction = __builtin_ctz (mask);
+    mask &= mask - 1;
+    return Point (point.x + stepX[direction], point.y + stepY[direction]);
+}
+
+inline uint32_t World::getComponent (uint x, uint y) const
+{
+    return m_labels[getID (x, y)];
+}
+
+inline World::tile_t World::operator() (uint column, uint row) const
+{
+    return {getCostAt (getOffset (column, row)), getID (column, row)};
+}
+
 } /* namespace pathFind */
 
 #endif /* WORLD_H_ */
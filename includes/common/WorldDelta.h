@@ -0,0 +1,75 @@
+/**
+ * File        : WorldDelta.h
+ * Description : A list of tile cost changes to apply to a world. Deltas are stored in
+ *               their own small binary file (.delta) so that a handful of changed
+ *               tiles never requires rewriting the whole world file.
+ */
+
+#ifndef WORLDDELTA_H_
+#define WORLDDELTA_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "common/World.h"
+
+namespace pathFind
+{
+
+class WorldDelta
+{
+public:
+
+    /**
+     * A single change, the tile with the given id gets the new cost (0 for a wall).
+     */
+    struct update_t
+    {
+        tileId_t id;
+        uint8_t cost;
+    };
+
+    WorldDelta ();
+
+    /**
+     * Constructs an empty delta for a world of the given dimensions.
+     */
+    WorldDelta (size_t width, size_t height);
+
+    void add (uint x, uint y, uint cost);
+
+    /**
+     * Reads a delta file.
+     * @return False if the file could not be opened or is not a valid delta.
+     */
+    bool loadFile (const std::string& fileName);
+
+    /**
+     * Writes the delta: a fixed size header holding the dimensions of the world it
+     * belongs to and the number of updates, followed by 9 bytes per update (the
+     * 64 bit tile id and the new cost).
+     */
+    void write (std::ostream& stream) const;
+
+    /**
+     * Applies every update to the world in order.
+     * @return False (and changes nothing) if the delta is for a world of a different size.
+     */
+    bool applyTo (World& world) const;
+
+    const std::vector<update_t>& getUpdates () const;
+    size_t getWidth () const;
+    size_t getHeight () const;
+
+private:
+
+    size_t m_width;
+    size_t m_height;
+    std::vector<update_t> m_updates;
+};
+
+} /* namespace pathFind */
+
+#endif /* WORLDDELTA_H_ */
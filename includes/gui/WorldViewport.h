@@ -83,7 +83,7 @@ protected:
     std::string m_currentAlgorithm;
 
     std::vector<SDL_Color> m_threadColors;
-    std::vector<std::unordered_map<uint, StatPoint>> m_stats;
+    std::vector<std::unordered_map<tileId_t, StatPoint>> m_stats;
     uint m_currentThread;
     uint m_maxProcessCount;
 
@@ -0,0 +1,13 @@
+/**
+ * File        : AlgorithmMain.cc
+ * Description : Entry point of every algorithm executable. The build names
+ *               the algorithm through ALG_NAME and the solver for it is
+ *               looked up in the registry.
+ */
+
+#include "algorithms/SolverRegistry.h"
+
+int main (int args, char* argv[])
+{
+    return pathFind::runSolverMain (ALG_NAME, args, argv);
+}
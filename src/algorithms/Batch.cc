@@ -0,0 +1,136 @@
+/*
+ * Batch.cc
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "algorithms/Batch.h"
+#include "algorithms/SolverRegistry.h"
+#include "algorithms/tools/WorkerPool.h"
+
+namespace pathFind
+{
+
+// Queries a worker takes at a time, so workers rarely contend for the next one
+const size_t QUERIES_PER_CLAIM = 16;
+// Bytes of results a worker gathers before it takes the lock on the output
+const size_t OUTPUT_FLUSH_SIZE = 1 << 16;
+
+batchResult_t solveBatch (const std::string& algName, const World& world, const std::string& worldFile,
+                          const std::vector<query_t>& queries, std::ostream& out,
+                          uint numWorkers, const solveOptions_t& options, bool writePaths)
+{
+    const SolverRegistry& registry = SolverRegistry::getDefault ();
+    if (!registry.contains (algName))
+    {
+        throw std::out_of_range ("No algorithm called " + algName);
+    }
+    // Checked here as well so it is not thrown on a worker
+    if (!world.hasNeighborMasks ())
+    {
+        throw std::invalid_argument ("The neighbor masks of the world have not been built");
+    }
+
+    batchResult_t result;
+    if (numWorkers == 0)
+    {
+        uint numCores = std::max (std::thread::hardware_concurrency (), 1u);
+        uint threadsPerSearch = registry.create (algName)->getThreadsPerSearch (options);
+        numWorkers = std::max (numCores / threadsPerSearch, 1u);
+    }
+    result.numWorkers = numWorkers;
+    result.latencies.resize (queries.size ());
+
+    std::atomic<size_t> nextQuery (0);
+    std::atomic<size_t> numSolved (0);
+    std::mutex outLock;
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    WorkerPool::getShared ().run (numWorkers, [&] (uint)
+    {
+        std::unique_ptr<Solver> solver = registry.create (algName);
+        solver->prepare (world, worldFile);
+        std::stringstream buffer;
+        size_t solved = 0;
+
+        auto flush = [&] ()
+        {
+            // Writing an empty buffer would set the failbit of out
+            if (buffer.tellp () == 0)
+            {
+                return;
+            }
+            std::lock_guard<std::mutex> guard (outLock);
+            out << buffer.rdbuf ();
+            buffer.str (std::string ());
+            buffer.clear ();
+        };
+
+        for (size_t first = nextQuery.fetch_add (QUERIES_PER_CLAIM); first < queries.size ();
+                first = nextQuery.fetch_add (QUERIES_PER_CLAIM))
+        {
+            size_t last = std::min (first + QUERIES_PER_CLAIM, queries.size ());
+            for (size_t i = first; i < last; ++i)
+            {
+                auto q1 = std::chrono::high_resolution_clock::now();
+                pathResult_t path = solver->solve (world, queries[i].start, queries[i].end, options);
+                auto q2 = std::chrono::high_resolution_clock::now();
+                result.latencies[i] = std::chrono::duration_cast<std::chrono::microseconds>(q2-q1).count();
+
+                buffer << i << " ";
+                if (!path.found)
+                {
+                    buffer << "none " << result.latencies[i] << "\n";
+                    continue;
+                }
+                ++solved;
+                buffer << path.totalCost << " " << result.latencies[i];
+                if (writePaths)
+                {
+                    for (auto ri = path.path.rbegin (); ri != path.path.rend (); ++ri)
+                    {
+                        buffer << " " << ri->x << " " << ri->y;
+                    }
+                }
+                buffer << "\n";
+            }
+            if (buffer.tellp () >= static_cast<std::streamoff> (OUTPUT_FLUSH_SIZE))
+            {
+                flush ();
+            }
+        }
+        flush ();
+        numSolved += solved;
+    });
+
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    result.numSolved = numSolved;
+    result.seconds = std::chrono::duration<double> (t2 - t1).count ();
+    return result;
+}
+
+uint getLatencyPercentile (const std::vector<uint>& latencies, double fraction)
+{
+    if (latencies.empty ())
+    {
+        return 0;
+    }
+    std::vector<uint> sorted (latencies);
+    // Nearest rank
+    size_t rank = static_cast<size_t> (std::ceil (fraction * sorted.size ()));
+    size_t index = std::min (std::max (rank, static_cast<size_t> (1)), sorted.size ()) - 1;
+    std::nth_element (sorted.begin (), sorted.begin () + index, sorted.end ());
+    return sorted[index];
+}
+
+} /* namespace pathFind */
@@ -0,0 +1,81 @@
+/*
+ * Solver.cc
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+#include "algorithms/Solver.h"
+
+namespace pathFind
+{
+
+Solver::Solver (const std::string& name)
+    : m_name (name)
+{
+}
+
+Solver::~Solver ()
+{
+}
+
+const std::string& Solver::getName () const
+{
+    return m_name;
+}
+
+bool Solver::isParallel () const
+{
+    return false;
+}
+
+uint Solver::getThreadsPerSearch (const solveOptions_t&) const
+{
+    return 1;
+}
+
+bool Solver::prepare (const World&, const std::string&)
+{
+    return true;
+}
+
+pathResult_t Solver::solve (const World& world, const Point& start, const Point& end,
+                            const solveOptions_t& options)
+{
+    // Searches only look at the masks to find the open neighbors of a tile
+    if (!world.hasNeighborMasks ())
+    {
+        throw std::invalid_argument ("The neighbor masks of the world have not been built");
+    }
+    // Worlds that carry component labels tell us up front if there is no path at all
+    if (!world.isReachable (start.x, start.y, end.x, end.y))
+    {
+        return pathResult_t ();
+    }
+    // A query that starts at its end enters no tiles at all
+    if (start.x == end.x && start.y == end.y)
+    {
+        pathResult_t result;
+        result.found = true;
+        result.path.push_back (end);
+        return result;
+    }
+    return search (world, start, end, options);
+}
+
+uint Solver::getNumThreads (const solveOptions_t& options, uint registeredThreads)
+{
+    if (options.numThreads != 0)
+    {
+        return options.numThreads;
+    }
+    if (registeredThreads != 0)
+    {
+        return registeredThreads;
+    }
+    // hardware_concurrency is 0 when it can't tell
+    return std::max (std::thread::hardware_concurrency (), 1u);
+}
+
+} /* namespace pathFind */
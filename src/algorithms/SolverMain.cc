@@ -0,0 +1,241 @@
+/*
+ * SolverMain.cc
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+
+#include "algorithms/Batch.h"
+#include "algorithms/SolverRegistry.h"
+#include "common/Queries.h"
+#include "common/Results.h"
+
+namespace pathFind
+{
+
+const std::string WORLD_DIR = "../worlds";
+const std::string WORLD_EXT = ".world";
+const std::string PATH_EXT = ".path";
+
+// Solves every query in the world's query file and writes one result file
+// for all of them along with the throughput and latencies
+static int runBatch (const std::string& algName, const std::string& resultName,
+                     const World& world, const std::string& worldFile, const std::string& worldName,
+                     const std::string& queriesName, uint numWorkers, const solveOptions_t& options,
+                     bool writePaths)
+{
+    std::vector<query_t> queries;
+    if (!readQueries (WORLD_DIR + "/" + queriesName + QUERIES_EXT, queries))
+    {
+        std::cout << "Could not read queries from " << queriesName << QUERIES_EXT << "." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::stringstream dirName;
+    dirName << RESULTS_DIR << "/" << worldName << "_batch_" << queriesName;
+    boost::filesystem::create_directory (dirName.str ());
+
+    std::ofstream resultFile (dirName.str () + "/" + resultName + RESULTS_EXT);
+    batchResult_t result = solveBatch (algName, world, worldFile, queries, resultFile, numWorkers, options, writePaths);
+    resultFile.close ();
+
+    std::stringstream summary;
+    summary << "queries: " << queries.size () << std::endl
+            << "solved: " << result.numSolved << std::endl
+            << "workers: " << result.numWorkers << std::endl
+            << "time: " << static_cast<uint> (result.seconds * 1000) << std::endl
+            << "queries per second: " << queries.size () / std::max (result.seconds, 1e-9) << std::endl
+            << "latency p50 (us): " << getLatencyPercentile (result.latencies, 0.5) << std::endl
+            << "latency p90 (us): " << getLatencyPercentile (result.latencies, 0.9) << std::endl
+            << "latency p99 (us): " << getLatencyPercentile (result.latencies, 0.99) << std::endl
+            << "latency p99.9 (us): " << getLatencyPercentile (result.latencies, 0.999) << std::endl
+            << "latency max (us): " << getLatencyPercentile (result.latencies, 1.0) << std::endl;
+
+    std::ofstream performanceFile (dirName.str () + "/" + resultName + PERFORMANCE_EXT);
+    performanceFile << summary.str ();
+    std::cout << summary.str ();
+
+    return EXIT_SUCCESS;
+}
+
+int runSolverMain (const std::string& algName, int args, char* argv[])
+{
+    std::unique_ptr<Solver> solver = SolverRegistry::getDefault ().create (algName);
+    if (!solver)
+    {
+        std::cout << "Unknown algorithm " << algName << "." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Take out the options first so the other parameters keep their
+    // positions wherever the options were given
+    solveOptions_t options;
+    std::string queriesName;
+    uint numWorkers = 0;
+    size_t memoryBudget = World::AUTO_MEMORY_BUDGET;
+    bool writePaths = false;
+    std::vector<char*> params;
+    for (int i = 0; i < args; ++i)
+    {
+        std::string param (argv[i]);
+        if (param == "--paths")
+        {
+            writePaths = true;
+            continue;
+        }
+        if (param != "--threads" && param != "--workers" && param != "--batch" && param != "--memory-budget")
+        {
+            params.push_back (argv[i]);
+            continue;
+        }
+        if (++i == args)
+        {
+            std::cout << param << " must be followed by a value" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (param == "--batch")
+        {
+            queriesName = argv[i];
+            continue;
+        }
+        if (param == "--memory-budget")
+        {
+            // Given in megabytes, worlds bigger than it are paged in from disk.
+            // Parsed signed since lexical_cast wraps negative numbers into
+            // huge unsigned ones.
+            long long megabytes = 0;
+            try
+            {
+                megabytes = boost::lexical_cast<long long> (argv[i]);
+            } catch (boost::bad_lexical_cast &e)
+            {
+                megabytes = 0;
+            }
+            if (megabytes <= 0 || static_cast<unsigned long long> (megabytes) > (SIZE_MAX >> 20))
+            {
+                std::cout << param << " must be followed by a positive number of megabytes up to "
+                          << (SIZE_MAX >> 20) << std::endl;
+                return EXIT_FAILURE;
+            }
+            memoryBudget = static_cast<size_t> (megabytes) << 20;
+            continue;
+        }
+        try
+        {
+            uint value = boost::lexical_cast<uint> (argv[i]);
+            (param == "--threads" ? options.numThreads : numWorkers) = value;
+        } catch (boost::bad_lexical_cast &e)
+        {
+            std::cout << param << " must be followed by a number" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    args = params.size ();
+    argv = params.data ();
+
+    // Program should be started with 5 command line parameters (or 1)
+    // that specifies the name of the world file to read from and then optionallys
+    // the start x, start y, end x, and end y
+    if ((args != 6 || !queriesName.empty ()) && args != 2)
+    {
+        std::cout << "Incorrect inputs. Usage: <filename> (start x) (start y) (end x) (end y) "
+                  << "(--threads <number of threads>) (--memory-budget <megabytes>)" << std::endl
+                  << "or: <filename> --batch <name of query file> (--workers <number of workers>) "
+                  << "(--threads <number of threads>) (--memory-budget <megabytes>) (--paths)" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Runs with a thread count given keep their results apart, e.g. parFringe
+    // with --threads 4 writes parFringe_4.res
+    std::string resultName = algName;
+    if (options.numThreads != 0 && solver->isParallel ())
+    {
+        resultName += "_" + std::to_string (options.numThreads);
+    }
+
+    // Parse the world file
+    std::stringstream filename;
+    filename << WORLD_DIR << "/" << argv[1] << WORLD_EXT;
+
+    World world;
+    if (!world.loadFile (filename.str (), false, memoryBudget))
+    {
+        std::cout << "World file doesn't exist." << std::endl;
+        return EXIT_FAILURE;
+    }
+    world.buildNeighborMasks ();
+
+    if (!queriesName.empty ())
+    {
+        return runBatch (algName, resultName, world, filename.str (), argv[1], queriesName, numWorkers,
+                         options, writePaths);
+    }
+
+    if (!solver->prepare (world, filename.str ()))
+    {
+        std::cout << "Could not save the data " << algName << " prepared for the world, "
+                  << "it will be prepared again next time." << std::endl;
+    }
+
+    uint startX, startY, endX, endY;
+
+    if (args == 6)
+    {
+        // Parse the start and end points
+        try
+        {
+            startX = boost::lexical_cast<uint> (argv[2]);
+            startY = boost::lexical_cast<uint> (argv[3]);
+            endX = boost::lexical_cast<uint> (argv[4]);
+            endY = boost::lexical_cast<uint> (argv[5]);
+        } catch (boost::bad_lexical_cast &e)
+        {
+            std::cout << "Start and end points failed to convert to numeric types" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        std::stringstream pathFilename;
+        pathFilename << WORLD_DIR << "/" << argv[1] << PATH_EXT;
+        std::ifstream pathIn (pathFilename.str ());
+        if (!pathIn)
+        {
+            std::string pathCommand = "./pathGen " + std::string (argv[1]);
+            system (pathCommand.c_str());
+            pathIn.close ();
+            pathIn.open (pathFilename.str ());
+            if (!pathIn)
+            {
+                std::cout << "Could not construct path." << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        pathIn >> startX >> startY >> endX >> endY;
+
+    }
+
+    pathResult_t result = solver->solve (world, {startX, startY}, {endX, endY}, options);
+    if (!result.found)
+    {
+        std::cout << "No path exists between the start and end points." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    #ifdef GEN_STATS
+        writeResults (result.path, result.stats, argv[1], resultName, result.ms, result.totalCost);
+    #else
+        writeResults (result.path, argv[1], resultName, result.ms, result.totalCost);
+    #endif
+
+    return EXIT_SUCCESS;
+}
+
+} /* namespace pathFind */
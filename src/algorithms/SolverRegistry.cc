@@ -0,0 +1,94 @@
+/*
+ * SolverRegistry.cc
+ */
+
+#include <stdexcept>
+
+#include "algorithms/SolverRegistry.h"
+
+namespace pathFind
+{
+
+// Each algorithm adds its solvers (and their variants) from its own source file
+void registerDijkstraSolvers (SolverRegistry& registry);
+void registerAStarSolvers (SolverRegistry& registry);
+void registerLPAStarSolvers (SolverRegistry& registry);
+void registerBidirectionalSolvers (SolverRegistry& registry);
+void registerParBidirectionalSolvers (SolverRegistry& registry);
+void registerParAStarSolvers (SolverRegistry& registry);
+void registerFringeSolvers (SolverRegistry& registry);
+void registerParFringeSolvers (SolverRegistry& registry);
+void registerParDivideSolvers (SolverRegistry& registry);
+void registerParDivideUnsmoothSolvers (SolverRegistry& registry);
+void registerJPSSolvers (SolverRegistry& registry);
+void registerHPAStarSolvers (SolverRegistry& registry);
+
+SolverRegistry::SolverRegistry ()
+{
+}
+
+const SolverRegistry& SolverRegistry::getDefault ()
+{
+    static const SolverRegistry registry = []
+    {
+        SolverRegistry r;
+        registerDijkstraSolvers (r);
+        registerAStarSolvers (r);
+        registerLPAStarSolvers (r);
+        registerBidirectionalSolvers (r);
+        registerParBidirectionalSolvers (r);
+        registerParAStarSolvers (r);
+        registerFringeSolvers (r);
+        registerParFringeSolvers (r);
+        registerParDivideSolvers (r);
+        registerParDivideUnsmoothSolvers (r);
+        registerJPSSolvers (r);
+        registerHPAStarSolvers (r);
+        return r;
+    } ();
+    return registry;
+}
+
+void SolverRegistry::add (const std::string& name, factory_t factory)
+{
+    m_factories[name] = factory;
+}
+
+bool SolverRegistry::contains (const std::string& name) const
+{
+    return m_factories.find (name) != m_factories.end ();
+}
+
+std::unique_ptr<Solver> SolverRegistry::create (const std::string& name) const
+{
+    auto factory = m_factories.find (name);
+    if (factory == m_factories.end ())
+    {
+        return std::unique_ptr<Solver> ();
+    }
+    return factory->second ();
+}
+
+std::vector<std::string> SolverRegistry::getNames () const
+{
+    std::vector<std::string> names;
+    names.reserve (m_factories.size ());
+    for (const auto& factory : m_factories)
+    {
+        names.push_back (factory.first);
+    }
+    return names;
+}
+
+pathResult_t solve (const std::string& algName, const World& world,
+                    const Point& start, const Point& end, const solveOptions_t& options)
+{
+    std::unique_ptr<Solver> solver = SolverRegistry::getDefault ().create (algName);
+    if (!solver)
+    {
+        throw std::out_of_range ("No algorithm called " + algName);
+    }
+    return solver->solve (world, start, end, options);
+}
+
+} /* namespace pathFind */
@@ -1,111 +1,88 @@
 /**
  * File        : AStar.cc
- * Description : Implementation of A* algorithm using a specified "world"
- *               from the worlds folder.
+ * Description : Implementation of A* algorithm as a solver for the
+ *               SolverRegistry.
  */
 
-#include <cstdlib>
-#include <iostream>
-#include <fstream>
-#include <sstream>
+#include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
-#include <cmath>
 #include <chrono>
 
-#include <boost/lexical_cast.hpp>
-
 #include "algorithms/tools/PathTile.h"
+#include "algorithms/tools/Heuristics.h"
 #include "algorithms/tools/PriorityQueue.h"
-#include "common/Results.h"
-
-using namespace pathFind;
-
-const std::string WORLD_DIR = "../worlds";
-const std::string WORLD_EXT = ".world";
-const std::string PATH_EXT = ".path";
-
-const std::string ALG_NAME = "aStar";
+#include "algorithms/tools/DaryHeap.h"
+#include "algorithms/tools/BucketQueue.h"
+#include "algorithms/tools/RadixHeap.h"
+#include "algorithms/tools/LazyQueue.h"
+#include "algorithms/tools/FrontierQueue.h"
+#include "algorithms/tools/SearchState.h"
+#include "algorithms/tools/CompactSearchState.h"
+#include "algorithms/tools/SearchWorkspace.h"
+#include "algorithms/SolverRegistry.h"
+
+namespace pathFind
+{
 
-int main (int args, char* argv[])
+// The open list is a parameter so the binary heap can be swapped for the
+// other open lists and compared on the same searches. The compact variant
+// pairs a FrontierQueue with a CompactSearchState, keeping only parent
+// directions and closed bits per tile and best costs for the frontier, for
+// worlds too big for the arrays of the SearchState.
+template <class OpenList, class State = SearchState>
+class AStarSolver : public Solver
 {
-    // Program should be started with 5 command line parameters (or 1)
-    // that specifies the name of the world file to read from and then optionallys
-    // the start x, start y, end x, and end y
-    if (args != 6  && args != 2)
-    {
-        std::cout << "Incorrect inputs. Usage: <filename> (start x) (start y) (end x) (end y)" << std::endl;
-        return EXIT_FAILURE;
-    }
+public:
 
-    // Parse the world file
-    std::stringstream filename;
-    filename << WORLD_DIR << "/" << argv[1] << WORLD_EXT;
+    explicit AStarSolver (const std::string& name);
 
-    std::ifstream worldFile (filename.str (),
-            std::ifstream::in | std::ifstream::binary);
+protected:
 
-    if (!worldFile)
-    {
-        std::cout << "World file doesn't exist." << std::endl;
-        return EXIT_FAILURE;
-    }
-    pathFind::World world;
+    pathResult_t search (const World& world, const Point& start, const Point& end,
+                         const solveOptions_t& options) override;
 
-    worldFile >> world;
-    worldFile.close ();
+private:
 
-    uint startX, startY, endX, endY;
+    // Reset for every query, only built again for another world or when a
+    // query wants the tiles kept another way (see SearchWorkspace::isFor)
+    std::unique_ptr<SearchWorkspace<OpenList, State>> m_workspace;
+};
 
-    if (args == 6)
-    {
-        // Parse the start and end points
-        try
-        {
-            startX = boost::lexical_cast<uint> (argv[2]);
-            startY = boost::lexical_cast<uint> (argv[3]);
-            endX = boost::lexical_cast<uint> (argv[4]);
-            endY = boost::lexical_cast<uint> (argv[5]);
-        } catch (boost::bad_lexical_cast &e)
-        {
-            std::cout << "Start and end points failed to convert to numeric types" << std::endl;
-            return EXIT_FAILURE;
-        }
-    }
-    else
-    {
-        std::stringstream pathFilename;
-        pathFilename << WORLD_DIR << "/" << argv[1] << PATH_EXT;
-        std::ifstream pathIn (pathFilename.str ());
-        if (!pathIn)
-        {
-            std::string pathCommand = "./pathGen " + std::string (argv[1]);
-            system (pathCommand.c_str());
-            pathIn.close ();
-            pathIn.open (pathFilename.str ());
-            if (!pathIn)
-            {
-                std::cout << "Could not construct path." << std::endl;
-                return EXIT_FAILURE;
-            }
-        }
-        pathIn >> startX >> startY >> endX >> endY;
+template <class OpenList, class State>
+AStarSolver<OpenList, State>::AStarSolver (const std::string& name)
+    : Solver (name)
+{
+}
 
-    }
+template <class OpenList, class State>
+pathResult_t AStarSolver<OpenList, State>::search (const World& world, const Point& start,
+                                                   const Point& end, const solveOptions_t&)
+{
+    uint startX = start.x, startY = start.y, endX = end.x, endY = end.y;
 
+    pathResult_t result;
     #ifdef GEN_STATS
-        std::vector<std::unordered_map<uint, StatPoint>> stats (1);
+        std::vector<std::unordered_map<tileId_t, StatPoint>>& stats = result.stats;
+        stats.resize (1);
     #endif
 
     auto t1 = std::chrono::high_resolution_clock::now();
 
     // Priority Queue with A* heuristic function added
-    PriorityQueue openTiles (world.getWidth (), world.getHeight (),
-        [endX, endY] (uint x, uint y)
-        {
-            return  (x < endX ? endX - x : x - endX) +
-                    (y < endY ? endY - y : y - endY);
-        });
+    size_t expectedTiles = SearchState::estimateTiles ({startX, startY}, {endX, endY}, true);
+    if (!m_workspace || !m_workspace->isFor (world, expectedTiles))
+    {
+        m_workspace.reset (new SearchWorkspace<OpenList, State> (world, ManhattanHeuristic (endX, endY),
+                                                                 expectedTiles));
+    }
+    else
+    {
+        m_workspace->reset (ManhattanHeuristic (endX, endY));
+    }
+    OpenList& openTiles = m_workspace->getOpenList ();
+    State& searchState = m_workspace->getSearchState ();
 
     // A* algorithm
     openTiles.push (world (startX, startY), {startX, startY}, 0);
@@ -113,85 +90,25 @@ int main (int args, char* argv[])
         stats[0][world (startX, startY).id] = StatPoint {startX, startY};
     #endif
 
-    std::unordered_map<uint, PathTile> expandedTiles;
-    PathTile tile = openTiles.top();
-    while (tile.xy ().x != endX || tile.xy ().y != endY)
+    PathTile tile;
+    bool found = false;
+    while (!openTiles.empty ())
     {
-        openTiles.pop ();
-        expandedTiles[tile.getTile ().id] = tile;
-        // Check each neighbor
-        Point adjPoint {tile.xy ().x + 1, tile.xy ().y}; // east
-        if (adjPoint.x < world.getWidth() && adjPoint.y < world.getHeight ())
-        {
-            World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
-            if (worldTile.cost != 0 &&
-                expandedTiles.find (worldTile.id) == expandedTiles.end ())
-            {
-                openTiles.tryUpdateBestCost (worldTile, adjPoint, tile);
-                #ifdef GEN_STATS
-                    auto statIter = stats[0].find (worldTile.id);
-                    if (statIter == stats[0].end ())
-                    {
-                        stats[0][worldTile.id] = StatPoint {adjPoint.x, adjPoint.y};
-                    }
-                    else
-                    {
-                        statIter->second.processCount++;
-                    }
-                #endif
-            }
-        }
-
-        adjPoint = {tile.xy ().x, tile.xy ().y + 1}; // south
-        if (adjPoint.x < world.getWidth() && adjPoint.y < world.getHeight ())
-        {
-            World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
-            if (worldTile.cost != 0 &&
-                expandedTiles.find (worldTile.id) == expandedTiles.end ())
-            {
-                openTiles.tryUpdateBestCost (worldTile, adjPoint, tile);
-                #ifdef GEN_STATS
-                    auto statIter = stats[0].find (worldTile.id);
-                    if (statIter == stats[0].end ())
-                    {
-                        stats[0][worldTile.id] = StatPoint {adjPoint.x, adjPoint.y};
-                    }
-                    else
-                    {
-                        statIter->second.processCount++;
-                    }
-                #endif
-            }
-        }
-
-        adjPoint = {tile.xy ().x - 1, tile.xy ().y}; // west
-        if (adjPoint.x < world.getWidth() && adjPoint.y < world.getHeight ())
+        tile = openTiles.top ();
+        if (tile.xy ().x == endX && tile.xy ().y == endY)
         {
-            World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
-            if (worldTile.cost != 0 &&
-                expandedTiles.find (worldTile.id) == expandedTiles.end ())
-            {
-                openTiles.tryUpdateBestCost (worldTile, adjPoint, tile);
-                #ifdef GEN_STATS
-                    auto statIter = stats[0].find (worldTile.id);
-                    if (statIter == stats[0].end ())
-                    {
-                        stats[0][worldTile.id] = StatPoint {adjPoint.x, adjPoint.y};
-                    }
-                    else
-                    {
-                        statIter->second.processCount++;
-                    }
-                #endif
-            }
+            found = true;
+            break;
         }
-
-        adjPoint = {tile.xy ().x, tile.xy ().y - 1}; // north
-        if (adjPoint.x < world.getWidth() && adjPoint.y < world.getHeight ())
+        openTiles.pop ();
+        searchState.close (world, tile);
+        // Check each open neighbor
+        uint neighbors = world.getNeighborMask (tile.xy ().x, tile.xy ().y);
+        while (neighbors != 0)
         {
+            Point adjPoint = World::nextNeighbor (tile.xy (), neighbors);
             World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
-            if (worldTile.cost != 0 &&
-                expandedTiles.find (worldTile.id) == expandedTiles.end ())
+            if (!searchState.isClosed (worldTile.id))
             {
                 openTiles.tryUpdateBestCost (worldTile, adjPoint, tile);
                 #ifdef GEN_STATS
@@ -207,29 +124,36 @@ int main (int args, char* argv[])
                 #endif
             }
         }
-
-        tile = openTiles.top ();
     }
 
     auto t2 = std::chrono::high_resolution_clock::now();
+    result.ms = std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count();
+    if (!found)
+    {
+        return result;
+    }
 
     // Parse results into a stack
     uint totalCost = tile.getBestCost() - tile.getTile().cost;
+    searchState.close (world, tile);
     std::vector<Point> finalPath;
-    while (tile.xy ().x != startX || tile.xy ().y != startY)
-    {
-        finalPath.emplace_back(tile.xy ());
-        tile = expandedTiles[(tile.bestTile ().y * world.getWidth()) + tile.bestTile ().x];
-    }
-    finalPath.emplace_back(tile.xy ());
+    searchState.getPath (tile.getTile ().id, finalPath);
 
-    #ifdef GEN_STATS
-        writeResults (finalPath, stats, argv[1], ALG_NAME,
-                std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count(), totalCost);
-    #else
-        writeResults (finalPath, argv[1], ALG_NAME,
-                std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count(), totalCost);
-    #endif
+    result.found = true;
+    result.path = std::move (finalPath);
+    result.totalCost = totalCost;
+    return result;
+}
 
-    return EXIT_SUCCESS;
+void registerAStarSolvers (SolverRegistry& registry)
+{
+    registry.emplace<AStarSolver<PriorityQueue<ManhattanHeuristic>>> ("aStar");
+    registry.emplace<AStarSolver<DaryHeap<4, ManhattanHeuristic>>> ("aStar_4ary");
+    registry.emplace<AStarSolver<DaryHeap<8, ManhattanHeuristic>>> ("aStar_8ary");
+    registry.emplace<AStarSolver<BucketQueue<ManhattanHeuristic>>> ("aStar_bucket");
+    registry.emplace<AStarSolver<RadixHeap<ManhattanHeuristic>>> ("aStar_radix");
+    registry.emplace<AStarSolver<LazyQueue<ManhattanHeuristic>>> ("aStar_lazy");
+    registry.emplace<AStarSolver<FrontierQueue<ManhattanHeuristic>, CompactSearchState>> ("aStar_compact");
 }
+
+} /* namespace pathFind */
@@ -1,115 +1,59 @@
 /**
  * File        : Bidirectional.cc
- * Description : Implementation of the bidirectional A* algorithm using
- *               a specified "world" from the worlds folder.
+ * Description : Implementation of the bidirectional A* algorithm as a solver
+ *               for the SolverRegistry.
  */
 
-#include <iostream>
-#include <fstream>
-#include <sstream>
 #include <unordered_map>
+#include <utility>
 #include <vector>
-#include <cmath>
 #include <chrono>
 
-#include <boost/lexical_cast.hpp>
-
 #include "algorithms/tools/PathTile.h"
+#include "algorithms/tools/Heuristics.h"
 #include "algorithms/tools/PriorityQueue.h"
-#include "common/Results.h"
-
-using namespace pathFind;
-
-const std::string WORLD_DIR = "../worlds";
-const std::string WORLD_EXT = ".world";
-const std::string PATH_EXT = ".path";
+#include "algorithms/tools/SearchState.h"
+#include "algorithms/SolverRegistry.h"
 
-const std::string ALG_NAME = "bidir";
-
-int main (int args, char* argv[])
+namespace pathFind
 {
-    // Program should be started with 5 command line parameters (or 1)
-    // that specifies the name of the world file to read from and then optionallys
-    // the start x, start y, end x, and end y
-    if (args != 6  && args != 2)
-    {
-        std::cout << "Incorrect inputs. Usage: <filename> (start x) (start y) (end x) (end y)" << std::endl;
-        return EXIT_FAILURE;
-    }
 
-    // Parse the world file
-    std::stringstream filename;
-    filename << WORLD_DIR << "/" << argv[1] << WORLD_EXT;
+class BidirectionalSolver : public Solver
+{
+public:
 
-    std::ifstream worldFile (filename.str (),
-            std::ifstream::in | std::ifstream::binary);
+    explicit BidirectionalSolver (const std::string& name);
 
-    if (!worldFile)
-    {
-        std::cout << "World file doesn't exist." << std::endl;
-        return EXIT_FAILURE;
-    }
-    pathFind::World world;
+protected:
 
-    worldFile >> world;
-    worldFile.close ();
+    pathResult_t search (const World& world, const Point& start, const Point& end,
+                         const solveOptions_t& options) override;
+};
 
-    uint startX, startY, endX, endY;
-
-    if (args == 6)
-    {
-        // Parse the start and end points
-        try
-        {
-            startX = boost::lexical_cast<uint> (argv[2]);
-            startY = boost::lexical_cast<uint> (argv[3]);
-            endX = boost::lexical_cast<uint> (argv[4]);
-            endY = boost::lexical_cast<uint> (argv[5]);
-        } catch (boost::bad_lexical_cast &e)
-        {
-            std::cout << "Start and end points failed to convert to numeric types" << std::endl;
-            return EXIT_FAILURE;
-        }
-    }
-    else
-    {
-        std::stringstream pathFilename;
-        pathFilename << WORLD_DIR << "/" << argv[1] << PATH_EXT;
-        std::ifstream pathIn (pathFilename.str ());
-        if (!pathIn)
-        {
-            std::string pathCommand = "./pathGen " + std::string (argv[1]);
-            system (pathCommand.c_str());
-            pathIn.close ();
-            pathIn.open (pathFilename.str ());
-            if (!pathIn)
-            {
-                std::cout << "Could not construct path." << std::endl;
-                return EXIT_FAILURE;
-            }
-        }
-        pathIn >> startX >> startY >> endX >> endY;
+BidirectionalSolver::BidirectionalSolver (const std::string& name)
+    : Solver (name)
+{
+}
 
-    }
+pathResult_t BidirectionalSolver::search (const World& world, const Point& start,
+                                          const Point& end, const solveOptions_t&)
+{
+    uint startX = start.x, startY = start.y, endX = end.x, endY = end.y;
 
+    pathResult_t result;
     #ifdef GEN_STATS
-        std::vector<std::unordered_map<uint, StatPoint>> stats (1);
+        std::vector<std::unordered_map<tileId_t, StatPoint>>& stats = result.stats;
+        stats.resize (1);
     #endif
 
     auto t1 = std::chrono::high_resolution_clock::now();
 
     // Priority Queue with A* heuristic function added
-    PriorityQueue forwardOpenTiles (world.getWidth (), world.getHeight (), [endX, endY] (uint x, uint y)
-        {
-            return  (x < endX ? endX - x : x - endX) +
-                    (y < endY ? endY - y : y - endY);
-        });
+    PriorityQueue<ManhattanHeuristic> forwardOpenTiles (world.getWidth (), world.getHeight (),
+                                                        ManhattanHeuristic (endX, endY));
 
-    PriorityQueue reverseOpenTiles (world.getWidth (), world.getHeight (), [startX, startY] (uint x, uint y)
-        {
-            return  (x < startX ? startX - x : x - startX) +
-                    (y < startY ? startY - y : y - startY);
-        });
+    PriorityQueue<ManhattanHeuristic> reverseOpenTiles (world.getWidth (), world.getHeight (),
+                                                        ManhattanHeuristic (startX, startY));
 
     // A* algorithm
     forwardOpenTiles.push (world (startX, startY), {startX, startY}, 0);
@@ -118,24 +62,30 @@ int main (int args, char* argv[])
         stats[0][world (startX, startY).id] = StatPoint {startX, startY};
         stats[0][world (endX, endY).id] = StatPoint {endX, endY};
     #endif
-    std::unordered_map<uint, PathTile> fExpandedTiles;
-    std::unordered_map<uint, PathTile> rExpandedTiles;
+    SearchState fSearchState (world);
+    SearchState rSearchState (world);
     PathTile fTile = forwardOpenTiles.top ();
     PathTile rTile = reverseOpenTiles.top ();
+    // Set when either search runs out of tiles before they meet
+    bool exhausted = false;
     while ((fTile.xy ().x != endX || fTile.xy ().y != endY) &&
             (rTile.xy ().x != startX || rTile.xy ().y != startY))
     {
         // forward search
+        if (forwardOpenTiles.empty ())
+        {
+            exhausted = true;
+            break;
+        }
         fTile = forwardOpenTiles.top ();
-        auto overlapTile = rExpandedTiles.find(fTile.getTile ().id);
-        if (overlapTile != rExpandedTiles.end ())
+        if (rSearchState.isClosed (fTile.getTile ().id))
         {
             // Best path found
-            rTile = overlapTile->second;
+            rTile = rSearchState.getPathTile (world, fTile.getTile ().id);
             break;
         }
         forwardOpenTiles.pop ();
-        fExpandedTiles[fTile.getTile ().id] = fTile;
+        fSearchState.close (world, fTile);
 
         // Check each neighbor
         Point adjPoint {fTile.xy ().x + 1, fTile.xy ().y}; // east
@@ -143,7 +93,7 @@ int main (int args, char* argv[])
         {
             World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
             if (worldTile.cost != 0 &&
-                fExpandedTiles.find (worldTile.id) == fExpandedTiles.end ())
+                !fSearchState.isClosed (worldTile.id))
             {
                 forwardOpenTiles.tryUpdateBestCost (worldTile, adjPoint, fTile);
                 #ifdef GEN_STATS
@@ -165,7 +115,7 @@ int main (int args, char* argv[])
         {
             World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
             if (worldTile.cost != 0 &&
-                fExpandedTiles.find (worldTile.id) == fExpandedTiles.end ())
+                !fSearchState.isClosed (worldTile.id))
             {
                 forwardOpenTiles.tryUpdateBestCost (worldTile, adjPoint, fTile);
                 #ifdef GEN_STATS
@@ -187,7 +137,7 @@ int main (int args, char* argv[])
         {
             World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
             if (worldTile.cost != 0 &&
-                fExpandedTiles.find (worldTile.id) == fExpandedTiles.end ())
+                !fSearchState.isClosed (worldTile.id))
             {
                 forwardOpenTiles.tryUpdateBestCost (worldTile, adjPoint, fTile);
                 #ifdef GEN_STATS
@@ -209,7 +159,7 @@ int main (int args, char* argv[])
         {
             World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
             if (worldTile.cost != 0 &&
-                fExpandedTiles.find (worldTile.id) == fExpandedTiles.end ())
+                !fSearchState.isClosed (worldTile.id))
             {
                 forwardOpenTiles.tryUpdateBestCost (worldTile, adjPoint, fTile);
                 #ifdef GEN_STATS
@@ -227,16 +177,20 @@ int main (int args, char* argv[])
         }
 
         // reverse search
+        if (reverseOpenTiles.empty ())
+        {
+            exhausted = true;
+            break;
+        }
         rTile = reverseOpenTiles.top ();
-        overlapTile = rExpandedTiles.find(rTile.getTile ().id);
-        if (overlapTile != rExpandedTiles.end ())
+        if (fSearchState.isClosed (rTile.getTile ().id))
         {
-            fTile = overlapTile->second;
+            fTile = fSearchState.getPathTile (world, rTile.getTile ().id);
             // Best path found
             break;
         }
         reverseOpenTiles.pop ();
-        rExpandedTiles [rTile.getTile ().id] = rTile;
+        rSearchState.close (world, rTile);
 
         // Check each neighbor
         adjPoint = {rTile.xy ().x + 1, rTile.xy ().y}; // east
@@ -244,7 +198,7 @@ int main (int args, char* argv[])
         {
             World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
             if (worldTile.cost != 0 &&
-                rExpandedTiles.find (worldTile.id) == rExpandedTiles.end ())
+                !rSearchState.isClosed (worldTile.id))
             {
                 reverseOpenTiles.tryUpdateBestCost (worldTile, adjPoint, rTile);
                 #ifdef GEN_STATS
@@ -266,7 +220,7 @@ int main (int args, char* argv[])
         {
             World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
             if (worldTile.cost != 0 &&
-                rExpandedTiles.find (worldTile.id) == rExpandedTiles.end ())
+                !rSearchState.isClosed (worldTile.id))
             {
                 reverseOpenTiles.tryUpdateBestCost (worldTile, adjPoint, rTile);
                 #ifdef GEN_STATS
@@ -288,7 +242,7 @@ int main (int args, char* argv[])
         {
             World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
             if (worldTile.cost != 0 &&
-                rExpandedTiles.find (worldTile.id) == rExpandedTiles.end ())
+                !rSearchState.isClosed (worldTile.id))
             {
                 reverseOpenTiles.tryUpdateBestCost (worldTile, adjPoint, rTile);
                 #ifdef GEN_STATS
@@ -310,7 +264,7 @@ int main (int args, char* argv[])
         {
             World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
             if (worldTile.cost != 0 &&
-                rExpandedTiles.find (worldTile.id) == rExpandedTiles.end ())
+                !rSearchState.isClosed (worldTile.id))
             {
                 reverseOpenTiles.tryUpdateBestCost (worldTile, adjPoint, rTile);
                 #ifdef GEN_STATS
@@ -328,6 +282,21 @@ int main (int args, char* argv[])
         }
     }
     auto t2 = std::chrono::high_resolution_clock::now();
+    result.ms = std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count();
+    if (exhausted)
+    {
+        return result;
+    }
+
+    // A search that reached the far end on its own met the other one there
+    if (fTile.xy ().x == endX && fTile.xy ().y == endY)
+    {
+        rTile = rSearchState.getPathTile (world, fTile.getTile ().id);
+    }
+    else if (rTile.xy ().x == startX && rTile.xy ().y == startY)
+    {
+        fTile = fSearchState.getPathTile (world, rTile.getTile ().id);
+    }
 
     // Parse reverse results
     uint totalCost = 0;
@@ -336,26 +305,28 @@ int main (int args, char* argv[])
     {
         totalCost += rTile.getTile().cost;
         reversePath.emplace_back (rTile.xy ());
-        rTile = rExpandedTiles[(rTile.bestTile ().y * world.getWidth ()) + rTile.bestTile ().x];
+        rTile = rSearchState.getPathTile (world, world.getID (rTile.bestTile ().x, rTile.bestTile ().y));
     }
     reversePath.emplace_back (rTile.xy ());
 
     std::vector<Point> finalPath (reversePath.rbegin (), reversePath.rend ());
     while (fTile.xy ().x != startX || fTile.xy ().y != startY)
     {
-        fTile = fExpandedTiles[(fTile.bestTile ().y * world.getWidth()) + fTile.bestTile ().x];
+        fTile = fSearchState.getPathTile (world, world.getID (fTile.bestTile ().x, fTile.bestTile ().y));
         totalCost += fTile.getTile().cost;
         finalPath.emplace_back(fTile.xy ());
     }
     totalCost -= fTile.getTile().cost;
 
-    #ifdef GEN_STATS
-        writeResults (finalPath, stats, argv[1], ALG_NAME,
-                std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count(), totalCost);
-    #else
-        writeResults (finalPath, argv[1], ALG_NAME,
-                std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count(), totalCost);
-    #endif
+    result.found = true;
+    result.path = std::move (finalPath);
+    result.totalCost = totalCost;
+    return result;
+}
 
-    return EXIT_SUCCESS;
+void registerBidirectionalSolvers (SolverRegistry& registry)
+{
+    registry.emplace<BidirectionalSolver> ("bidir");
 }
+
+} /* namespace pathFind */
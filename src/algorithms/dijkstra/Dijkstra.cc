@@ -1,103 +1,81 @@
 /**
  * File        : Dijkstra.cc
- * Description : Implementation of djikstra's algorithm using a specified "world"
- *               from the worlds folder.
+ * Description : Implementation of djikstra's algorithm as a solver for the
+ *               SolverRegistry.
  */
 
-#include <iostream>
-#include <fstream>
-#include <sstream>
+#include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <chrono>
 
-#include <boost/lexical_cast.hpp>
-
 #include "algorithms/tools/PathTile.h"
+#include "algorithms/tools/Heuristics.h"
 #include "algorithms/tools/PriorityQueue.h"
-#include "common/Results.h"
-
-using namespace pathFind;
-
-const std::string WORLD_DIR = "../worlds";
-const std::string WORLD_EXT = ".world";
-const std::string PATH_EXT = ".path";
-
-const std::string ALG_NAME = "dijkstra";
+#include "algorithms/tools/DaryHeap.h"
+#include "algorithms/tools/BucketQueue.h"
+#include "algorithms/tools/RadixHeap.h"
+#include "algorithms/tools/LazyQueue.h"
+#include "algorithms/tools/SearchState.h"
+#include "algorithms/tools/SearchWorkspace.h"
+#include "algorithms/SolverRegistry.h"
+
+namespace pathFind
+{
 
-int main (int args, char* argv[])
+// The open list is a parameter so the binary heap can be swapped for the
+// other open lists and compared on the same searches
+template <class OpenList>
+class DijkstraSolver : public Solver
 {
-    // Program should be started with 5 command line parameters (or 1)
-    // that specifies the name of the world file to read from and then optionallys
-    // the start x, start y, end x, and end y
-    if (args != 6  && args != 2)
-    {
-        std::cout << "Incorrect inputs. Usage: <filename> (start x) (start y) (end x) (end y)" << std::endl;
-        return EXIT_FAILURE;
-    }
+public:
 
-    // Parse the world file
-    std::stringstream filename;
-    filename << WORLD_DIR << "/" << argv[1] << WORLD_EXT;
+    explicit DijkstraSolver (const std::string& name);
 
-    std::ifstream worldFile (filename.str (),
-            std::ifstream::in | std::ifstream::binary);
+protected:
 
-    if (!worldFile)
-    {
-        std::cout << "World file doesn't exist." << std::endl;
-        return EXIT_FAILURE;
-    }
-    pathFind::World world;
+    pathResult_t search (const World& world, const Point& start, const Point& end,
+                         const solveOptions_t& options) override;
 
-    worldFile >> world;
-    worldFile.close ();
+private:
 
-    uint startX, startY, endX, endY;
+    // Reset for every query, only built again for another world or when a
+    // query wants the tiles kept another way (see SearchWorkspace::isFor)
+    std::unique_ptr<SearchWorkspace<OpenList>> m_workspace;
+};
 
-    if (args == 6)
-    {
-        // Parse the start and end points
-        try
-        {
-            startX = boost::lexical_cast<uint> (argv[2]);
-            startY = boost::lexical_cast<uint> (argv[3]);
-            endX = boost::lexical_cast<uint> (argv[4]);
-            endY = boost::lexical_cast<uint> (argv[5]);
-        } catch (boost::bad_lexical_cast &e)
-        {
-            std::cout << "Start and end points failed to convert to numeric types" << std::endl;
-            return EXIT_FAILURE;
-        }
-    }
-    else
-    {
-        std::stringstream pathFilename;
-        pathFilename << WORLD_DIR << "/" << argv[1] << PATH_EXT;
-        std::ifstream pathIn (pathFilename.str ());
-        if (!pathIn)
-        {
-            std::string pathCommand = "./pathGen " + std::string (argv[1]);
-            system (pathCommand.c_str());
-            pathIn.close ();
-            pathIn.open (pathFilename.str ());
-            if (!pathIn)
-            {
-                std::cout << "Could not construct path." << std::endl;
-                return EXIT_FAILURE;
-            }
-        }
-        pathIn >> startX >> startY >> endX >> endY;
+template <class OpenList>
+DijkstraSolver<OpenList>::DijkstraSolver (const std::string& name)
+    : Solver (name)
+{
+}
 
-    }
+template <class OpenList>
+pathResult_t DijkstraSolver<OpenList>::search (const World& world, const Point& start,
+                                               const Point& end, const solveOptions_t&)
+{
+    uint startX = start.x, startY = start.y, endX = end.x, endY = end.y;
 
+    pathResult_t result;
     #ifdef GEN_STATS
-        std::vector<std::unordered_map<uint, StatPoint>> stats (1);
+        std::vector<std::unordered_map<tileId_t, StatPoint>>& stats = result.stats;
+        stats.resize (1);
     #endif
 
     auto t1 = std::chrono::high_resolution_clock::now();
 
-    PriorityQueue openTiles (world.getWidth (), world.getHeight ());
+    size_t expectedTiles = SearchState::estimateTiles ({startX, startY}, {endX, endY}, false);
+    if (!m_workspace || !m_workspace->isFor (world, expectedTiles))
+    {
+        m_workspace.reset (new SearchWorkspace<OpenList> (world, ZeroHeuristic (), expectedTiles));
+    }
+    else
+    {
+        m_workspace->reset (ZeroHeuristic ());
+    }
+    OpenList& openTiles = m_workspace->getOpenList ();
+    SearchState& searchState = m_workspace->getSearchState ();
     #ifdef GEN_STATS
         stats[0][world (startX, startY).id] = StatPoint {startX, startY};
     #endif
@@ -105,86 +83,26 @@ int main (int args, char* argv[])
     // Dijkstra's algorithm
     openTiles.push (world (startX, startY), {startX, startY}, 0);
 
-    std::unordered_map<uint, PathTile> expandedTiles;
-    PathTile tile = openTiles.top();
-    while (tile.xy ().x != endX || tile.xy ().y != endY)
+    PathTile tile;
+    bool found = false;
+    while (!openTiles.empty ())
     {
-        openTiles.pop ();
-        expandedTiles[tile.getTile ().id] = tile;
-
-        // Check each neighbor
-        Point adjPoint {tile.xy ().x + 1, tile.xy ().y}; // east
-        if (adjPoint.x < world.getWidth() && adjPoint.y < world.getHeight ())
-        {
-            World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
-            if (worldTile.cost != 0 &&
-                expandedTiles.find (worldTile.id) == expandedTiles.end ())
-            {
-                openTiles.tryUpdateBestCost (worldTile, adjPoint, tile);
-                #ifdef GEN_STATS
-                    auto statIter = stats[0].find (worldTile.id);
-                    if (statIter == stats[0].end ())
-                    {
-                        stats[0][worldTile.id] = StatPoint {adjPoint.x, adjPoint.y};
-                    }
-                    else
-                    {
-                        statIter->second.processCount++;
-                    }
-                #endif
-            }
-        }
-
-        adjPoint = {tile.xy ().x, tile.xy ().y + 1}; // south
-        if (adjPoint.x < world.getWidth() && adjPoint.y < world.getHeight ())
+        tile = openTiles.top ();
+        if (tile.xy ().x == endX && tile.xy ().y == endY)
         {
-            World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
-            if (worldTile.cost != 0 &&
-                expandedTiles.find (worldTile.id) == expandedTiles.end ())
-            {
-                openTiles.tryUpdateBestCost (worldTile, adjPoint, tile);
-                #ifdef GEN_STATS
-                    auto statIter = stats[0].find (worldTile.id);
-                    if (statIter == stats[0].end ())
-                    {
-                        stats[0][worldTile.id] = StatPoint {adjPoint.x, adjPoint.y};
-                    }
-                    else
-                    {
-                        statIter->second.processCount++;
-                    }
-                #endif
-            }
-        }
-
-        adjPoint = {tile.xy ().x - 1, tile.xy ().y}; // west
-        if (adjPoint.x < world.getWidth() && adjPoint.y < world.getHeight ())
-        {
-            World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
-            if (worldTile.cost != 0 &&
-                expandedTiles.find (worldTile.id) == expandedTiles.end ())
-            {
-                openTiles.tryUpdateBestCost (worldTile, adjPoint, tile);
-                #ifdef GEN_STATS
-                    auto statIter = stats[0].find (worldTile.id);
-                    if (statIter == stats[0].end ())
-                    {
-                        stats[0][worldTile.id] = StatPoint {adjPoint.x, adjPoint.y};
-                    }
-                    else
-                    {
-                        statIter->second.processCount++;
-                    }
-                #endif
-            }
+            found = true;
+            break;
         }
+        openTiles.pop ();
+        searchState.close (world, tile);
 
-        adjPoint = {tile.xy ().x, tile.xy ().y - 1}; // north
-        if (adjPoint.x < world.getWidth() && adjPoint.y < world.getHeight ())
+        // Check each open neighbor
+        uint neighbors = world.getNeighborMask (tile.xy ().x, tile.xy ().y);
+        while (neighbors != 0)
         {
+            Point adjPoint = World::nextNeighbor (tile.xy (), neighbors);
             World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
-            if (worldTile.cost != 0 &&
-                expandedTiles.find (worldTile.id) == expandedTiles.end ())
+            if (!searchState.isClosed (worldTile.id))
             {
                 openTiles.tryUpdateBestCost (worldTile, adjPoint, tile);
                 #ifdef GEN_STATS
@@ -200,29 +118,35 @@ int main (int args, char* argv[])
                 #endif
             }
         }
-
-        tile = openTiles.top ();
     }
 
     auto t2 = std::chrono::high_resolution_clock::now();
+    result.ms = std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count();
+    if (!found)
+    {
+        return result;
+    }
 
     // Parse results into a stack
     uint totalCost = tile.getBestCost() - tile.getTile().cost;
+    searchState.close (world, tile);
     std::vector<Point> finalPath;
-    while (tile.xy ().x != startX || tile.xy ().y != startY)
-    {
-        finalPath.emplace_back(tile.xy ());
-        tile = expandedTiles[(tile.bestTile ().y * world.getWidth()) + tile.bestTile ().x];
-    }
-    finalPath.emplace_back(tile.xy ());
+    searchState.getPath (tile.getTile ().id, finalPath);
 
-    #ifdef GEN_STATS
-        writeResults (finalPath, stats, argv[1], ALG_NAME,
-                std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count(), totalCost);
-    #else
-        writeResults (finalPath, argv[1], ALG_NAME,
-                std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count(), totalCost);
-    #endif
+    result.found = true;
+    result.path = std::move (finalPath);
+    result.totalCost = totalCost;
+    return result;
+}
 
-    return EXIT_SUCCESS;
+void registerDijkstraSolvers (SolverRegistry& registry)
+{
+    registry.emplace<DijkstraSolver<PriorityQueue<>>> ("dijkstra");
+    registry.emplace<DijkstraSolver<DaryHeap<4>>> ("dijkstra_4ary");
+    registry.emplace<DijkstraSolver<DaryHeap<8>>> ("dijkstra_8ary");
+    registry.emplace<DijkstraSolver<BucketQueue<>>> ("dijkstra_bucket");
+    registry.emplace<DijkstraSolver<RadixHeap<>>> ("dijkstra_radix");
+    registry.emplace<DijkstraSolver<LazyQueue<>>> ("dijkstra_lazy");
 }
+
+} /* namespace pathFind */
@@ -1,123 +1,68 @@
 /**
  * File        : Fringe.cc
- * Description : Implementation of the fringe algorithm using a specified "world"
- *               from the worlds folder.
+ * Description : Implementation of the fringe algorithm as a solver for the
+ *               SolverRegistry.
  */
 
-#include <iostream>
-#include <fstream>
-#include <sstream>
 #include <unordered_map>
 #include <unordered_set>
-#include <deque>
+#include <utility>
 #include <vector>
-#include <cmath>
 #include <chrono>
-#include <thread>
-#include <mutex>
-
-#include <boost/lexical_cast.hpp>
 
+#include "algorithms/tools/Heuristics.h"
 #include "algorithms/tools/PathTile.h"
-#include "common/Results.h"
-
-using namespace pathFind;
-
-const std::string WORLD_DIR = "../worlds";
-const std::string WORLD_EXT = ".world";
-const std::string PATH_EXT = ".path";
-
-const std::string ALG_NAME = "fringe";
+#include "algorithms/tools/SearchState.h"
+#include "algorithms/SolverRegistry.h"
 
-void searchNeighbor (const Point& adjPoint, const World& world, const PathTile& current,
-    uint threshold, uint& min, std::vector<PathTile>& now, std::vector<PathTile>& later,
-    std::unordered_map<uint, PathTile>& seen, const std::function<uint (uint, uint)>& h);
+namespace pathFind
+{
 
-int main (int args, char* argv[])
+class FringeSolver : public Solver
 {
-    // Program should be started with 5 command line parameters (or 1)
-    // that specifies the name of the world file to read from and then optionallys
-    // the start x, start y, end x, and end y
-    if (args != 6  && args != 2)
-    {
-        std::cout << "Incorrect inputs. Usage: <filename> (start x) (start y) (end x) (end y)" << std::endl;
-        return EXIT_FAILURE;
-    }
+public:
 
-    // Parse the world file
-    std::stringstream filename;
-    filename << WORLD_DIR << "/" << argv[1] << WORLD_EXT;
+    explicit FringeSolver (const std::string& name);
 
-    std::ifstream worldFile (filename.str (),
-            std::ifstream::in | std::ifstream::binary);
+protected:
 
-    if (!worldFile)
-    {
-        std::cout << "World file doesn't exist." << std::endl;
-        return EXIT_FAILURE;
-    }
-    pathFind::World world;
+    pathResult_t search (const World& world, const Point& start, const Point& end,
+                         const solveOptions_t& options) override;
 
-    worldFile >> world;
-    worldFile.close ();
+private:
 
-    uint startX, startY, endX, endY;
+    static void searchNeighbor (const Point& adjPoint, const World& world, const PathTile& current,
+        uint threshold, uint& min, std::vector<PathTile>& now, std::vector<PathTile>& later,
+        SearchState& seen, const ManhattanHeuristic& h);
+};
 
-    if (args == 6)
-    {
-        // Parse the start and end points
-        try
-        {
-            startX = boost::lexical_cast<uint> (argv[2]);
-            startY = boost::lexical_cast<uint> (argv[3]);
-            endX = boost::lexical_cast<uint> (argv[4]);
-            endY = boost::lexical_cast<uint> (argv[5]);
-        } catch (boost::bad_lexical_cast &e)
-        {
-            std::cout << "Start and end points failed to convert to numeric types" << std::endl;
-            return EXIT_FAILURE;
-        }
-    }
-    else
-    {
-        std::stringstream pathFilename;
-        pathFilename << WORLD_DIR << "/" << argv[1] << PATH_EXT;
-        std::ifstream pathIn (pathFilename.str ());
-        if (!pathIn)
-        {
-            std::string pathCommand = "./pathGen " + std::string (argv[1]);
-            system (pathCommand.c_str());
-            pathIn.close ();
-            pathIn.open (pathFilename.str ());
-            if (!pathIn)
-            {
-                std::cout << "Could not construct path." << std::endl;
-                return EXIT_FAILURE;
-            }
-        }
-        pathIn >> startX >> startY >> endX >> endY;
+FringeSolver::FringeSolver (const std::string& name)
+    : Solver (name)
+{
+}
 
-    }
+pathResult_t FringeSolver::search (const World& world, const Point& start, const Point& end,
+                                   const solveOptions_t&)
+{
+    uint startX = start.x, startY = start.y, endX = end.x, endY = end.y;
 
+    pathResult_t result;
     #ifdef GEN_STATS
-        std::vector<std::unordered_map<uint, StatPoint>> stats (1);
+        std::vector<std::unordered_map<tileId_t, StatPoint>>& stats = result.stats;
+        stats.resize (1);
     #endif
 
     auto t1 = std::chrono::high_resolution_clock::now();
 
-    std::function<uint (uint, uint)> h = [endX, endY] (uint x, uint y)
-    {
-        return  (x < endX ? endX - x : x - endX) +
-                (y < endY ? endY - y : y - endY);
-    };
+    ManhattanHeuristic h (endX, endY);
 
     std::vector<PathTile> now, later;
     now.emplace_back (world (startX, startY), Point{startX, startY},
     		Point {startX, startY}, 0, h (startX, startY));
 
     uint threshold = now.back().getCombinedHeuristic();
-    std::unordered_map <uint, PathTile> seen;
-    seen[now.back().getTile().id] = now.back ();
+    SearchState seen (world);
+    seen.setBestCost (now.back ().getTile ().id, 0, now.back ().getTile ().id);
 
     bool found = false;
     PathTile endTile;
@@ -156,92 +101,86 @@ int main (int args, char* argv[])
                 break;
             }
 
-            // East
-            searchNeighbor({current.xy ().x + 1, current.xy ().y}, world, current, threshold,
-                min, now, later, seen, h);
-            // South
-            searchNeighbor({current.xy ().x, current.xy ().y + 1}, world, current, threshold,
-                min, now, later, seen, h);
-            // West
-            searchNeighbor({current.xy ().x - 1, current.xy ().y}, world, current, threshold,
-                min, now, later, seen, h);
-            // North
-            searchNeighbor({current.xy ().x, current.xy ().y - 1}, world, current, threshold,
-                min, now, later, seen, h);
+            // East, south, west then north, skipping walls and the world's edge
+            uint neighbors = world.getNeighborMask (current.xy ().x, current.xy ().y);
+            while (neighbors != 0)
+            {
+                searchNeighbor(World::nextNeighbor (current.xy (), neighbors), world, current,
+                    threshold, min, now, later, seen, h);
+            }
 
         }
+        if (found || later.empty ())
+        {
+            // Nothing is left to search if no tile went over the threshold
+            break;
+        }
         threshold = min;
         now = std::move(later);
         later.clear ();
     }
 
     auto t2 = std::chrono::high_resolution_clock::now();
+    result.ms = std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count();
+    if (!found)
+    {
+        return result;
+    }
 
     // Parse reverse results
     uint totalCost = endTile.getBestCost() - endTile.getTile().cost;
+    seen.setBestCost (endTile.getTile ().id, endTile.getBestCost (),
+                      world.getID (endTile.bestTile ().x, endTile.bestTile ().y));
     std::vector<Point> finalPath;
-    while (endTile.xy ().x != startX || endTile.xy ().y != startY)
-    {
-        finalPath.emplace_back(endTile.xy ());
-        endTile = seen.at((endTile.bestTile ().y * world.getWidth()) + endTile.bestTile ().x);
-    }
-    finalPath.emplace_back(endTile.xy ());
+    seen.getPath (endTile.getTile ().id, finalPath);
 
-    #ifdef GEN_STATS
-        writeResults (finalPath, stats, argv[1], ALG_NAME,
-                std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count(), totalCost);
-    #else
-        writeResults (finalPath, argv[1], ALG_NAME,
-                std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count(), totalCost);
-    #endif
-
-    return EXIT_SUCCESS;
+    result.found = true;
+    result.path = std::move (finalPath);
+    result.totalCost = totalCost;
+    return result;
 }
 
-void searchNeighbor (const Point& adjPoint, const World& world, const PathTile& current,
+void FringeSolver::searchNeighbor (const Point& adjPoint, const World& world, const PathTile& current,
     uint threshold, uint& min, std::vector<PathTile>& now, std::vector<PathTile>& later,
-    std::unordered_map<uint, PathTile>& seen, const std::function<uint (uint, uint)>& h)
+    SearchState& seen, const ManhattanHeuristic& h)
 {
-    if (adjPoint.x < world.getWidth () && adjPoint.y < world.getHeight ())
+    // The neighbor mask already ruled out walls and tiles outside the world
+    World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
+    uint costToTile = current.getBestCost () + worldTile.cost;
+
+    if (!seen.isReached (worldTile.id))
+    {
+        // TODO: Check if will exceed threshold here to emplace into later instead?
+        now.emplace_back (worldTile, adjPoint, current.xy(), costToTile, h (adjPoint.x, adjPoint.y));
+        seen.setBestCost (worldTile.id, costToTile, current.getTile ().id);
+    }
+    else
     {
-        World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
-        if (worldTile.cost != 0)
+        if (seen.getBestCost (worldTile.id) > costToTile)
         {
-
-            auto seenTileIter = seen.find(worldTile.id);
-            if (seenTileIter == seen.end ())
+            seen.setBestCost (worldTile.id, costToTile, current.getTile ().id);
+            PathTile seenTile (worldTile, adjPoint, current.xy (), costToTile, h (adjPoint.x, adjPoint.y));
+            if (seenTile.getCombinedHeuristic () > threshold)
             {
-                // TODO: Check if will exceed threshold here to emplace into later instead?
-                now.emplace_back (worldTile, adjPoint, current.xy(),
-                                  current.getBestCost () + worldTile.cost, h (adjPoint.x, adjPoint.y));
-                seen[worldTile.id] = now.back();
+                min = std::min(seenTile.getCombinedHeuristic (), min);
+                later.push_back(seenTile);
             }
             else
             {
-                PathTile& seenTile = seenTileIter->second;
-                uint costToTile = current.getBestCost () + seenTile.getTile ().cost;
-                if (seenTile.getBestCost () > costToTile)
-                {
-                    seenTile.setBestCost (costToTile);
-                    seenTile.setBestTile (current.xy());
-                    if (seenTile.getCombinedHeuristic () > threshold)
-                    {
-                        min = std::min(seenTile.getCombinedHeuristic (), min);
-                        later.push_back(seenTile);
-                    }
-                    else
-                    {
-                        now.push_back(seenTile);
-                    }
-                }
+                now.push_back(seenTile);
             }
         }
     }
 }
 
+void registerFringeSolvers (SolverRegistry& registry)
+{
+    registry.emplace<FringeSolver> ("fringe");
+}
+
 /*
-void search (uint startX, uint startY, uint endX, uint endY, std::unordered_set<uint>& tileIdsFound,
-             std::unordered_map<uint, PathTile>& expandedTiles,
+void search (uint startX, uint startY, uint endX, uint endY, std::unordered_set<tileId_t>& tileIdsFound,
+             std::unordered_map<tileId_t, PathTile>& expandedTiles,
              pathFind::PathTile& tile, const pathFind::World& world,
              std::mutex& m, bool& finished, bool& iFound)
 {
@@ -325,3 +264,5 @@ void search (uint startX, uint startY, uint endX, uint endY, std::unordered_set<
     }
 }
 */
+
+} /* namespace pathFind */
@@ -0,0 +1,288 @@
+/**
+ * File        : HPAStar.cc
+ * Description : Hierarchical path-finding A* (HPA*) as a solver for the
+ *               SolverRegistry. Queries search the ClusterGraph of the world
+ *               instead of its tiles: the start and end are joined to the
+ *               entrances of their clusters, A* finds the cheapest way from
+ *               entrance to entrance, and only the cluster crossings on that
+ *               way are then searched tile by tile to fill in the path. Paths
+ *               can only cross clusters at entrances, so they may cost a bit
+ *               more than the shortest path.
+ */
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "algorithms/tools/ClusterGraph.h"
+#include "algorithms/tools/FlatHashMap.h"
+#include "algorithms/tools/Heuristics.h"
+#include "algorithms/SolverRegistry.h"
+
+namespace pathFind
+{
+
+class HPAStarSolver : public Solver
+{
+public:
+
+    explicit HPAStarSolver (const std::string& name);
+
+    // Loads the ClusterGraph saved next to the world file, building and
+    // saving it first if there is none for this world
+    bool prepare (const World& world, const std::string& worldFile) override;
+
+protected:
+
+    pathResult_t search (const World& world, const Point& start, const Point& end,
+                         const solveOptions_t& options) override;
+
+private:
+
+    typedef struct openNode_t
+    {
+        uint estimate;
+        uint bestCost;
+        uint32_t node;
+    } openNode_t;
+
+    typedef struct searchNode_t
+    {
+        uint bestCost = ClusterGraph::INF;
+        uint32_t parent = ClusterGraph::NO_NODE;
+        bool closed = false;
+    } searchNode_t;
+
+    // Orders the open list by estimate, the node furthest along first on ties
+    struct isWorse
+    {
+        bool operator() (const openNode_t& a, const openNode_t& b) const;
+    };
+
+    std::shared_ptr<const ClusterGraph> m_graph;
+    // Kept between queries so they don't allocate them again
+    FlatHashMap<searchNode_t> m_searchNodes;
+    ClusterGraph::clusterSearch_t m_startSearch;
+    ClusterGraph::clusterSearch_t m_endSearch;
+    ClusterGraph::clusterSearch_t m_refineSearch;
+};
+
+// Solvers preparing for the same world file share its graph, so the workers
+// of a batch load it only once
+static std::shared_ptr<const ClusterGraph> getClusterGraph (const World& world, const std::string& graphFile,
+                                                            uint numThreads, bool& saved)
+{
+    static std::mutex graphsLock;
+    static std::map<std::string, std::pair<uint64_t, std::weak_ptr<const ClusterGraph>>> graphs;
+
+    uint64_t checksum = world.computeChecksum ();
+    std::lock_guard<std::mutex> guard (graphsLock);
+    auto& cached = graphs[graphFile];
+    std::shared_ptr<const ClusterGraph> graph = cached.second.lock ();
+    if (graph && cached.first == checksum && graph->fits (world))
+    {
+        return graph;
+    }
+
+    std::shared_ptr<ClusterGraph> newGraph = std::make_shared<ClusterGraph> ();
+    if (!newGraph->load (graphFile, world))
+    {
+        newGraph->build (world, ClusterGraph::DEFAULT_CLUSTER_SIZE, numThreads);
+        saved = newGraph->save (graphFile, world);
+    }
+    cached = std::make_pair (checksum, std::weak_ptr<const ClusterGraph> (newGraph));
+    return newGraph;
+}
+
+bool HPAStarSolver::isWorse::operator() (const openNode_t& a, const openNode_t& b) const
+{
+    return a.estimate > b.estimate || (a.estimate == b.estimate && a.bestCost < b.bestCost);
+}
+
+HPAStarSolver::HPAStarSolver (const std::string& name)
+    : Solver (name)
+{
+}
+
+bool HPAStarSolver::prepare (const World& world, const std::string& worldFile)
+{
+    bool saved = true;
+    boost::filesystem::path graphFile (worldFile);
+    graphFile.replace_extension (ClusterGraph::CLUSTER_GRAPH_EXT);
+    m_graph = getClusterGraph (world, graphFile.string (), getNumThreads (solveOptions_t (), 0), saved);
+    return saved;
+}
+
+pathResult_t HPAStarSolver::search (const World& world, const Point& start, const Point& end,
+                                    const solveOptions_t& options)
+{
+    if (!m_graph || !m_graph->fits (world))
+    {
+        // Not prepared for this world, build a graph just for this process
+        std::shared_ptr<ClusterGraph> graph = std::make_shared<ClusterGraph> ();
+        graph->build (world, ClusterGraph::DEFAULT_CLUSTER_SIZE, getNumThreads (options, 0));
+        m_graph = graph;
+    }
+    const ClusterGraph& graph = *m_graph;
+
+    pathResult_t result;
+    #ifdef GEN_STATS
+        std::vector<std::unordered_map<tileId_t, StatPoint>>& stats = result.stats;
+        stats.resize (1);
+    #endif
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    // The start and end join the graph as two extra nodes
+    const uint32_t startNode = graph.getNumNodes ();
+    const uint32_t endNode = startNode + 1;
+    uint endCluster = graph.getCluster (end.x, end.y);
+    auto getTile = [&] (uint32_t node)
+    {
+        if (node >= startNode)
+        {
+            return node == startNode ? start : end;
+        }
+        const ClusterGraph::node_t& graphNode = graph.getNode (node);
+        return Point (graphNode.x, graphNode.y);
+    };
+
+    // Costs from the start to the tiles of its cluster, and to the end from
+    // those of the end's cluster. Entering tiles costs, so the way back
+    // costs the end tile instead of the tile the way started from.
+    graph.searchCluster (world, start, nullptr, m_startSearch);
+    graph.searchCluster (world, end, nullptr, m_endSearch);
+    uint endCost = world (end.x, end.y).cost;
+    auto getCostToEnd = [&] (const Point& tile)
+    {
+        uint32_t fromEnd = m_endSearch.costs[graph.getLocalIndex (tile.x, tile.y)];
+        return fromEnd == ClusterGraph::INF ? fromEnd : fromEnd - world (tile.x, tile.y).cost + endCost;
+    };
+
+    ManhattanHeuristic heuristic (end.x, end.y);
+    std::priority_queue<openNode_t, std::vector<openNode_t>, isWorse> openNodes;
+    m_searchNodes.clear ();
+    auto relax = [&] (uint32_t from, uint32_t to, uint32_t bestCost)
+    {
+        searchNode_t& node = m_searchNodes[to];
+        if (!node.closed && bestCost < node.bestCost)
+        {
+            node.bestCost = bestCost;
+            node.parent = from;
+            Point tile = getTile (to);
+            openNodes.push ({bestCost + heuristic (tile.x, tile.y), bestCost, to});
+        }
+    };
+
+    relax (startNode, startNode, 0);
+    bool found = false;
+    while (!openNodes.empty ())
+    {
+        openNode_t current = openNodes.top ();
+        openNodes.pop ();
+        searchNode_t& currentNode = *m_searchNodes.find (current.node);
+        // Nodes are pushed again when a cheaper way to them is found
+        if (currentNode.closed || current.bestCost != currentNode.bestCost)
+        {
+            continue;
+        }
+        currentNode.closed = true;
+        if (current.node == endNode)
+        {
+            found = true;
+            break;
+        }
+
+        Point tile = getTile (current.node);
+        uint cluster = graph.getCluster (tile.x, tile.y);
+        #ifdef GEN_STATS
+            stats[0][world.getID (tile.x, tile.y)] = StatPoint {tile.x, tile.y};
+        #endif
+
+        if (current.node != startNode)
+        {
+            const ClusterGraph::node_t& node = graph.getNode (current.node);
+            for (uint32_t link : node.links)
+            {
+                if (link != ClusterGraph::NO_NODE)
+                {
+                    const ClusterGraph::node_t& linked = graph.getNode (link);
+                    relax (current.node, link, current.bestCost + world (linked.x, linked.y).cost);
+                }
+            }
+        }
+        for (uint32_t other = graph.getFirstNode (cluster); other < graph.getFirstNode (cluster + 1); ++other)
+        {
+            uint32_t distance = current.node == startNode ?
+                    m_startSearch.costs[graph.getLocalIndex (graph.getNode (other).x, graph.getNode (other).y)] :
+                    graph.getDistance (current.node, other);
+            if (other != current.node && distance != ClusterGraph::INF)
+            {
+                relax (current.node, other, current.bestCost + distance);
+            }
+        }
+        if (cluster == endCluster)
+        {
+            uint32_t distance = getCostToEnd (tile);
+            if (distance != ClusterGraph::INF)
+            {
+                relax (current.node, endNode, current.bestCost + distance);
+            }
+        }
+    }
+
+    if (!found)
+    {
+        auto t2 = std::chrono::high_resolution_clock::now();
+        result.ms = std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count();
+        return result;
+    }
+
+    // Only the steps the abstract path takes through a cluster are searched
+    // tile by tile, steps across a border are between neighbors already
+    std::vector<Point> finalPath;
+    finalPath.push_back (end);
+    uint32_t node = endNode;
+    Point tile = end;
+    while (node != startNode)
+    {
+        uint32_t parent = m_searchNodes.find (node)->parent;
+        Point parentTile = getTile (parent);
+        if (graph.getCluster (parentTile.x, parentTile.y) != graph.getCluster (tile.x, tile.y))
+        {
+            finalPath.push_back (parentTile);
+        }
+        else
+        {
+            graph.searchCluster (world, parentTile, &tile, m_refineSearch);
+            graph.getClusterPath (m_refineSearch, parentTile, tile, finalPath);
+        }
+        node = parent;
+        tile = parentTile;
+    }
+
+    auto t2 = std::chrono::high_resolution_clock::now();
+    result.ms = std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count();
+
+    // Like the other algorithms the cost leaves out the end tile
+    uint pathCost = m_searchNodes.find (endNode)->bestCost;
+
+    result.found = true;
+    result.path = std::move (finalPath);
+    result.totalCost = pathCost > 0 ? pathCost - endCost : 0;
+    return result;
+}
+
+void registerHPAStarSolvers (SolverRegistry& registry)
+{
+    registry.emplace<HPAStarSolver> ("hpaStar");
+}
+
+} /* namespace pathFind */
@@ -0,0 +1,454 @@
+/**
+ * File        : JPS.cc
+ * Description : Jump Point Search for worlds where every open tile costs the
+ *               same, as a solver for the SolverRegistry. Of all the equally
+ *               short paths between two tiles only the canonical one, moving
+ *               horizontally before vertically wherever walls allow it, is
+ *               followed, so the search jumps along straight lines and only
+ *               puts the tiles where a canonical path may turn in the open
+ *               list. JPS+ looks each jump up in a JumpTable instead of
+ *               scanning the tiles along it. Worlds whose tiles cost more
+ *               than 1 are searched with A* instead.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "algorithms/tools/Heuristics.h"
+#include "algorithms/tools/JumpTable.h"
+#include "algorithms/tools/SearchState.h"
+#include "algorithms/tools/SearchWorkspace.h"
+#include "algorithms/SolverRegistry.h"
+
+namespace pathFind
+{
+
+class JPSSolver : public Solver
+{
+public:
+
+    // With plus set the jumps are looked up in a JumpTable
+    JPSSolver (const std::string& name, bool plus);
+
+    // Loads the JumpTable saved next to the world file, building and saving
+    // it first if there is none for this world
+    bool prepare (const World& world, const std::string& worldFile) override;
+
+protected:
+
+    pathResult_t search (const World& world, const Point& start, const Point& end,
+                         const solveOptions_t& options) override;
+
+private:
+
+    typedef struct openTile_t
+    {
+        uint estimate;
+        uint bestCost;
+        tileId_t id;
+    } openTile_t;
+
+    // Orders the open list by estimate, the tile furthest along first on ties
+    struct isWorse
+    {
+        bool operator() (const openTile_t& a, const openTile_t& b) const;
+    };
+
+    // A binary heap of jump points that keeps its storage between queries.
+    // The estimates are worked out by the search itself, the heuristic is
+    // only there to fit the SearchWorkspace.
+    class JumpPointList
+    {
+    public:
+
+        typedef ZeroHeuristic heuristic_t;
+
+        JumpPointList (size_t worldWidth, size_t worldHeight, heuristic_t heuristic = heuristic_t ());
+
+        void reset (heuristic_t heuristic = heuristic_t ());
+        bool empty () const;
+        const openTile_t& top () const;
+        void pop ();
+        void push (const openTile_t& tile);
+
+    private:
+
+        std::vector<openTile_t> m_heap;
+    };
+
+    // Each jump moves tile to where the jump stops and returns false if it
+    // runs into a wall first. Jumps also stop on the goal.
+    static bool jumpVertical (const World& world, Point& tile, uint direction, const Point& goal);
+    static bool jumpHorizontal (const World& world, Point& tile, uint direction, const Point& goal);
+    bool jumpVerticalPlus (Point& tile, uint direction, const Point& goal) const;
+    bool jumpHorizontalPlus (Point& tile, uint direction, const Point& goal) const;
+    bool jump (const World& world, Point& tile, uint direction, const Point& goal) const;
+
+    bool m_plus;
+    std::shared_ptr<const JumpTable> m_jumpTable;
+    std::unique_ptr<Solver> m_fallback;
+    // Reset for every query, only built again for another world or when a
+    // query wants the tiles kept another way (see SearchWorkspace::isFor)
+    std::unique_ptr<SearchWorkspace<JumpPointList>> m_workspace;
+};
+
+// Solvers preparing for the same world file share its table, so the workers
+// of a batch load it only once
+static std::shared_ptr<const JumpTable> getJumpTable (const World& world, const std::string& tableFile,
+                                                      bool& saved)
+{
+    static std::mutex tablesLock;
+    static std::map<std::string, std::pair<uint64_t, std::weak_ptr<const JumpTable>>> tables;
+
+    uint64_t checksum = world.computeChecksum ();
+    std::lock_guard<std::mutex> guard (tablesLock);
+    auto& cached = tables[tableFile];
+    std::shared_ptr<const JumpTable> table = cached.second.lock ();
+    if (table && cached.first == checksum && table->fits (world))
+    {
+        return table;
+    }
+
+    std::shared_ptr<JumpTable> newTable = std::make_shared<JumpTable> ();
+    if (!newTable->load (tableFile, world))
+    {
+        newTable->build (world);
+        saved = newTable->save (tableFile, world);
+    }
+    cached = std::make_pair (checksum, std::weak_ptr<const JumpTable> (newTable));
+    return newTable;
+}
+
+// Every open tile costs 1, JPS can't tell paths of equal length apart otherwise
+static bool isUniformCost (const World& world)
+{
+    return world.getMaxTileCost () == 1;
+}
+
+static uint distance (const Point& a, const Point& b)
+{
+    return std::abs (static_cast<int> (a.x) - static_cast<int> (b.x)) +
+           std::abs (static_cast<int> (a.y) - static_cast<int> (b.y));
+}
+
+// The tile next to tile in direction
+static Point step (const Point& tile, uint direction)
+{
+    return World::nextNeighbor (tile, direction);
+}
+
+bool JPSSolver::isWorse::operator() (const openTile_t& a, const openTile_t& b) const
+{
+    return a.estimate > b.estimate || (a.estimate == b.estimate && a.bestCost < b.bestCost);
+}
+
+JPSSolver::JumpPointList::JumpPointList (size_t, size_t, heuristic_t)
+{
+}
+
+void JPSSolver::JumpPointList::reset (heuristic_t)
+{
+    m_heap.clear ();
+}
+
+bool JPSSolver::JumpPointList::empty () const
+{
+    return m_heap.empty ();
+}
+
+const JPSSolver::openTile_t& JPSSolver::JumpPointList::top () const
+{
+    return m_heap.front ();
+}
+
+void JPSSolver::JumpPointList::pop ()
+{
+    std::pop_heap (m_heap.begin (), m_heap.end (), isWorse ());
+    m_heap.pop_back ();
+}
+
+void JPSSolver::JumpPointList::push (const openTile_t& tile)
+{
+    m_heap.push_back (tile);
+    std::push_heap (m_heap.begin (), m_heap.end (), isWorse ());
+}
+
+JPSSolver::JPSSolver (const std::string& name, bool plus)
+    : Solver (name),
+      m_plus (plus)
+{
+}
+
+bool JPSSolver::prepare (const World& world, const std::string& worldFile)
+{
+    if (!m_plus || !isUniformCost (world))
+    {
+        return true;
+    }
+    bool saved = true;
+    boost::filesystem::path tableFile (worldFile);
+    tableFile.replace_extension (JumpTable::JUMP_TABLE_EXT);
+    m_jumpTable = getJumpTable (world, tableFile.string (), saved);
+    return saved;
+}
+
+bool JPSSolver::jumpVertical (const World& world, Point& tile, uint direction, const Point& goal)
+{
+    uint mask = world.getNeighborMask (tile.x, tile.y);
+    while ((mask & direction) != 0)
+    {
+        tile = step (tile, direction);
+        uint nextMask = world.getNeighborMask (tile.x, tile.y);
+        if ((tile.x == goal.x && tile.y == goal.y) || JumpTable::isVerticalJumpPoint (mask, nextMask))
+        {
+            return true;
+        }
+        mask = nextMask;
+    }
+    return false;
+}
+
+bool JPSSolver::jumpHorizontal (const World& world, Point& tile, uint direction, const Point& goal)
+{
+    while ((world.getNeighborMask (tile.x, tile.y) & direction) != 0)
+    {
+        tile = step (tile, direction);
+        if (tile.x == goal.x && tile.y == goal.y)
+        {
+            return true;
+        }
+        // A canonical path may turn here if a vertical jump from here stops
+        Point north = tile, south = tile;
+        if (jumpVertical (world, north, World::NORTH, goal) || jumpVertical (world, south, World::SOUTH, goal))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JPSSolver::jumpVerticalPlus (Point& tile, uint direction, const Point& goal) const
+{
+    int32_t jumpDistance = m_jumpTable->getDistance (tile.x, tile.y, direction);
+    uint reach = std::abs (jumpDistance);
+    bool goalAhead = goal.x == tile.x && (direction == World::SOUTH ? goal.y > tile.y : goal.y < tile.y);
+    if (goalAhead && distance (tile, goal) <= reach)
+    {
+        tile = goal;
+        return true;
+    }
+    if (jumpDistance <= 0)
+    {
+        return false;
+    }
+    tile.y = direction == World::SOUTH ? tile.y + jumpDistance : tile.y - jumpDistance;
+    return true;
+}
+
+bool JPSSolver::jumpHorizontalPlus (Point& tile, uint direction, const Point& goal) const
+{
+    int32_t jumpDistance = m_jumpTable->getDistance (tile.x, tile.y, direction);
+    uint reach = std::abs (jumpDistance);
+    uint stop = jumpDistance > 0 ? jumpDistance : 0;
+
+    // The one tile of the row the table can't know about is the one in the
+    // goal's column, where a vertical jump would stop on the goal
+    bool columnAhead = direction == World::EAST ? goal.x > tile.x : goal.x < tile.x;
+    uint columnDistance = std::abs (static_cast<int> (goal.x) - static_cast<int> (tile.x));
+    if (columnAhead && columnDistance <= reach && (stop == 0 || columnDistance < stop))
+    {
+        bool goalReachable = goal.y == tile.y;
+        if (!goalReachable)
+        {
+            uint toGoal = goal.y > tile.y ? World::SOUTH : World::NORTH;
+            int32_t verticalDistance = m_jumpTable->getDistance (goal.x, tile.y, toGoal);
+            uint rows = std::abs (static_cast<int> (goal.y) - static_cast<int> (tile.y));
+            goalReachable = verticalDistance <= 0 && rows <= static_cast<uint> (-verticalDistance);
+        }
+        if (goalReachable)
+        {
+            stop = columnDistance;
+        }
+    }
+
+    if (stop == 0)
+    {
+        return false;
+    }
+    tile.x = direction == World::EAST ? tile.x + stop : tile.x - stop;
+    return true;
+}
+
+bool JPSSolver::jump (const World& world, Point& tile, uint direction, const Point& goal) const
+{
+    bool vertical = (direction & (World::NORTH | World::SOUTH)) != 0;
+    if (m_plus)
+    {
+        return vertical ? jumpVerticalPlus (tile, direction, goal) : jumpHorizontalPlus (tile, direction, goal);
+    }
+    return vertical ? jumpVertical (world, tile, direction, goal) : jumpHorizontal (world, tile, direction, goal);
+}
+
+pathResult_t JPSSolver::search (const World& world, const Point& start, const Point& end,
+                                const solveOptions_t& options)
+{
+    if (!isUniformCost (world))
+    {
+        if (!m_fallback)
+        {
+            m_fallback = SolverRegistry::getDefault ().create ("aStar");
+        }
+        return m_fallback->solve (world, start, end, options);
+    }
+    if (m_plus && (!m_jumpTable || !m_jumpTable->fits (world)))
+    {
+        // Not prepared for this world, build a table just for this process
+        std::shared_ptr<JumpTable> table = std::make_shared<JumpTable> ();
+        table->build (world);
+        m_jumpTable = table;
+    }
+
+    pathResult_t result;
+    #ifdef GEN_STATS
+        std::vector<std::unordered_map<tileId_t, StatPoint>>& stats = result.stats;
+        stats.resize (1);
+    #endif
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    size_t expectedTiles = SearchState::estimateTiles (start, end, true);
+    if (!m_workspace || !m_workspace->isFor (world, expectedTiles))
+    {
+        m_workspace.reset (new SearchWorkspace<JumpPointList> (world, ZeroHeuristic (), expectedTiles));
+    }
+    else
+    {
+        m_workspace->reset ();
+    }
+    JumpPointList& openTiles = m_workspace->getOpenList ();
+    SearchState& searchState = m_workspace->getSearchState ();
+
+    tileId_t startId = world.getID (start.x, start.y);
+    tileId_t endId = world.getID (end.x, end.y);
+    searchState.setBestCost (startId, 0, startId);
+    openTiles.push ({distance (start, end), 0, startId});
+
+    bool found = false;
+    while (!openTiles.empty ())
+    {
+        openTile_t current = openTiles.top ();
+        openTiles.pop ();
+        // Tiles are pushed again when a cheaper way to them is found
+        if (searchState.isClosed (current.id) || current.bestCost != searchState.getBestCost (current.id))
+        {
+            continue;
+        }
+        searchState.close (current.id);
+        if (current.id == endId)
+        {
+            found = true;
+            break;
+        }
+
+        Point tile (current.id % world.getWidth (), current.id / world.getWidth ());
+        #ifdef GEN_STATS
+            stats[0][current.id] = StatPoint {tile.x, tile.y};
+        #endif
+
+        // Directions a canonical path can leave the tile in
+        uint mask = world.getNeighborMask (tile.x, tile.y);
+        uint directions = World::EAST | World::SOUTH | World::WEST | World::NORTH;
+        tileId_t parentId = searchState.getBestTile (current.id);
+        if (parentId != current.id)
+        {
+            Point parent (parentId % world.getWidth (), parentId / world.getWidth ());
+            if (parent.y == tile.y)
+            {
+                // Straight on, or turn either way
+                directions = (parent.x < tile.x ? World::EAST : World::WEST) | World::NORTH | World::SOUTH;
+            }
+            else
+            {
+                // Straight on, or turn towards an opening the tile before had a wall beside
+                directions = parent.y < tile.y ? World::SOUTH : World::NORTH;
+                Point before = step (tile, directions == World::SOUTH ? World::NORTH : World::SOUTH);
+                directions |= mask & ~world.getNeighborMask (before.x, before.y) & (World::EAST | World::WEST);
+            }
+        }
+        directions &= mask;
+
+        while (directions != 0)
+        {
+            uint direction = directions & -directions;
+            directions &= directions - 1;
+
+            Point jumpPoint = tile;
+            if (!jump (world, jumpPoint, direction, end))
+            {
+                continue;
+            }
+            tileId_t jumpId = world.getID (jumpPoint.x, jumpPoint.y);
+            uint bestCost = current.bestCost + distance (tile, jumpPoint);
+            if (!searchState.isClosed (jumpId) && bestCost < searchState.getBestCost (jumpId))
+            {
+                searchState.setBestCost (jumpId, bestCost, current.id);
+                openTiles.push ({bestCost + distance (jumpPoint, end), bestCost, jumpId});
+            }
+        }
+    }
+
+    auto t2 = std::chrono::high_resolution_clock::now();
+    result.ms = std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count();
+    if (!found)
+    {
+        return result;
+    }
+
+    // Fill in the straight lines between the jump points, from the end back
+    std::vector<Point> finalPath;
+    tileId_t id = endId;
+    Point tile = end;
+    finalPath.push_back (tile);
+    while (id != startId)
+    {
+        id = searchState.getBestTile (id);
+        Point jumpPoint (id % world.getWidth (), id / world.getWidth ());
+        while (tile.x != jumpPoint.x || tile.y != jumpPoint.y)
+        {
+            if (tile.x != jumpPoint.x)
+            {
+                tile.x = tile.x < jumpPoint.x ? tile.x + 1 : tile.x - 1;
+            }
+            else
+            {
+                tile.y = tile.y < jumpPoint.y ? tile.y + 1 : tile.y - 1;
+            }
+            finalPath.push_back (tile);
+        }
+    }
+
+    // Like the other algorithms the cost leaves out the end tile
+    uint pathCost = searchState.getBestCost (endId);
+
+    result.found = true;
+    result.path = std::move (finalPath);
+    result.totalCost = pathCost > 0 ? pathCost - 1 : 0;
+    return result;
+}
+
+void registerJPSSolvers (SolverRegistry& registry)
+{
+    registry.emplace<JPSSolver> ("jps", false);
+    registry.emplace<JPSSolver> ("jps_plus", true);
+}
+
+} /* namespace pathFind */
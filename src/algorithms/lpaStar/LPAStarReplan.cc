@@ -0,0 +1,148 @@
+/**
+ * File        : LPAStarReplan.cc
+ * Description : Finds a path with LPA* in a specified "world" from the worlds folder
+ *               and then keeps it up to date through a series of world deltas, only
+ *               repairing the part of the search each delta invalidates.
+ *               Runs given options, such as --batch, are left to the lpaStar
+ *               solver of the SolverRegistry like any other algorithm.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "algorithms/tools/LPAStar.h"
+#include "algorithms/SolverRegistry.h"
+#include "common/Results.h"
+#include "common/WorldDelta.h"
+
+using namespace pathFind;
+
+const std::string WORLD_DIR = "../worlds";
+const std::string WORLD_EXT = ".world";
+const std::string PATH_EXT = ".path";
+const std::string DELTA_EXT = ".delta";
+
+const std::string ALG_NAME = "lpaStar";
+
+int main (int args, char* argv[])
+{
+    for (int i = 1; i < args; ++i)
+    {
+        if (std::string (argv[i]).compare (0, 2, "--") == 0)
+        {
+            return runSolverMain (ALG_NAME, args, argv);
+        }
+    }
+
+    // Program should be started with the name of the world file to read from,
+    // optionally followed by the names of deltas to apply to it one after another
+    if (args < 2)
+    {
+        std::cout << "Incorrect inputs. Usage: <filename> (delta name)..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Parse the world file
+    std::stringstream filename;
+    filename << WORLD_DIR << "/" << argv[1] << WORLD_EXT;
+
+    pathFind::World world;
+    if (!world.loadFile (filename.str ()))
+    {
+        std::cout << "World file doesn't exist." << std::endl;
+        return EXIT_FAILURE;
+    }
+    world.buildNeighborMasks ();
+
+    std::vector<WorldDelta> deltas (args - 2);
+    for (int i = 2; i < args; ++i)
+    {
+        std::string deltaFilename = WORLD_DIR + "/" + argv[i] + DELTA_EXT;
+        if (!deltas[i - 2].loadFile (deltaFilename))
+        {
+            std::cout << "Delta file " << deltaFilename << " doesn't exist or is corrupt." << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    uint startX, startY, endX, endY;
+
+    std::stringstream pathFilename;
+    pathFilename << WORLD_DIR << "/" << argv[1] << PATH_EXT;
+    std::ifstream pathIn (pathFilename.str ());
+    if (!pathIn)
+    {
+        std::string pathCommand = "./pathGen " + std::string (argv[1]);
+        system (pathCommand.c_str());
+        pathIn.close ();
+        pathIn.open (pathFilename.str ());
+        if (!pathIn)
+        {
+            std::cout << "Could not construct path." << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    pathIn >> startX >> startY >> endX >> endY;
+
+    // Worlds that carry component labels tell us up front if there is no path at all
+    if (!world.isReachable (startX, startY, endX, endY))
+    {
+        std::cout << "No path exists between the start and end points." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    LPAStar planner (world, {startX, startY}, {endX, endY});
+    bool found = planner.computePath ();
+
+    auto t2 = std::chrono::high_resolution_clock::now();
+    uint initialMs = std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count();
+    std::cout << "initial: " << initialMs << " ms, " << planner.getExpansions ()
+              << " expansions, cost " << (found ? std::to_string (planner.getPathCost ()) : "none")
+              << std::endl;
+
+    // Repair the path after each delta
+    uint replanMs = 0;
+    for (uint i = 0; i < deltas.size (); ++i)
+    {
+        if (!deltas[i].applyTo (world))
+        {
+            std::cout << "Delta " << argv[i + 2] << " is for a world of a different size." << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        size_t expansionsBefore = planner.getExpansions ();
+        t1 = std::chrono::high_resolution_clock::now();
+
+        for (const WorldDelta::update_t& update : deltas[i].getUpdates ())
+        {
+            planner.updateTile (update.id % world.getWidth (), update.id / world.getWidth ());
+        }
+        found = planner.computePath ();
+
+        t2 = std::chrono::high_resolution_clock::now();
+        uint ms = std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count();
+        replanMs += ms;
+        std::cout << argv[i + 2] << ": " << deltas[i].getUpdates ().size () << " updates, "
+                  << ms << " ms, " << planner.getExpansions () - expansionsBefore
+                  << " expansions, cost " << (found ? std::to_string (planner.getPathCost ()) : "none")
+                  << std::endl;
+    }
+
+    if (!found)
+    {
+        std::cout << "No path exists between the start and end points." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    writeResults (planner.getPath (), argv[1], ALG_NAME, initialMs + replanMs,
+                  planner.getPathCost ());
+
+    return EXIT_SUCCESS;
+}
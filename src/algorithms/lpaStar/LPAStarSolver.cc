@@ -0,0 +1,60 @@
+/**
+ * File        : LPAStarSolver.cc
+ * Description : Runs the first search of Lifelong Planning A* as a solver for
+ *               the SolverRegistry. Replanning after world deltas needs the
+ *               planner itself and is left to the lpaStar executable.
+ */
+
+#include <chrono>
+
+#include "algorithms/tools/LPAStar.h"
+#include "algorithms/SolverRegistry.h"
+
+namespace pathFind
+{
+
+class LPAStarSolver : public Solver
+{
+public:
+
+    explicit LPAStarSolver (const std::string& name);
+
+protected:
+
+    pathResult_t search (const World& world, const Point& start, const Point& end,
+                         const solveOptions_t& options) override;
+};
+
+LPAStarSolver::LPAStarSolver (const std::string& name)
+    : Solver (name)
+{
+}
+
+pathResult_t LPAStarSolver::search (const World& world, const Point& start, const Point& end,
+                                    const solveOptions_t&)
+{
+    pathResult_t result;
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    LPAStar planner (world, start, end);
+    bool found = planner.computePath ();
+
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    if (found)
+    {
+        result.found = true;
+        result.path = planner.getPath ();
+        result.totalCost = planner.getPathCost ();
+    }
+    result.ms = std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count();
+    return result;
+}
+
+void registerLPAStarSolvers (SolverRegistry& registry)
+{
+    registry.emplace<LPAStarSolver> ("lpaStar");
+}
+
+} /* namespace pathFind */
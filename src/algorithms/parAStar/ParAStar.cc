@@ -0,0 +1,286 @@
+/**
+ * File        : ParAStar.cc
+ * Description : Implementation of a parallel A* algorithm as a solver for the
+ *               SolverRegistry. All threads expand tiles from one shared,
+ *               relaxed open list (a MultiQueue), so a tile can be expanded
+ *               before its best cost is known. When a cheaper path to a tile
+ *               turns up later the tile is simply expanded again, and the
+ *               search ends once no open tile can beat the best path to the
+ *               end found so far.
+ */
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "algorithms/tools/PathTile.h"
+#include "algorithms/tools/Heuristics.h"
+#include "algorithms/tools/MultiQueue.h"
+#include "algorithms/tools/WorkerPool.h"
+#include "algorithms/SolverRegistry.h"
+
+namespace pathFind
+{
+
+// The best cost found for a tile in the high half. The low half holds the
+// search that found it above 2 bits for the direction of the tile it was
+// reached from (the bit index of the World::Direction pointing there), so
+// all of it is replaced by a single CAS whatever the size of the world.
+typedef uint64_t bestPath_t;
+
+// Searches are numbered from 1 and wrap around after this many
+const uint32_t MAX_GENERATION = static_cast<uint32_t> (1) << 30;
+
+struct openTile_t
+{
+    tileId_t id;
+    uint bestCost;
+};
+
+// INF for tiles last reached by an earlier search
+inline uint getBestCost (bestPath_t bestPath, uint32_t generation)
+{
+    return ((bestPath & 0xFFFFFFFF) >> 2) == generation ? bestPath >> 32 : PathTile::INF;
+}
+
+inline uint getDirection (bestPath_t bestPath)
+{
+    return bestPath & 3;
+}
+
+inline bestPath_t makeBestPath (uint bestCost, uint32_t generation, uint direction)
+{
+    return (static_cast<bestPath_t> (bestCost) << 32) | (generation << 2) | direction;
+}
+
+class ParAStarSolver : public Solver
+{
+public:
+
+    ParAStarSolver (const std::string& name, uint numThreads);
+
+    bool isParallel () const override;
+    uint getThreadsPerSearch (const solveOptions_t& options) const override;
+
+protected:
+
+    pathResult_t search (const World& world, const Point& start, const Point& end,
+                         const solveOptions_t& options) override;
+
+private:
+
+    // Lowers the best cost of a tile if cost beats it. Returns false if some
+    // thread already reached the tile at least as cheaply.
+    bool tryUpdateBestCost (std::atomic<bestPath_t>& bestPath, uint cost, uint direction) const;
+
+    void searchThread (uint id, const Point& end, const World& world,
+                       const ManhattanHeuristic& heuristic,
+                       MultiQueue<openTile_t>& openTiles,
+                       std::atomic<uint>& pathCost, std::atomic<size_t>& numPending);
+
+    uint m_numThreads;
+    // Best paths of every tile, kept from query to query. Entries left by
+    // earlier queries carry an older generation and read as unreached, so
+    // the array is only cleared when it is made or the generations wrap.
+    std::unique_ptr<std::atomic<bestPath_t>[]> m_bestPaths;
+    size_t m_numTiles;
+    uint32_t m_generation;
+    // Tiles each thread expanded, only used in builds with GEN_STATS
+    std::vector<std::unordered_map<tileId_t, StatPoint>> m_stats;
+};
+
+ParAStarSolver::ParAStarSolver (const std::string& name, uint numThreads)
+    : Solver (name),
+      m_numThreads (numThreads),
+      m_numTiles (0),
+      m_generation (0)
+{
+}
+
+bool ParAStarSolver::isParallel () const
+{
+    return true;
+}
+
+uint ParAStarSolver::getThreadsPerSearch (const solveOptions_t& options) const
+{
+    return getNumThreads (options, m_numThreads);
+}
+
+pathResult_t ParAStarSolver::search (const World& world, const Point& start, const Point& end,
+                                     const solveOptions_t& options)
+{
+    uint startX = start.x, startY = start.y, endX = end.x, endY = end.y;
+    uint numThreads = getThreadsPerSearch (options);
+
+    pathResult_t result;
+    #ifdef GEN_STATS
+        m_stats.assign (numThreads, std::unordered_map<tileId_t, StatPoint> ());
+    #endif
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    size_t numTiles = world.getWidth () * world.getHeight ();
+    if (++m_generation == MAX_GENERATION || numTiles != m_numTiles)
+    {
+        if (numTiles != m_numTiles)
+        {
+            m_bestPaths.reset (new std::atomic<bestPath_t>[numTiles]);
+            m_numTiles = numTiles;
+        }
+        // Generation 0 is never searched with
+        for (size_t i = 0; i < numTiles; ++i)
+        {
+            m_bestPaths[i].store (0, std::memory_order_relaxed);
+        }
+        m_generation = 1;
+    }
+
+    ManhattanHeuristic heuristic (endX, endY);
+    MultiQueue<openTile_t> openTiles (numThreads);
+
+    tileId_t startId = world (startX, startY).id;
+    m_bestPaths[startId].store (makeBestPath (0, m_generation, 0));
+    openTiles.push (heuristic (startX, startY), openTile_t {startId, 0});
+
+    // Cost of the best path to the end found so far
+    std::atomic<uint> pathCost (PathTile::INF);
+    // Tiles in the open list plus tiles being expanded. Only reaches zero
+    // once no thread can push anything new.
+    std::atomic<size_t> numPending (1);
+
+    WorkerPool::getShared ().run (numThreads, [&] (uint id)
+    {
+        searchThread (id, Point {endX, endY}, world, heuristic, openTiles, pathCost, numPending);
+    });
+
+    auto t2 = std::chrono::high_resolution_clock::now();
+    result.ms = std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count();
+
+    tileId_t endId = world (endX, endY).id;
+    if (pathCost.load () == PathTile::INF)
+    {
+        return result;
+    }
+
+    // Parse results into a stack
+    uint totalCost = pathCost.load () - world (endX, endY).cost;
+    std::vector<Point> finalPath;
+    Point xy (endX, endY);
+    tileId_t tileId = endId;
+    while (tileId != startId)
+    {
+        finalPath.push_back (xy);
+        uint direction = 1u << getDirection (m_bestPaths[tileId].load ());
+        xy = World::nextNeighbor (xy, direction);
+        tileId = world.getID (xy.x, xy.y);
+    }
+    finalPath.emplace_back (startX, startY);
+
+    result.found = true;
+    result.path = std::move (finalPath);
+    result.totalCost = totalCost;
+    #ifdef GEN_STATS
+        result.stats = std::move (m_stats);
+    #endif
+    return result;
+}
+
+bool ParAStarSolver::tryUpdateBestCost (std::atomic<bestPath_t>& bestPath, uint cost, uint direction) const
+{
+    bestPath_t current = bestPath.load (std::memory_order_relaxed);
+    while (cost < getBestCost (current, m_generation))
+    {
+        if (bestPath.compare_exchange_weak (current, makeBestPath (cost, m_generation, direction)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ParAStarSolver::searchThread (uint id, const Point& end, const World& world,
+                                   const ManhattanHeuristic& heuristic,
+                                   MultiQueue<openTile_t>& openTiles,
+                                   std::atomic<uint>& pathCost, std::atomic<size_t>& numPending)
+{
+    #ifndef GEN_STATS
+        (void) id;
+    #endif
+
+    while (numPending.load () != 0)
+    {
+        uint key;
+        openTile_t tile;
+        if (!openTiles.tryPop (key, tile))
+        {
+            // Other threads are still expanding and may push more tiles
+            std::this_thread::yield ();
+            continue;
+        }
+
+        // Skip copies of tiles that have since been reached more cheaply and
+        // tiles that cannot lead to a cheaper path than the one already found
+        if (key < pathCost.load () && tile.bestCost == getBestCost (m_bestPaths[tile.id].load (), m_generation))
+        {
+            Point xy (tile.id % world.getWidth (), tile.id / world.getWidth ());
+            #ifdef GEN_STATS
+                auto statIter = m_stats[id].find (tile.id);
+                if (statIter == m_stats[id].end ())
+                {
+                    m_stats[id][tile.id] = StatPoint {xy.x, xy.y};
+                }
+                else
+                {
+                    statIter->second.processCount++;
+                }
+            #endif
+
+            uint neighbors = world.getNeighborMask (xy.x, xy.y);
+            while (neighbors != 0)
+            {
+                // The neighbor is reached from this tile, the opposite way
+                // of the step to it
+                uint back = (__builtin_ctz (neighbors) + 2) % 4;
+                Point adjPoint = World::nextNeighbor (xy, neighbors);
+                World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
+                uint cost = tile.bestCost + worldTile.cost;
+                if (!tryUpdateBestCost (m_bestPaths[worldTile.id], cost, back))
+                {
+                    continue;
+                }
+
+                if (adjPoint.x == end.x && adjPoint.y == end.y)
+                {
+                    // Nothing past the end is needed, only remember the cost
+                    uint best = pathCost.load ();
+                    while (cost < best && !pathCost.compare_exchange_weak (best, cost))
+                    {
+                    }
+                }
+                else
+                {
+                    uint combined = cost + heuristic (adjPoint.x, adjPoint.y);
+                    if (combined < pathCost.load ())
+                    {
+                        ++numPending;
+                        openTiles.push (combined, openTile_t {worldTile.id, cost});
+                    }
+                }
+            }
+        }
+        --numPending;
+    }
+}
+
+void registerParAStarSolvers (SolverRegistry& registry)
+{
+    // A thread count of 0 runs with one thread per core
+    registry.emplace<ParAStarSolver> ("parAStar", 0u);
+}
+
+} /* namespace pathFind */
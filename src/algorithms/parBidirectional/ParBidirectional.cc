@@ -1,152 +1,127 @@
 /**
  * File        : ParBidirectional.cc
- * Description : Implementation of the parallel bidirectional A* algorithm
- *               using a specified "world" from the worlds folder.
+ * Description : Implementation of the parallel bidirectional A* algorithm as
+ *               a solver for the SolverRegistry.
  */
 
-#include <iostream>
-#include <fstream>
-#include <sstream>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
-#include <cmath>
 #include <chrono>
-#include <thread>
 #include <mutex>
 
-#include <boost/lexical_cast.hpp>
-
 #include "algorithms/tools/PathTile.h"
+#include "algorithms/tools/Heuristics.h"
 #include "algorithms/tools/PriorityQueue.h"
-#include "common/Results.h"
+#include "algorithms/tools/SearchState.h"
+#include "algorithms/tools/WorkerPool.h"
+#include "algorithms/SolverRegistry.h"
 
-using namespace pathFind;
+namespace pathFind
+{
 
-const std::string WORLD_DIR = "../worlds";
-const std::string WORLD_EXT = ".world";
-const std::string PATH_EXT = ".path";
+class ParBidirectionalSolver : public Solver
+{
+public:
 
-const std::string ALG_NAME = "parBidir";
+    explicit ParBidirectionalSolver (const std::string& name);
 
-void search (uint startX, uint startY, uint endX, uint endY, std::unordered_set<uint>& tileIdsFound,
-             std::unordered_map<uint, PathTile>& expandedTiles,
-             pathFind::PathTile& tile, const pathFind::World& world,
-             std::mutex& m, bool& finished, bool& iFound
-#ifdef GEN_STATS
-             ,uint id
-#endif
-         );
+    uint getThreadsPerSearch (const solveOptions_t& options) const override;
 
-#ifdef GEN_STATS
-    std::vector<std::unordered_map<uint, StatPoint>> stats (2);
-#endif
+protected:
 
-int main (int args, char* argv[])
-{
-    // Program should be started with 5 command line parameters (or 1)
-    // that specifies the name of the world file to read from and then optionallys
-    // the start x, start y, end x, and end y
-    if (args != 6  && args != 2)
-    {
-        std::cout << "Incorrect inputs. Usage: <filename> (start x) (start y) (end x) (end y)" << std::endl;
-        return EXIT_FAILURE;
-    }
+    pathResult_t search (const World& world, const Point& start, const Point& end,
+                         const solveOptions_t& options) override;
 
-    // Parse the world file
-    std::stringstream filename;
-    filename << WORLD_DIR << "/" << argv[1] << WORLD_EXT;
+private:
 
-    std::ifstream worldFile (filename.str (),
-            std::ifstream::in | std::ifstream::binary);
+    // Searches from start towards end on its own thread until it reaches a
+    // tile the other direction already expanded
+    void searchDirection (uint startX, uint startY, uint endX, uint endY,
+                          std::unordered_set<tileId_t>& tileIdsFound,
+                          SearchState& searchState,
+                          pathFind::PathTile& tile, const pathFind::World& world,
+                          std::mutex& m, bool& finished, bool& iFound
+#ifdef GEN_STATS
+                          ,uint id
+#endif
+                         );
 
-    if (!worldFile)
-    {
-        std::cout << "World file doesn't exist." << std::endl;
-        return EXIT_FAILURE;
-    }
-    pathFind::World world;
+    // Tiles each direction touched, only used in builds with GEN_STATS
+    std::vector<std::unordered_map<tileId_t, StatPoint>> m_stats;
+};
 
-    worldFile >> world;
-    worldFile.close ();
+ParBidirectionalSolver::ParBidirectionalSolver (const std::string& name)
+    : Solver (name)
+{
+}
 
-    uint startX, startY, endX, endY;
+uint ParBidirectionalSolver::getThreadsPerSearch (const solveOptions_t&) const
+{
+    // One search from each end
+    return 2;
+}
 
-    if (args == 6)
-    {
-        // Parse the start and end points
-        try
-        {
-            startX = boost::lexical_cast<uint> (argv[2]);
-            startY = boost::lexical_cast<uint> (argv[3]);
-            endX = boost::lexical_cast<uint> (argv[4]);
-            endY = boost::lexical_cast<uint> (argv[5]);
-        } catch (boost::bad_lexical_cast &e)
-        {
-            std::cout << "Start and end points failed to convert to numeric types" << std::endl;
-            return EXIT_FAILURE;
-        }
-    }
-    else
-    {
-        std::stringstream pathFilename;
-        pathFilename << WORLD_DIR << "/" << argv[1] << PATH_EXT;
-        std::ifstream pathIn (pathFilename.str ());
-        if (!pathIn)
-        {
-            std::string pathCommand = "./pathGen " + std::string (argv[1]);
-            system (pathCommand.c_str());
-            pathIn.close ();
-            pathIn.open (pathFilename.str ());
-            if (!pathIn)
-            {
-                std::cout << "Could not construct path." << std::endl;
-                return EXIT_FAILURE;
-            }
-        }
-        pathIn >> startX >> startY >> endX >> endY;
+pathResult_t ParBidirectionalSolver::search (const World& world, const Point& start,
+                                             const Point& end, const solveOptions_t&)
+{
+    uint startX = start.x, startY = start.y, endX = end.x, endY = end.y;
 
-    }
+    pathResult_t result;
+    #ifdef GEN_STATS
+        m_stats.assign (2, std::unordered_map<tileId_t, StatPoint> ());
+    #endif
 
     auto t1 = std::chrono::high_resolution_clock::now();
 
     pathFind::PathTile fTile, rTile;
 
-    std::unordered_map<uint, PathTile> forwardExpandedTiles;
-    std::unordered_map<uint, PathTile> reverseExpandedTiles;
-    std::unordered_set<uint> idsFound;
+    SearchState forwardSearchState (world);
+    SearchState reverseSearchState (world);
+    std::unordered_set<tileId_t> idsFound;
     std::mutex m;
     bool finished = false;
     bool fFound = false;
     bool rFound = false;
 
-    std::thread forward (search, startX, startY, endX, endY, std::ref (idsFound),
-            std::ref(forwardExpandedTiles), std::ref(fTile), std::cref(world),
-            std::ref(m), std::ref(finished), std::ref(fFound)
+    WorkerPool::getShared ().run (2, [&] (uint id)
+    {
+        if (id == 0)
+        {
+            searchDirection (startX, startY, endX, endY, idsFound, forwardSearchState, fTile, world,
+                    m, finished, fFound
 #ifdef GEN_STATS
-            ,0
+                    ,0
 #endif
-        );
-    std::thread reverse (search, endX, endY, startX, startY, std::ref(idsFound),
-            std::ref(reverseExpandedTiles), std::ref(rTile), std::cref(world),
-            std::ref(m), std::ref(finished), std::ref(rFound)
+                );
+        }
+        else
+        {
+            searchDirection (endX, endY, startX, startY, idsFound, reverseSearchState, rTile, world,
+                    m, finished, rFound
 #ifdef GEN_STATS
-            ,1
+                    ,1
 #endif
-        );
-
-    forward.join ();
-    reverse.join ();
+                );
+        }
+    });
 
+    auto t2 = std::chrono::high_resolution_clock::now();
+    result.ms = std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count();
     if (fFound)
     {
-        rTile = reverseExpandedTiles.at (fTile.getTile ().id);
+        rTile = reverseSearchState.getPathTile (world, fTile.getTile ().id);
+    }
+    else if (rFound || (startX == endX && startY == endY))
+    {
+        fTile = forwardSearchState.getPathTile (world, rTile.getTile ().id);
     }
     else
     {
-        fTile = forwardExpandedTiles.at (rTile.getTile ().id);
+        // One direction ran out of tiles before they met
+        return result;
     }
-    auto t2 = std::chrono::high_resolution_clock::now();
 
     // Parse reverse results
     uint totalCost = 0;
@@ -155,56 +130,60 @@ int main (int args, char* argv[])
     {
         totalCost += rTile.getTile().cost;
         reversePath.emplace_back (rTile.xy ());
-        rTile = reverseExpandedTiles[(rTile.bestTile ().y * world.getWidth ()) + rTile.bestTile ().x];
+        rTile = reverseSearchState.getPathTile (world, world.getID (rTile.bestTile ().x, rTile.bestTile ().y));
     }
     reversePath.emplace_back (rTile.xy ());
 
     std::vector<Point> finalPath (reversePath.rbegin (), reversePath.rend ());
     while (fTile.xy ().x != startX || fTile.xy ().y != startY)
     {
-        fTile = forwardExpandedTiles[(fTile.bestTile ().y * world.getWidth()) + fTile.bestTile ().x];
+        fTile = forwardSearchState.getPathTile (world, world.getID (fTile.bestTile ().x, fTile.bestTile ().y));
         totalCost += fTile.getTile().cost;
         finalPath.emplace_back(fTile.xy ());
     }
     totalCost -= fTile.getTile().cost;
 
+    result.found = true;
+    result.path = std::move (finalPath);
+    result.totalCost = totalCost;
     #ifdef GEN_STATS
-        writeResults (finalPath, stats, argv[1], ALG_NAME,
-                std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count(), totalCost);
-    #else
-        writeResults (finalPath, argv[1], ALG_NAME,
-                std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count(), totalCost);
+        result.stats = std::move (m_stats);
     #endif
-
-    return EXIT_SUCCESS;
+    return result;
 }
 
-void search (uint startX, uint startY, uint endX, uint endY, std::unordered_set<uint>& tileIdsFound,
-             std::unordered_map<uint, PathTile>& expandedTiles,
-             pathFind::PathTile& tile, const pathFind::World& world,
-             std::mutex& m, bool& finished, bool& iFound
+void ParBidirectionalSolver::searchDirection (uint startX, uint startY, uint endX, uint endY,
+                                              std::unordered_set<tileId_t>& tileIdsFound,
+                                              SearchState& searchState,
+                                              pathFind::PathTile& tile, const pathFind::World& world,
+                                              std::mutex& m, bool& finished, bool& iFound
 #ifdef GEN_STATS
-             ,uint id
+                                              ,uint id
 #endif
-         )
+                                             )
 {
-    PriorityQueue openTiles (world.getWidth (), world.getHeight (), [endX, endY] (uint x, uint y)
-    {
-        return  (x < endX ? endX - x : x - endX) +
-                (y < endY ? endY - y : y - endY);
-    });
+    PriorityQueue<ManhattanHeuristic> openTiles (world.getWidth (), world.getHeight (),
+                                                 ManhattanHeuristic (endX, endY));
 
     openTiles.push (world (startX, startY), {startX, startY}, 0);
     #ifdef GEN_STATS
-        stats[id][world (startX, startY).id] = StatPoint {startX, startY};
+        m_stats[id][world (startX, startY).id] = StatPoint {startX, startY};
     #endif
 
     tile = openTiles.top ();
 
-    expandedTiles[tile.getTile().id] = tile;
+    searchState.close (world, tile);
 
     while (tile.xy ().x != endX || tile.xy ().y != endY)
     {
+        if (openTiles.empty ())
+        {
+            // The ends aren't connected, stop the other direction as well
+            m.lock ();
+            finished = true;
+            m.unlock ();
+            break;
+        }
         tile = openTiles.top ();
 
         m.lock ();
@@ -224,7 +203,7 @@ void search (uint startX, uint startY, uint endX, uint endY, std::unordered_set<
         tileIdsFound.insert(tile.getTile().id);
         m.unlock ();
 
-        expandedTiles[tile.getTile ().id] = tile;
+        searchState.close (world, tile);
         openTiles.pop ();
 
         // Check each neighbor
@@ -233,14 +212,14 @@ void search (uint startX, uint startY, uint endX, uint endY, std::unordered_set<
         {
             World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
             if (worldTile.cost != 0 &&
-                expandedTiles.find (worldTile.id) == expandedTiles.end ())
+                !searchState.isClosed (worldTile.id))
             {
                 openTiles.tryUpdateBestCost (worldTile, adjPoint, tile);
                 #ifdef GEN_STATS
-                    auto statIter = stats[id].find (worldTile.id);
-                    if (statIter == stats[id].end ())
+                    auto statIter = m_stats[id].find (worldTile.id);
+                    if (statIter == m_stats[id].end ())
                     {
-                        stats[id][worldTile.id] = StatPoint {adjPoint.x, adjPoint.y};
+                        m_stats[id][worldTile.id] = StatPoint {adjPoint.x, adjPoint.y};
                     }
                     else
                     {
@@ -255,14 +234,14 @@ void search (uint startX, uint startY, uint endX, uint endY, std::unordered_set<
         {
             World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
             if (worldTile.cost != 0 &&
-                expandedTiles.find (worldTile.id) == expandedTiles.end ())
+                !searchState.isClosed (worldTile.id))
             {
                 openTiles.tryUpdateBestCost (worldTile, adjPoint, tile);
                 #ifdef GEN_STATS
-                    auto statIter = stats[id].find (worldTile.id);
-                    if (statIter == stats[id].end ())
+                    auto statIter = m_stats[id].find (worldTile.id);
+                    if (statIter == m_stats[id].end ())
                     {
-                        stats[id][worldTile.id] = StatPoint {adjPoint.x, adjPoint.y};
+                        m_stats[id][worldTile.id] = StatPoint {adjPoint.x, adjPoint.y};
                     }
                     else
                     {
@@ -277,14 +256,14 @@ void search (uint startX, uint startY, uint endX, uint endY, std::unordered_set<
         {
             World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
             if (worldTile.cost != 0 &&
-                expandedTiles.find (worldTile.id) == expandedTiles.end ())
+                !searchState.isClosed (worldTile.id))
             {
                 openTiles.tryUpdateBestCost (worldTile, adjPoint, tile);
                 #ifdef GEN_STATS
-                    auto statIter = stats[id].find (worldTile.id);
-                    if (statIter == stats[id].end ())
+                    auto statIter = m_stats[id].find (worldTile.id);
+                    if (statIter == m_stats[id].end ())
                     {
-                        stats[id][worldTile.id] = StatPoint {adjPoint.x, adjPoint.y};
+                        m_stats[id][worldTile.id] = StatPoint {adjPoint.x, adjPoint.y};
                     }
                     else
                     {
@@ -299,14 +278,14 @@ void search (uint startX, uint startY, uint endX, uint endY, std::unordered_set<
         {
             World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
             if (worldTile.cost != 0 &&
-                expandedTiles.find (worldTile.id) == expandedTiles.end ())
+                !searchState.isClosed (worldTile.id))
             {
                 openTiles.tryUpdateBestCost (worldTile, adjPoint, tile);
                 #ifdef GEN_STATS
-                    auto statIter = stats[id].find (worldTile.id);
-                    if (statIter == stats[id].end ())
+                    auto statIter = m_stats[id].find (worldTile.id);
+                    if (statIter == m_stats[id].end ())
                     {
-                        stats[id][worldTile.id] = StatPoint {adjPoint.x, adjPoint.y};
+                        m_stats[id][worldTile.id] = StatPoint {adjPoint.x, adjPoint.y};
                     }
                     else
                     {
@@ -317,3 +296,10 @@ void search (uint startX, uint startY, uint endX, uint endY, std::unordered_set<
         }
     }
 }
+
+void registerParBidirectionalSolvers (SolverRegistry& registry)
+{
+    registry.emplace<ParBidirectionalSolver> ("parBidir");
+}
+
+} /* namespace pathFind */
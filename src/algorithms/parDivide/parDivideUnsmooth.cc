@@ -9,121 +9,93 @@
  *               non-optimal spots
  */
 
-#include <iostream>
-#include <fstream>
-#include <sstream>
+#include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 #include <limits>
 #include <cmath>
 #include <chrono>
-#include <thread>
 #include <mutex>
 
-#include <boost/lexical_cast.hpp>
-
 #include "tbb/concurrent_unordered_map.h"
 #include "tbb/concurrent_vector.h"
 
 #include "algorithms/tools/PathTile.h"
+#include "algorithms/tools/Heuristics.h"
 #include "algorithms/tools/PriorityQueue.h"
-#include "common/Results.h"
+#include "algorithms/tools/WorkerPool.h"
+#include "algorithms/SolverRegistry.h"
 
-using namespace pathFind;
+namespace pathFind
+{
 
-const std::string WORLD_DIR = "worlds";
-const std::string WORLD_EXT = ".world";
-const std::string PATH_EXT = ".path";
+class ParDivideUnsmoothSolver : public Solver
+{
+public:
 
-const std::string ALG_NAME = "parDivideUnsmooth_" + std::to_string (NUMBER_OF_THREADS);
+    ParDivideUnsmoothSolver (const std::string& name, uint numThreads);
 
-const uint numThreads = NUMBER_OF_THREADS;
+    bool isParallel () const override;
+    uint getThreadsPerSearch (const solveOptions_t& options) const override;
 
-Point findStart (const World& world, uint numThreadsLeft, const Point& start, const Point& end);
+protected:
 
-void search (uint id, const Point& start, const Point& predEnd, const Point& succEnd,
-             tbb::concurrent_unordered_map<uint, uint>& tileIdsFound,
-             std::unordered_map<uint, PathTile>& expandedTiles,
-             std::vector<Point>& meetingTiles, tbb::concurrent_vector<std::pair<bool, uint>>& meetingTilesFound,
-             const pathFind::World& world, std::mutex& m);
+    pathResult_t search (const World& world, const Point& start, const Point& end,
+                         const solveOptions_t& options) override;
 
-void searchNeighbor (const Point& adjPoint, const World& world, const PathTile& tile,
-    PriorityQueue& openTiles, const std::unordered_map<uint, PathTile>& expandedTiles
-#ifdef GEN_STATS
-    , uint id
-#endif
-    );
+private:
 
-#ifdef GEN_STATS
-    std::vector<std::unordered_map<uint, StatPoint>> stats (numThreads);
-#endif
+    typedef PriorityQueue<NearestManhattanHeuristic> OpenList;
 
-int main (int args, char* argv[])
-{
-    // Program should be started with 5 command line parameters (or 1)
-    // that specifies the name of the world file to read from and then optionallys
-    // the start x, start y, end x, and end y
-    if (args != 6  && args != 2)
-    {
-        std::cout << "Incorrect inputs. Usage: <filename> (start x) (start y) (end x) (end y)" << std::endl;
-        return EXIT_FAILURE;
-    }
+    static Point findStart (const World& world, uint numThreadsLeft, const Point& start, const Point& end);
 
-    // Parse the world file
-    std::stringstream filename;
-    filename << WORLD_DIR << "/" << argv[1] << WORLD_EXT;
+    void searchThread (uint id, const Point& start, const Point& predEnd, const Point& succEnd,
+                 tbb::concurrent_unordered_map<tileId_t, uint>& tileIdsFound,
+                 std::unordered_map<tileId_t, PathTile>& expandedTiles,
+                 std::vector<Point>& meetingTiles, tbb::concurrent_vector<std::pair<bool, uint>>& meetingTilesFound,
+                 const pathFind::World& world, std::mutex& m);
 
-    std::ifstream worldFile (filename.str (),
-            std::ifstream::in | std::ifstream::binary);
+    void searchNeighbor (const Point& adjPoint, const World& world, const PathTile& tile,
+        OpenList& openTiles, const std::unordered_map<tileId_t, PathTile>& expandedTiles
+    #ifdef GEN_STATS
+        , uint id
+    #endif
+        );
 
-    if (!worldFile)
-    {
-        std::cout << "World file doesn't exist." << std::endl;
-        return EXIT_FAILURE;
-    }
-    pathFind::World world;
+    uint m_numThreads;
+    // Tiles each thread touched, only used in builds with GEN_STATS
+    std::vector<std::unordered_map<tileId_t, StatPoint>> m_stats;
+};
 
-    worldFile >> world;
-    worldFile.close ();
+ParDivideUnsmoothSolver::ParDivideUnsmoothSolver (const std::string& name, uint numThreads)
+    : Solver (name),
+      m_numThreads (numThreads)
+{
+}
 
-    uint startX, startY, endX, endY;
+bool ParDivideUnsmoothSolver::isParallel () const
+{
+    return true;
+}
 
-    if (args == 6)
-    {
-        // Parse the start and end points
-        try
-        {
-            startX = boost::lexical_cast<uint> (argv[2]);
-            startY = boost::lexical_cast<uint> (argv[3]);
-            endX = boost::lexical_cast<uint> (argv[4]);
-            endY = boost::lexical_cast<uint> (argv[5]);
-        } catch (boost::bad_lexical_cast &e)
-        {
-            std::cout << "Start and end points failed to convert to numeric types" << std::endl;
-            return EXIT_FAILURE;
-        }
-    }
-    else
-    {
-        std::stringstream pathFilename;
-        pathFilename << WORLD_DIR << "/" << argv[1] << PATH_EXT;
-        std::ifstream pathIn (pathFilename.str ());
-        if (!pathIn)
-        {
-            std::string pathCommand = "./pathGen " + std::string (argv[1]);
-            system (pathCommand.c_str());
-            pathIn.close ();
-            pathIn.open (pathFilename.str ());
-            if (!pathIn)
-            {
-                std::cout << "Could not construct path." << std::endl;
-                return EXIT_FAILURE;
-            }
-        }
-        pathIn >> startX >> startY >> endX >> endY;
+uint ParDivideUnsmoothSolver::getThreadsPerSearch (const solveOptions_t& options) const
+{
+    // The path is divided between searches from both of its ends at least
+    return std::max (getNumThreads (options, m_numThreads), 2u);
+}
 
-    }
+pathResult_t ParDivideUnsmoothSolver::search (const World& world, const Point& start, const Point& end,
+                                              const solveOptions_t& options)
+{
+    uint startX = start.x, startY = start.y, endX = end.x, endY = end.y;
+    uint numThreads = getThreadsPerSearch (options);
+
+    pathResult_t result;
+    #ifdef GEN_STATS
+        m_stats.assign (numThreads, std::unordered_map<tileId_t, StatPoint> ());
+    #endif
 
     auto t1 = std::chrono::high_resolution_clock::now();
 
@@ -149,24 +121,36 @@ int main (int args, char* argv[])
 
     pathFind::PathTile fTile, rTile;
 
-    std::vector<std::unordered_map<uint, PathTile>> expandedTiles (numThreads);
-    tbb::concurrent_unordered_map<uint, uint> idsFound;
+    std::vector<std::unordered_map<tileId_t, PathTile>> expandedTiles (numThreads);
+    tbb::concurrent_unordered_map<tileId_t, uint> idsFound;
     std::vector<Point> meetingTiles (numThreads + 1);
     tbb::concurrent_vector<std::pair<bool, uint>> meetingTilesFound (numThreads + 1);
     std::mutex m;
 
-    std::vector<std::thread> threads (numThreads);
-    for (uint i = 0; i < numThreads; ++i)
+    WorkerPool::getShared ().run (numThreads, [&] (uint i)
     {
-        threads[i] = std::thread (search, i, std::cref(startPoints[i]), std::cref((i == 0) ? startPoints[0] : startPoints[i - 1]),
-                std::cref((i == numThreads - 1) ? startPoints[i] : startPoints[i + 1]), std::ref (idsFound), std::ref(expandedTiles[i]),
-                std::ref(meetingTiles), std::ref (meetingTilesFound),
-                std::cref(world), std::ref(m));
-    }
+        searchThread (i, startPoints[i], (i == 0) ? startPoints[0] : startPoints[i - 1],
+                (i == numThreads - 1) ? startPoints[i] : startPoints[i + 1], idsFound, expandedTiles[i],
+                meetingTiles, meetingTilesFound,
+                world, m);
+    });
 
-    for (auto& t : threads)
+    bool allMet = std::all_of (meetingTilesFound.begin (), meetingTilesFound.end (),
+                               [] (const std::pair<bool, uint>& met) { return met.first; });
+    if (!allMet)
     {
-        t.join ();
+        auto t2 = std::chrono::high_resolution_clock::now();
+        uint ms = std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count();
+        if (numThreads > 2)
+        {
+            // A thread may have started in a pocket the path doesn't go
+            // through, only searching from both ends tells if there is one
+            solveOptions_t bothEnds = options;
+            bothEnds.numThreads = 2;
+            result = search (world, start, end, bothEnds);
+        }
+        result.ms += ms;
+        return result;
     }
 
     auto t2 = std::chrono::high_resolution_clock::now();
@@ -204,18 +188,17 @@ int main (int args, char* argv[])
     }
     totalCost -= world (startX, startY).cost;
 
+    result.found = true;
+    result.path = std::move (finalPath);
+    result.totalCost = totalCost;
+    result.ms = std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count();
     #ifdef GEN_STATS
-        writeResults (finalPath, stats, argv[1], ALG_NAME,
-                std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count(), totalCost);
-    #else
-        writeResults (finalPath, argv[1], ALG_NAME,
-                std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count(), totalCost);
+        result.stats = std::move (m_stats);
     #endif
-
-    return EXIT_SUCCESS;
+    return result;
 }
 
-Point findStart (const World& world, uint numThreadsLeft, const Point& start, const Point& end)
+Point ParDivideUnsmoothSolver::findStart (const World& world, uint numThreadsLeft, const Point& start, const Point& end)
 {
     if (start.x == end.x && start.y == end.y)
     {
@@ -290,24 +273,23 @@ Point findStart (const World& world, uint numThreadsLeft, const Point& start, co
     return (world (forward.x, forward.y).cost == 0) ? backward : forward;
 }
 
-void search (uint id, const Point& start, const Point& predEnd, const Point& succEnd,
-             tbb::concurrent_unordered_map<uint, uint>& tileIdsFound,
-             std::unordered_map<uint, PathTile>& expandedTiles,
+void ParDivideUnsmoothSolver::searchThread (uint id, const Point& start, const Point& predEnd, const Point& succEnd,
+             tbb::concurrent_unordered_map<tileId_t, uint>& tileIdsFound,
+             std::unordered_map<tileId_t, PathTile>& expandedTiles,
              std::vector<Point>& meetingTiles, tbb::concurrent_vector<std::pair<bool, uint>>& meetingTilesFound,
              const pathFind::World& world, std::mutex& m)
 {
-    PriorityQueue openTiles (world.getWidth (), world.getHeight (), [predEnd, succEnd] (uint x, uint y)
-    {
-        return  std::min ((x < predEnd.x ? predEnd.x - x : x - predEnd.x) + (y < predEnd.y ? predEnd.y - y : y - predEnd.y),
-            (x < succEnd.x ? succEnd.x - x : x - succEnd.x) + (y < succEnd.y ? succEnd.y - y : y - succEnd.y));
-    });
+    // Head for whichever of the two neighbouring threads' starts is closer
+    OpenList openTiles (world.getWidth (), world.getHeight (),
+                        NearestManhattanHeuristic (predEnd, succEnd));
     openTiles.push (world (start.x, start.y), {start.x, start.y}, 0);
 
     expandedTiles[openTiles.top ().getTile().id] = openTiles.top ();
 
     // Used to determine the "farthest" thread that we have met
     // uint predIdMet = id, succIdMet = id;
-    while (!meetingTilesFound[id].first || !meetingTilesFound[id + 1].first)
+    // Ends with the open list when the neighbouring threads can't be reached
+    while ((!meetingTilesFound[id].first || !meetingTilesFound[id + 1].first) && !openTiles.empty ())
     {
         PathTile tile = openTiles.top ();
         openTiles.pop ();
@@ -385,8 +367,8 @@ void search (uint id, const Point& start, const Point& predEnd, const Point& suc
     }
 }
 
-void searchNeighbor (const Point& adjPoint, const World& world, const PathTile& tile,
-    PriorityQueue& openTiles, const std::unordered_map<uint, PathTile>& expandedTiles
+void ParDivideUnsmoothSolver::searchNeighbor (const Point& adjPoint, const World& world, const PathTile& tile,
+    OpenList& openTiles, const std::unordered_map<tileId_t, PathTile>& expandedTiles
 #ifdef GEN_STATS
     , uint id
 #endif
@@ -400,10 +382,10 @@ void searchNeighbor (const Point& adjPoint, const World& world, const PathTile&
         {
             openTiles.tryUpdateBestCost (worldTile, adjPoint, tile);
             #ifdef GEN_STATS
-                auto statIter = stats[id].find (worldTile.id);
-                if (statIter == stats[id].end ())
+                auto statIter = m_stats[id].find (worldTile.id);
+                if (statIter == m_stats[id].end ())
                 {
-                    stats[id][worldTile.id] = StatPoint {adjPoint.x, adjPoint.y};
+                    m_stats[id][worldTile.id] = StatPoint {adjPoint.x, adjPoint.y};
                 }
                 else
                 {
@@ -413,3 +395,11 @@ void searchNeighbor (const Point& adjPoint, const World& world, const PathTile&
         }
     }
 }
+
+void registerParDivideUnsmoothSolvers (SolverRegistry& registry)
+{
+    // A thread count of 0 runs with one thread per core
+    registry.emplace<ParDivideUnsmoothSolver> ("parDivideUnsmooth", 0u);
+}
+
+} /* namespace pathFind */
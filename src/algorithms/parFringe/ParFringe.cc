@@ -1,150 +1,115 @@
 /**
  * File        : ParFringe.cc
- * Description : Implementation of the parallel fringe algorithm using a
- *               specified "world" from the worlds folder.
+ * Description : Implementation of the parallel fringe algorithm as a solver
+ *               for the SolverRegistry.
  */
 
-#include <iostream>
-#include <fstream>
-#include <sstream>
+#include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
 #include <list>
+#include <utility>
 #include <vector>
 #include <deque>
 #include <cmath>
 #include <chrono>
-#include <thread>
 #include <mutex>
 
-#include <boost/lexical_cast.hpp>
 #include <boost/thread/barrier.hpp>
 
 #include "tbb/concurrent_unordered_map.h"
 
 #include "algorithms/tools/PathTile.h"
-#include "common/Results.h"
+#include "algorithms/tools/WorkerPool.h"
+#include "algorithms/SolverRegistry.h"
 
-using namespace pathFind;
-
-const std::string WORLD_DIR = "../worlds";
-const std::string WORLD_EXT = ".world";
-const std::string PATH_EXT = ".path";
-
-#ifndef OPTIMAL
-    #ifdef THRESHOLD_FACTOR
-        const std::string ALG_NAME = "parFringe_" + std::to_string(NUMBER_OF_THREADS);
-                //+ "_" + std::to_string(THRESHOLD_FACTOR).substr (0,4);
-    #else
-        const std::string ALG_NAME = "parFringe_" + std::to_string(NUMBER_OF_THREADS);
-    #endif
-#else
-    const std::string ALG_NAME = "parFringe_optimal";
-#endif
-
-const uint numThreads = NUMBER_OF_THREADS;
-
-#ifdef GEN_STATS
-    std::vector<std::unordered_map<uint, StatPoint>> stats (numThreads);
-#endif
-
-uint
-heuristic (uint x, uint y, uint endX, uint endY);
-
-/*
-void search (uint id, uint numThreads, uint startX, uint startY, uint endX, uint endY,
-             std::vector<PathTile>& now, std::vector<std::vector<PathTile>>& later,
-             tbb::concurrent_unordered_map<uint, PathTile>& closedTiles,
-             std::vector<std::unordered_map<uint, PathTile>>& seen,
-             std::vector<uint>& mins, uint threshold, const pathFind::World& world,
-             bool& finished, std::mutex& finishedLock, boost::barrier& syncPoint);
-*/
-void search (uint id, uint endX, uint endY,
-             /*std::deque<PathTile>& now,*/ std::vector<std::deque<PathTile>>& localNow,
-             std::vector<std::deque<PathTile>>& later,
-             tbb::concurrent_unordered_map<uint, bool>& closedTiles,
-             std::vector<std::unordered_map<uint, PathTile>>& seen,
-             uint threshold, const pathFind::World& world,
-             bool& finished, std::mutex& finishedLock, boost::barrier& syncPoint
-#ifdef OPTIMAL
-            ,std::vector<uint>& mins
-#endif
-         );
-
- void
- searchNeighbor(const Point& adjPoint, uint id, uint threshold, const PathTile& current, const World& world, uint endX, uint endY,
- 		 tbb::concurrent_unordered_map<uint, bool>& closedTiles, std::vector<std::unordered_map<uint, PathTile>>& seen,
- 		 std::vector<std::deque<PathTile>>& later, std::vector<std::deque<PathTile>>& localNow
-#ifdef OPTIMAL
-         ,std::vector<uint>& mins
+// How far the threshold is raised after each pass when the solver is not
+// optimal
+#ifndef THRESHOLD_FACTOR
+    #define THRESHOLD_FACTOR 1
 #endif
-     );
 
-int main (int args, char* argv[])
+namespace pathFind
 {
-    // Program should be started with 5 command line parameters (or 1)
-    // that specifies the name of the world file to read from and then optionallys
-    // the start x, start y, end x, and end y
-    if (args != 6  && args != 2)
-    {
-        std::cout << "Incorrect inputs. Usage: <filename> (start x) (start y) (end x) (end y)" << std::endl;
-        return EXIT_FAILURE;
-    }
-
-    // Parse the world file
-    std::stringstream filename;
-    filename << WORLD_DIR << "/" << argv[1] << WORLD_EXT;
-
-    std::ifstream worldFile (filename.str (),
-            std::ifstream::in | std::ifstream::binary);
 
-    if (!worldFile)
-    {
-        std::cout << "World file doesn't exist." << std::endl;
-        return EXIT_FAILURE;
-    }
-    pathFind::World world;
+class ParFringeSolver : public Solver
+{
+public:
+
+    // An optimal solver raises the threshold to the smallest estimate that
+    // went over it instead of by THRESHOLD_FACTOR, which keeps the path
+    // optimal at the cost of more passes
+    ParFringeSolver (const std::string& name, uint numThreads, bool optimal);
+
+    bool isParallel () const override;
+    uint getThreadsPerSearch (const solveOptions_t& options) const override;
+
+protected:
+
+    pathResult_t search (const World& world, const Point& start, const Point& end,
+                         const solveOptions_t& options) override;
+
+private:
+
+    static uint
+    heuristic (uint x, uint y, uint endX, uint endY);
+
+    /*
+    void search (uint id, uint numThreads, uint startX, uint startY, uint endX, uint endY,
+                 std::vector<PathTile>& now, std::vector<std::vector<PathTile>>& later,
+                 tbb::concurrent_unordered_map<tileId_t, PathTile>& closedTiles,
+                 std::vector<std::unordered_map<tileId_t, PathTile>>& seen,
+                 std::vector<uint>& mins, uint threshold, const pathFind::World& world,
+                 bool& finished, std::mutex& finishedLock, boost::barrier& syncPoint);
+    */
+    void searchThread (uint id, uint endX, uint endY,
+                 /*std::deque<PathTile>& now,*/ std::vector<std::deque<PathTile>>& localNow,
+                 std::vector<std::deque<PathTile>>& later,
+                 tbb::concurrent_unordered_map<tileId_t, bool>& closedTiles,
+                 std::vector<std::unordered_map<tileId_t, PathTile>>& seen,
+                 uint threshold, const pathFind::World& world,
+                 bool& finished, bool& exhausted, std::mutex& finishedLock, boost::barrier& syncPoint,
+                 std::vector<uint>& mins);
+
+    void
+    searchNeighbor(const Point& adjPoint, uint id, uint threshold, const PathTile& current, const World& world, uint endX, uint endY,
+             tbb::concurrent_unordered_map<tileId_t, bool>& closedTiles, std::vector<std::unordered_map<tileId_t, PathTile>>& seen,
+             std::vector<std::deque<PathTile>>& later, std::vector<std::deque<PathTile>>& localNow,
+             std::vector<uint>& mins);
+
+    uint m_numThreads;
+    bool m_optimal;
+    // Tiles each thread expanded, only used in builds with GEN_STATS
+    std::vector<std::unordered_map<tileId_t, StatPoint>> m_stats;
+};
+
+ParFringeSolver::ParFringeSolver (const std::string& name, uint numThreads, bool optimal)
+    : Solver (name),
+      m_numThreads (numThreads),
+      m_optimal (optimal)
+{
+}
 
-    worldFile >> world;
-    worldFile.close ();
+bool ParFringeSolver::isParallel () const
+{
+    return true;
+}
 
-    uint startX, startY, endX, endY;
+uint ParFringeSolver::getThreadsPerSearch (const solveOptions_t& options) const
+{
+    return getNumThreads (options, m_numThreads);
+}
 
-    if (args == 6)
-    {
-        // Parse the start and end points
-        try
-        {
-            startX = boost::lexical_cast<uint> (argv[2]);
-            startY = boost::lexical_cast<uint> (argv[3]);
-            endX = boost::lexical_cast<uint> (argv[4]);
-            endY = boost::lexical_cast<uint> (argv[5]);
-        } catch (boost::bad_lexical_cast &e)
-        {
-            std::cout << "Start and end points failed to convert to numeric types" << std::endl;
-            return EXIT_FAILURE;
-        }
-    }
-    else
-    {
-        std::stringstream pathFilename;
-        pathFilename << WORLD_DIR << "/" << argv[1] << PATH_EXT;
-        std::ifstream pathIn (pathFilename.str ());
-        if (!pathIn)
-        {
-            std::string pathCommand = "./pathGen " + std::string (argv[1]);
-            system (pathCommand.c_str());
-            pathIn.close ();
-            pathIn.open (pathFilename.str ());
-            if (!pathIn)
-            {
-                std::cout << "Could not construct path." << std::endl;
-                return EXIT_FAILURE;
-            }
-        }
-        pathIn >> startX >> startY >> endX >> endY;
+pathResult_t ParFringeSolver::search (const World& world, const Point& start, const Point& end,
+                                      const solveOptions_t& options)
+{
+    uint startX = start.x, startY = start.y, endX = end.x, endY = end.y;
+    uint numThreads = getThreadsPerSearch (options);
 
-    }
+    pathResult_t result;
+    #ifdef GEN_STATS
+        m_stats.assign (numThreads, std::unordered_map<tileId_t, StatPoint> ());
+    #endif
 
     auto t1 = std::chrono::high_resolution_clock::now();
 
@@ -158,32 +123,26 @@ int main (int args, char* argv[])
                         Point {startX, startY}, 0, startHeuristic);
 
     std::vector<std::deque<PathTile>> later (numThreads);
-    std::vector<std::unordered_map<uint, PathTile>> seen (numThreads);
+    std::vector<std::unordered_map<tileId_t, PathTile>> seen (numThreads);
     std::vector<uint> mins (numThreads);
-    tbb::concurrent_unordered_map<uint, bool> closedTiles;
+    tbb::concurrent_unordered_map<tileId_t, bool> closedTiles;
 
     boost::barrier syncPoint (numThreads);
     std::mutex finishedLock;
     bool finished = false;
+    bool exhausted = false;
 
-    std::vector<std::thread> threads(numThreads);
-    for (uint i = 0; i < numThreads; ++i)
+    WorkerPool::getShared ().run (numThreads, [&] (uint i)
     {
-    	threads[i] = std::thread (search, i, endX, endY, std::ref (localNow), //std::ref(now),
-    			std::ref(later), std::ref(closedTiles), std::ref (seen), startHeuristic,
-    			std::cref(world), std::ref(finished), std::ref (finishedLock), std::ref(syncPoint)
-#ifdef OPTIMAL
-            ,std::ref(mins)
-#endif
-            );
-    }
-
-    for (auto& t : threads)
-    {
-    	t.join ();
-    }
+    	searchThread (i, endX, endY,
+    			localNow, //now,
+    			later, closedTiles, seen, startHeuristic,
+    			world, finished, exhausted, finishedLock, syncPoint,
+    			mins);
+    });
 
     auto t2 = std::chrono::high_resolution_clock::now();
+    result.ms = std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count();
 
     PathTile endTile;
 
@@ -199,8 +158,7 @@ int main (int args, char* argv[])
     }
     if (!found)
     {
-    	std::cout << "ERROR\n";
-    	return EXIT_FAILURE;
+    	return result;
     }
 
     // Parse reverse results
@@ -221,61 +179,55 @@ int main (int args, char* argv[])
         }
         if (!found)
         {
-            std::cout << "ERROR\n";
+            // The chain of best tiles is broken, which leaves no path to report
+            return result;
         }
     }
     finalPath.emplace_back(endTile.xy ());
 
+    result.found = true;
+    result.path = std::move (finalPath);
+    result.totalCost = totalCost;
     #ifdef GEN_STATS
-        writeResults (finalPath, stats, argv[1], ALG_NAME,
-                std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count(), totalCost);
-    #else
-        writeResults (finalPath, argv[1], ALG_NAME,
-                std::chrono::duration_cast<std::chrono::milliseconds>(t2-t1).count(), totalCost);
+        result.stats = std::move (m_stats);
     #endif
-
-    return EXIT_SUCCESS;
+    return result;
 }
 
 uint
-heuristic (uint x, uint y, uint endX, uint endY)
+ParFringeSolver::heuristic (uint x, uint y, uint endX, uint endY)
 {
     return  (x < endX ? endX - x : x - endX) +
             (y < endY ? endY - y : y - endY);
 }
 
-void search (uint id, uint endX, uint endY,
+void ParFringeSolver::searchThread (uint id, uint endX, uint endY,
              /*std::deque<PathTile>& now,*/ std::vector<std::deque<PathTile>>& localNow,
              std::vector<std::deque<PathTile>>& later,
-             tbb::concurrent_unordered_map<uint, bool>& closedTiles,
-             std::vector<std::unordered_map<uint, PathTile>>& seen,
+             tbb::concurrent_unordered_map<tileId_t, bool>& closedTiles,
+             std::vector<std::unordered_map<tileId_t, PathTile>>& seen,
              uint threshold, const pathFind::World& world,
-             bool& finished, std::mutex& finishedLock, boost::barrier& syncPoint
-#ifdef OPTIMAL
-            ,std::vector<uint>& mins
-#endif
-         )
+             bool& finished, bool& exhausted, std::mutex& finishedLock, boost::barrier& syncPoint,
+             std::vector<uint>& mins)
 {
-    #ifndef THRESHOLD_FACTOR
-    #define THRESHOLD_FACTOR 1
-    #endif
-
+    uint numThreads = localNow.size ();
     bool found = false;
 
     while (!found)
     {
-        #ifdef OPTIMAL
+        if (m_optimal)
+        {
             mins[id] = PathTile::INF;
-        #endif
+        }
         while (!localNow[id].empty ())
         {
             PathTile current = localNow[id].front();
             localNow[id].pop_front ();
             #ifdef GEN_STATS
-                auto statIter = stats[id].find (current.getTile ().id);
-                if (statIter == stats[id].end ())
+                auto statIter = m_stats[id].find (current.getTile ().id);
+                if (statIter == m_stats[id].end ())
                 {
-                    stats[id][current.getTile ().id] = StatPoint {current.xy ().x, current.xy ().y};
+                    m_stats[id][current.getTile ().id] = StatPoint {current.xy ().x, current.xy ().y};
                 }
                 else
                 {
@@ -291,9 +243,10 @@ void search (uint id, uint endX, uint endY,
 
             if (current.getCombinedHeuristic () > threshold)
             {
-                #ifdef OPTIMAL
+                if (m_optimal)
+                {
                     mins[id] = std::min(current.getCombinedHeuristic (), mins[id]);
-                #endif
+                }
                 later[id].push_back(current);
                 continue;
             }
@@ -306,33 +259,14 @@ void search (uint id, uint endX, uint endY,
                 break;
             }
 
-            Point adjPoint {current.xy ().x + 1, current.xy ().y}; // east
-            searchNeighbor (adjPoint, id, threshold, current, world, endX, endY, closedTiles, seen, later, localNow
-            #ifdef OPTIMAL
-                ,mins
-            #endif
-            );
-
-            adjPoint = {current.xy ().x, current.xy ().y + 1}; // south
-            searchNeighbor (adjPoint, id, threshold, current, world, endX, endY, closedTiles, seen, later, localNow
-            #ifdef OPTIMAL
-                ,mins
-            #endif
-            );
-
-            adjPoint = {current.xy ().x - 1, current.xy ().y}; // west
-            searchNeighbor (adjPoint, id, threshold, current, world, endX, endY, closedTiles, seen, later, localNow
-            #ifdef OPTIMAL
-                ,mins
-            #endif
-            );
-
-            adjPoint = {current.xy ().x, current.xy ().y - 1}; // north
-            searchNeighbor (adjPoint, id, threshold, current, world, endX, endY, closedTiles, seen, later, localNow
-            #ifdef OPTIMAL
-                ,mins
-            #endif
-            );
+            // East, south, west then north, skipping walls and the world's edge
+            uint neighbors = world.getNeighborMask (current.xy ().x, current.xy ().y);
+            while (neighbors != 0)
+            {
+                Point adjPoint = World::nextNeighbor (current.xy (), neighbors);
+                searchNeighbor (adjPoint, id, threshold, current, world, endX, endY, closedTiles, seen, later, localNow,
+                    mins);
+            }
         }
 
         syncPoint.wait();
@@ -344,6 +278,9 @@ void search (uint id, uint endX, uint endY,
         {
             if (id == 0)
             {
+                // Nothing is left to search if no tile went over the threshold
+                exhausted = std::all_of (later.begin (), later.end (),
+                                         [] (const std::deque<PathTile>& tiles) { return tiles.empty (); });
           	// Merge the later lists into the now list
                 //now.clear ();
                 uint idx = 0;
@@ -365,7 +302,8 @@ void search (uint id, uint endX, uint endY,
                 }
             }
 
-            #ifdef OPTIMAL
+            if (m_optimal)
+            {
                 // Find the minimum of the minimums
                 threshold = mins[0];
                 for (uint i = 1; i < numThreads; ++i)
@@ -375,74 +313,83 @@ void search (uint id, uint endX, uint endY,
                                   threshold = mins[i];
                         }
                 }
-            #else
+            }
+            else
+            {
                 threshold += THRESHOLD_FACTOR;
-            #endif
+            }
         }
         syncPoint.wait();
+        if (exhausted)
+        {
+            break;
+        }
     }
 }
 
 void
-searchNeighbor(const Point& adjPoint, uint id, uint threshold, const PathTile& current, const World& world, uint endX, uint endY,
-		 tbb::concurrent_unordered_map<uint, bool>& closedTiles, std::vector<std::unordered_map<uint, PathTile>>& seen,
-		 std::vector<std::deque<PathTile>>& later, std::vector<std::deque<PathTile>>& localNow
-#ifdef OPTIMAL
-        ,std::vector<uint>& mins
-#endif
-     )
+ParFringeSolver::searchNeighbor(const Point& adjPoint, uint id, uint threshold, const PathTile& current, const World& world, uint endX, uint endY,
+		 tbb::concurrent_unordered_map<tileId_t, bool>& closedTiles, std::vector<std::unordered_map<tileId_t, PathTile>>& seen,
+		 std::vector<std::deque<PathTile>>& later, std::vector<std::deque<PathTile>>& localNow,
+		 std::vector<uint>& mins)
 {
-	if (adjPoint.x < world.getWidth () && adjPoint.y < world.getHeight ())
-	{
-		World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
-		if (worldTile.cost != 0)
-		{
-			auto seenTileIter = seen[id].find(worldTile.id);
-			if (seenTileIter == seen[id].end ())
-			{
-				// If we haven't seen the tile then we need to make sure that no one else had either
-				if (closedTiles.find(worldTile.id) == closedTiles.end())
-				{
-                    closedTiles[worldTile.id] = true;
-                    uint costToTile = current.getBestCost () + worldTile.cost;
-                    if (costToTile > threshold)
-                    {
-                        later[id].emplace_back (worldTile, adjPoint, current.xy(),
-						    costToTile, heuristic (adjPoint.x, adjPoint.y, endX, endY));
-                        #ifdef OPTIMAL
-                            mins[id] = std::min(later[id].back ().getCombinedHeuristic (), mins[id]);
-                        #endif
-                        seen[id][worldTile.id] = later[id].back ();
-                    }
-                    else
-                    {
-        				// If no one has then we say that we have.
-        				// WARNING: This is indeed a data race. Hopefully one that is ok and breaks nothing but be careful.
-    					localNow[id].emplace_back (worldTile, adjPoint, current.xy(),
-		                    costToTile, heuristic (adjPoint.x, adjPoint.y, endX, endY));
-                        seen[id][worldTile.id] = localNow[id].back ();
-                    }
-				}
-			}
-			/*else
-			{
-				PathTile& seenTile = seenTileIter->second;
-				uint costToTile = current.getBestCost () + seenTile.getTile ().cost;
-				if (seenTile.getBestCost () > costToTile)
-				{
-					seenTile.setBestCost (costToTile);
-					seenTile.setBestTile (current.xy());
-					if (seenTile.getCombinedHeuristic () > threshold)
-					{
-						// mins[id] = std::min(seenTile.getCombinedHeuristic (), mins[id]);
-						later[id].push_back(seenTile);
-					}
-					else
-					{
-						localNow.push_back(seenTile);
-					}
-				}
-			}*/
-		}
-	}
+    // The neighbor mask already ruled out walls and tiles outside the world
+    World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
+
+    auto seenTileIter = seen[id].find(worldTile.id);
+    if (seenTileIter == seen[id].end ())
+    {
+        // If we haven't seen the tile then we need to make sure that no one else had either
+        if (closedTiles.find(worldTile.id) == closedTiles.end())
+        {
+            closedTiles[worldTile.id] = true;
+            uint costToTile = current.getBestCost () + worldTile.cost;
+            if (costToTile > threshold)
+            {
+                later[id].emplace_back (worldTile, adjPoint, current.xy(),
+                    costToTile, heuristic (adjPoint.x, adjPoint.y, endX, endY));
+                if (m_optimal)
+                {
+                    mins[id] = std::min(later[id].back ().getCombinedHeuristic (), mins[id]);
+                }
+                seen[id][worldTile.id] = later[id].back ();
+            }
+            else
+            {
+                // If no one has then we say that we have.
+                // WARNING: This is indeed a data race. Hopefully one that is ok and breaks nothing but be careful.
+                localNow[id].emplace_back (worldTile, adjPoint, current.xy(),
+                    costToTile, heuristic (adjPoint.x, adjPoint.y, endX, endY));
+                seen[id][worldTile.id] = localNow[id].back ();
+            }
+        }
+    }
+    /*else
+    {
+        PathTile& seenTile = seenTileIter->second;
+        uint costToTile = current.getBestCost () + seenTile.getTile ().cost;
+        if (seenTile.getBestCost () > costToTile)
+        {
+            seenTile.setBestCost (costToTile);
+            seenTile.setBestTile (current.xy());
+            if (seenTile.getCombinedHeuristic () > threshold)
+            {
+                // mins[id] = std::min(seenTile.getCombinedHeuristic (), mins[id]);
+                later[id].push_back(seenTile);
+            }
+            else
+            {
+                localNow.push_back(seenTile);
+            }
+        }
+    }*/
 }
+
+void registerParFringeSolvers (SolverRegistry& registry)
+{
+    // A thread count of 0 runs with one thread per core
+    registry.emplace<ParFringeSolver> ("parFringe", 0u, false);
+    registry.emplace<ParFringeSolver> ("parFringe_optimal", 0u, true);
+}
+
+} /* namespace pathFind */
@@ -0,0 +1,425 @@
+/*
+ * ClusterGraph.cc
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <utility>
+
+#include "algorithms/tools/ClusterGraph.h"
+#include "algorithms/tools/WorkerPool.h"
+
+namespace pathFind
+{
+
+const std::string ClusterGraph::CLUSTER_GRAPH_EXT = ".hpa";
+const uint ClusterGraph::DEFAULT_CLUSTER_SIZE;
+const uint32_t ClusterGraph::NO_NODE;
+const uint32_t ClusterGraph::INF;
+
+const char CLUSTER_GRAPH_MAGIC[4] = {'H', 'P', 'A', '*'};
+const uint32_t CLUSTER_GRAPH_VERSION = 1;
+
+// Runs work (cluster, search) for every cluster with numThreads tasks taking
+// the next cluster in turn, as their sizes and so their work vary
+static void forEachCluster (uint numThreads, size_t numClusters,
+                            const std::function<void (uint, ClusterGraph::clusterSearch_t&)>& work)
+{
+    std::atomic<size_t> nextCluster (0);
+    WorkerPool::getShared ().run (std::max (numThreads, 1u), [&] (uint)
+    {
+        ClusterGraph::clusterSearch_t search;
+        for (size_t cluster = nextCluster++; cluster < numClusters; cluster = nextCluster++)
+        {
+            work (cluster, search);
+        }
+    });
+}
+
+// Tiles in row major order
+static bool isBefore (const Point& a, const Point& b)
+{
+    return a.y < b.y || (a.y == b.y && a.x < b.x);
+}
+
+ClusterGraph::ClusterGraph ()
+    : m_clusterSize (0),
+      m_width (0),
+      m_height (0),
+      m_clustersWide (0)
+{
+}
+
+void ClusterGraph::findTransitions (const World& world, uint cluster,
+                                    std::vector<transition_t>& transitions) const
+{
+    size_t x0 = (cluster % m_clustersWide) * m_clusterSize;
+    size_t y0 = (cluster / m_clustersWide) * m_clusterSize;
+    size_t x1 = std::min (x0 + m_clusterSize, m_width);
+    size_t y1 = std::min (y0 + m_clusterSize, m_height);
+
+    // Walks one border, step moves along it and across moves over it
+    auto findOnBorder = [&] (Point first, Point step, Point across, size_t length)
+    {
+        auto tileAt = [&] (size_t i)
+        {
+            return Point (first.x + step.x * i, first.y + step.y * i);
+        };
+        auto isOpenPair = [&] (size_t i)
+        {
+            Point tile = tileAt (i);
+            return world (tile.x, tile.y).cost != 0 && world (tile.x + across.x, tile.y + across.y).cost != 0;
+        };
+        auto addTransition = [&] (size_t i)
+        {
+            Point tile = tileAt (i);
+            transitions.push_back ({tile, Point (tile.x + across.x, tile.y + across.y)});
+        };
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            if (!isOpenPair (i))
+            {
+                continue;
+            }
+            size_t runStart = i;
+            while (i + 1 < length && isOpenPair (i + 1))
+            {
+                ++i;
+            }
+            if (i - runStart + 1 < MAX_ENTRANCE_WIDTH)
+            {
+                addTransition ((runStart + i) / 2);
+            }
+            else
+            {
+                addTransition (runStart);
+                addTransition (i);
+            }
+        }
+    };
+
+    transitions.clear ();
+    if (x1 < m_width)
+    {
+        findOnBorder (Point (x1 - 1, y0), Point (0, 1), Point (1, 0), y1 - y0);
+    }
+    if (y1 < m_height)
+    {
+        findOnBorder (Point (x0, y1 - 1), Point (1, 0), Point (0, 1), x1 - x0);
+    }
+}
+
+uint32_t ClusterGraph::findNode (const Point& tile) const
+{
+    uint cluster = getCluster (tile.x, tile.y);
+    auto first = m_nodes.begin () + m_firstNodes[cluster];
+    auto last = m_nodes.begin () + m_firstNodes[cluster + 1];
+    auto node = std::lower_bound (first, last, tile, [] (const node_t& node, const Point& tile)
+    {
+        return isBefore (Point (node.x, node.y), tile);
+    });
+    return node != last && node->x == tile.x && node->y == tile.y ? node - m_nodes.begin () : NO_NODE;
+}
+
+void ClusterGraph::build (const World& world, uint clusterSize, uint numThreads)
+{
+    m_clusterSize = std::max (clusterSize, 2u);
+    m_width = world.getWidth ();
+    m_height = world.getHeight ();
+    m_clustersWide = (m_width + m_clusterSize - 1) / m_clusterSize;
+    size_t clustersHigh = (m_height + m_clusterSize - 1) / m_clusterSize;
+    size_t numClusters = m_clustersWide * clustersHigh;
+
+    // The entrances on the east and south border of each cluster
+    std::vector<std::vector<transition_t>> transitions (numClusters);
+    forEachCluster (numThreads, numClusters, [&] (uint cluster, clusterSearch_t&)
+    {
+        findTransitions (world, cluster, transitions[cluster]);
+    });
+
+    // A cluster's nodes are its side of its own entrances and of those its
+    // neighbors to the west and north found on their borders with it
+    std::vector<std::vector<Point>> clusterNodes (numClusters);
+    forEachCluster (numThreads, numClusters, [&] (uint cluster, clusterSearch_t&)
+    {
+        std::vector<Point>& tiles = clusterNodes[cluster];
+        for (const transition_t& transition : transitions[cluster])
+        {
+            tiles.push_back (transition.inside);
+        }
+        size_t x = cluster % m_clustersWide;
+        size_t y = cluster / m_clustersWide;
+        for (size_t neighbor : {x > 0 ? cluster - 1 : numClusters, y > 0 ? cluster - m_clustersWide : numClusters})
+        {
+            if (neighbor == numClusters)
+            {
+                continue;
+            }
+            for (const transition_t& transition : transitions[neighbor])
+            {
+                if (getCluster (transition.outside.x, transition.outside.y) == cluster)
+                {
+                    tiles.push_back (transition.outside);
+                }
+            }
+        }
+        std::sort (tiles.begin (), tiles.end (), isBefore);
+        tiles.erase (std::unique (tiles.begin (), tiles.end (), [] (const Point& a, const Point& b)
+        {
+            return a.x == b.x && a.y == b.y;
+        }), tiles.end ());
+    });
+
+    m_firstNodes.assign (numClusters + 1, 0);
+    m_distanceOffsets.assign (numClusters + 1, 0);
+    for (size_t cluster = 0; cluster < numClusters; ++cluster)
+    {
+        size_t numNodes = clusterNodes[cluster].size ();
+        m_firstNodes[cluster + 1] = m_firstNodes[cluster] + numNodes;
+        m_distanceOffsets[cluster + 1] = m_distanceOffsets[cluster] + numNodes * numNodes;
+    }
+    m_nodes.resize (m_firstNodes.back ());
+    m_distances.assign (m_distanceOffsets.back (), INF);
+
+    forEachCluster (numThreads, numClusters, [&] (uint cluster, clusterSearch_t&)
+    {
+        node_t* node = m_nodes.data () + m_firstNodes[cluster];
+        for (const Point& tile : clusterNodes[cluster])
+        {
+            *node++ = {tile.x, tile.y, {NO_NODE, NO_NODE}};
+        }
+    });
+
+    // Clusters only set the links of their own entrances, a tile on two
+    // borders may have its two links set by different clusters at once
+    forEachCluster (numThreads, numClusters, [&] (uint cluster, clusterSearch_t&)
+    {
+        for (const transition_t& transition : transitions[cluster])
+        {
+            uint32_t inside = findNode (transition.inside);
+            uint32_t outside = findNode (transition.outside);
+            uint link = transition.inside.y == transition.outside.y ? 0 : 1;
+            m_nodes[inside].links[link] = outside;
+            m_nodes[outside].links[link] = inside;
+        }
+    });
+
+    forEachCluster (numThreads, numClusters, [&] (uint cluster, clusterSearch_t& search)
+    {
+        uint32_t first = m_firstNodes[cluster];
+        uint32_t numNodes = m_firstNodes[cluster + 1] - first;
+        uint32_t* distances = m_distances.data () + m_distanceOffsets[cluster];
+        for (uint32_t from = 0; from < numNodes; ++from)
+        {
+            const node_t& fromNode = m_nodes[first + from];
+            searchCluster (world, Point (fromNode.x, fromNode.y), nullptr, search);
+            for (uint32_t to = 0; to < numNodes; ++to)
+            {
+                const node_t& toNode = m_nodes[first + to];
+                distances[from * numNodes + to] = search.costs[getLocalIndex (toNode.x, toNode.y)];
+            }
+        }
+    });
+}
+
+void ClusterGraph::searchCluster (const World& world, const Point& from, const Point* target,
+                                  clusterSearch_t& search) const
+{
+    typedef std::pair<uint32_t, uint32_t> openTile_t;
+
+    uint x0 = from.x - from.x % m_clusterSize;
+    uint y0 = from.y - from.y % m_clusterSize;
+    uint x1 = std::min<size_t> (x0 + m_clusterSize, m_width);
+    uint y1 = std::min<size_t> (y0 + m_clusterSize, m_height);
+
+    search.costs.assign (m_clusterSize * m_clusterSize, INF);
+    search.parents.assign (m_clusterSize * m_clusterSize, NO_NODE);
+    uint32_t targetIndex = target != nullptr ? getLocalIndex (target->x, target->y) : NO_NODE;
+
+    std::priority_queue<openTile_t, std::vector<openTile_t>, std::greater<openTile_t>> openTiles;
+    uint32_t fromIndex = getLocalIndex (from.x, from.y);
+    search.costs[fromIndex] = 0;
+    search.parents[fromIndex] = fromIndex;
+    openTiles.push ({0, fromIndex});
+
+    while (!openTiles.empty ())
+    {
+        openTile_t current = openTiles.top ();
+        openTiles.pop ();
+        // Tiles are pushed again when a cheaper way to them is found
+        if (current.first != search.costs[current.second])
+        {
+            continue;
+        }
+        if (current.second == targetIndex)
+        {
+            return;
+        }
+
+        Point tile (x0 + current.second % m_clusterSize, y0 + current.second / m_clusterSize);
+        uint neighbors = world.getNeighborMask (tile.x, tile.y);
+        while (neighbors != 0)
+        {
+            Point neighbor = World::nextNeighbor (tile, neighbors);
+            if (neighbor.x < x0 || neighbor.x >= x1 || neighbor.y < y0 || neighbor.y >= y1)
+            {
+                continue;
+            }
+            uint32_t index = getLocalIndex (neighbor.x, neighbor.y);
+            uint32_t cost = current.first + world (neighbor.x, neighbor.y).cost;
+            if (cost < search.costs[index])
+            {
+                search.costs[index] = cost;
+                search.parents[index] = current.second;
+                openTiles.push ({cost, index});
+            }
+        }
+    }
+}
+
+void ClusterGraph::getClusterPath (const clusterSearch_t& search, const Point& from, const Point& to,
+                                   std::vector<Point>& path) const
+{
+    uint x0 = to.x - to.x % m_clusterSize;
+    uint y0 = to.y - to.y % m_clusterSize;
+    uint32_t fromIndex = getLocalIndex (from.x, from.y);
+    for (uint32_t index = getLocalIndex (to.x, to.y); index != fromIndex;)
+    {
+        index = search.parents[index];
+        path.push_back (Point (x0 + index % m_clusterSize, y0 + index / m_clusterSize));
+    }
+}
+
+bool ClusterGraph::load (const std::string& fileName, const World& world)
+{
+    m_clusterSize = 0;
+    m_width = 0;
+    m_height = 0;
+    m_clustersWide = 0;
+    m_firstNodes.clear ();
+    m_nodes.clear ();
+    m_distanceOffsets.clear ();
+    m_distances.clear ();
+
+    std::ifstream graphFile (fileName, std::ifstream::in | std::ifstream::binary | std::ifstream::ate);
+    uint64_t fileSize = graphFile.tellg ();
+    graphFile.seekg (0);
+    fileHeader_t header;
+    if (!graphFile.read (reinterpret_cast<char*> (&header), sizeof (header)) ||
+            std::memcmp (header.magic, CLUSTER_GRAPH_MAGIC, sizeof (header.magic)) != 0 ||
+            header.version != CLUSTER_GRAPH_VERSION || header.clusterSize < 2 ||
+            header.width != world.getWidth () || header.height != world.getHeight () ||
+            header.checksum != world.computeChecksum ())
+    {
+        return false;
+    }
+
+    // The counts in the header have to add up to the rest of the file before
+    // anything is allocated for them
+    size_t clustersWide = (header.width + header.clusterSize - 1) / header.clusterSize;
+    size_t numClusters = clustersWide * ((header.height + header.clusterSize - 1) / header.clusterSize);
+    uint64_t remaining = fileSize - sizeof (header);
+    uint64_t tablesSize = (numClusters + 1) * (sizeof (uint32_t) + sizeof (uint64_t));
+    if (tablesSize > remaining || header.numNodes > (remaining - tablesSize) / sizeof (node_t) ||
+            header.numDistances > remaining / sizeof (uint32_t) ||
+            remaining != tablesSize + header.numNodes * sizeof (node_t) + header.numDistances * sizeof (uint32_t))
+    {
+        return false;
+    }
+
+    std::vector<uint32_t> firstNodes (numClusters + 1);
+    std::vector<node_t> nodes (header.numNodes);
+    std::vector<uint64_t> distanceOffsets (numClusters + 1);
+    std::vector<uint32_t> distances (header.numDistances);
+    if (!graphFile.read (reinterpret_cast<char*> (firstNodes.data ()), firstNodes.size () * sizeof (uint32_t)) ||
+            !graphFile.read (reinterpret_cast<char*> (nodes.data ()), nodes.size () * sizeof (node_t)) ||
+            !graphFile.read (reinterpret_cast<char*> (distanceOffsets.data ()),
+                             distanceOffsets.size () * sizeof (uint64_t)) ||
+            !graphFile.read (reinterpret_cast<char*> (distances.data ()), distances.size () * sizeof (uint32_t)) ||
+            firstNodes.front () != 0 || firstNodes.back () != nodes.size () ||
+            distanceOffsets.front () != 0 || distanceOffsets.back () != distances.size ())
+    {
+        return false;
+    }
+
+    // Every cluster lists its own nodes and a matrix of the distances between
+    // them, and links lead to nodes that exist. Anything else is a corrupt
+    // file and the graph gets built again.
+    for (size_t cluster = 0; cluster < numClusters; ++cluster)
+    {
+        if (firstNodes[cluster + 1] < firstNodes[cluster] || distanceOffsets[cluster + 1] < distanceOffsets[cluster])
+        {
+            return false;
+        }
+        uint64_t numNodes = firstNodes[cluster + 1] - firstNodes[cluster];
+        if (distanceOffsets[cluster + 1] - distanceOffsets[cluster] != numNodes * numNodes)
+        {
+            return false;
+        }
+        for (uint32_t node = firstNodes[cluster]; node < firstNodes[cluster + 1]; ++node)
+        {
+            const node_t& current = nodes[node];
+            if (current.x >= header.width || current.y >= header.height ||
+                    (current.y / header.clusterSize) * clustersWide + (current.x / header.clusterSize) != cluster)
+            {
+                return false;
+            }
+            for (uint32_t link : current.links)
+            {
+                if (link != NO_NODE && link >= nodes.size ())
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    m_clusterSize = header.clusterSize;
+    m_width = header.width;
+    m_height = header.height;
+    m_clustersWide = clustersWide;
+    m_firstNodes = std::move (firstNodes);
+    m_nodes = std::move (nodes);
+    m_distanceOffsets = std::move (distanceOffsets);
+    m_distances = std::move (distances);
+    return true;
+}
+
+bool ClusterGraph::save (const std::string& fileName, const World& world) const
+{
+    if (!fits (world))
+    {
+        return false;
+    }
+
+    fileHeader_t header;
+    std::memcpy (header.magic, CLUSTER_GRAPH_MAGIC, sizeof (header.magic));
+    header.version = CLUSTER_GRAPH_VERSION;
+    header.clusterSize = m_clusterSize;
+    header.width = m_width;
+    header.height = m_height;
+    header.checksum = world.computeChecksum ();
+    header.numNodes = m_nodes.size ();
+    header.numDistances = m_distances.size ();
+
+    std::ofstream graphFile (fileName, std::ofstream::out | std::ofstream::binary);
+    graphFile.write (reinterpret_cast<const char*> (&header), sizeof (header));
+    graphFile.write (reinterpret_cast<const char*> (m_firstNodes.data ()), m_firstNodes.size () * sizeof (uint32_t));
+    graphFile.write (reinterpret_cast<const char*> (m_nodes.data ()), m_nodes.size () * sizeof (node_t));
+    graphFile.write (reinterpret_cast<const char*> (m_distanceOffsets.data ()),
+                     m_distanceOffsets.size () * sizeof (uint64_t));
+    graphFile.write (reinterpret_cast<const char*> (m_distances.data ()), m_distances.size () * sizeof (uint32_t));
+    return static_cast<bool> (graphFile);
+}
+
+bool ClusterGraph::fits (const World& world) const
+{
+    return !m_firstNodes.empty () && m_width == world.getWidth () && m_height == world.getHeight ();
+}
+
+} /* namespace pathFind */
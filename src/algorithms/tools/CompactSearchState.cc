@@ -0,0 +1,64 @@
+/*
+ * CompactSearchState.cc
+ */
+
+#include <algorithm>
+
+#include "algorithms/tools/CompactSearchState.h"
+
+namespace pathFind
+{
+
+CompactSearchState::CompactSearchState (size_t worldWidth, size_t worldHeight)
+    : m_worldWidth (worldWidth),
+      m_worldHeight (worldHeight),
+      m_directions ((worldWidth * worldHeight + DIRECTIONS_PER_WORD - 1) / DIRECTIONS_PER_WORD, 0),
+      m_closed ((worldWidth * worldHeight + CLOSED_PER_WORD - 1) / CLOSED_PER_WORD, 0),
+      m_start (0)
+{
+}
+
+CompactSearchState::CompactSearchState (const World& world, size_t)
+    : CompactSearchState (world.getWidth (), world.getHeight ())
+{
+}
+
+bool CompactSearchState::fits (size_t) const
+{
+    return true;
+}
+
+void CompactSearchState::getPath (tileId_t id, std::vector<Point>& path) const
+{
+    Point xy = getPoint (id);
+    path.emplace_back (xy);
+    while (id != m_start)
+    {
+        // Step towards the parent, in the order of the World::Direction bits
+        switch (getDirection (id))
+        {
+        case 0:
+            ++xy.x;
+            break;
+        case 1:
+            ++xy.y;
+            break;
+        case 2:
+            --xy.x;
+            break;
+        case 3:
+        default:
+            --xy.y;
+            break;
+        }
+        id = (m_worldWidth * xy.y) + xy.x;
+        path.emplace_back (xy);
+    }
+}
+
+void CompactSearchState::reset ()
+{
+    std::fill (m_closed.begin (), m_closed.end (), 0);
+}
+
+} /* namespace pathFind */
@@ -0,0 +1,150 @@
+/*
+ * JumpTable.cc
+ */
+
+#include <cstring>
+#include <fstream>
+
+#include "algorithms/tools/JumpTable.h"
+
+namespace pathFind
+{
+
+const std::string JumpTable::JUMP_TABLE_EXT = ".jps";
+
+const char JUMP_TABLE_MAGIC[4] = {'J', 'P', 'S', '+'};
+const uint32_t JUMP_TABLE_VERSION = 1;
+
+// Distance from a tile given the distance from its neighbor in the same
+// direction, open == false when that neighbor is a wall or off the world
+static int32_t extend (bool open, bool neighborIsJumpPoint, int32_t neighborDistance)
+{
+    if (!open)
+    {
+        return 0;
+    }
+    if (neighborIsJumpPoint)
+    {
+        return 1;
+    }
+    return neighborDistance > 0 ? neighborDistance + 1 : neighborDistance - 1;
+}
+
+JumpTable::JumpTable ()
+    : m_width (0),
+      m_height (0)
+{
+}
+
+void JumpTable::build (const World& world)
+{
+    m_width = world.getWidth ();
+    m_height = world.getHeight ();
+    m_distances.assign (m_width * m_height * NUM_DIRECTIONS, 0);
+
+    auto distance = [this] (size_t x, size_t y, uint direction) -> int32_t&
+    {
+        return m_distances[((y * m_width) + x) * NUM_DIRECTIONS + getIndex (direction)];
+    };
+
+    // Vertical distances first as the horizontal jump points depend on them.
+    // Rows are swept whole so each one reads the row it was reached from.
+    for (size_t y = m_height; y-- > 0;)
+    {
+        for (size_t x = 0; x < m_width; ++x)
+        {
+            uint mask = world.getNeighborMask (x, y);
+            bool open = (mask & World::SOUTH) != 0;
+            distance (x, y, World::SOUTH) = extend (open,
+                    open && isVerticalJumpPoint (mask, world.getNeighborMask (x, y + 1)),
+                    open ? distance (x, y + 1, World::SOUTH) : 0);
+        }
+    }
+    for (size_t y = 0; y < m_height; ++y)
+    {
+        for (size_t x = 0; x < m_width; ++x)
+        {
+            uint mask = world.getNeighborMask (x, y);
+            bool open = (mask & World::NORTH) != 0;
+            distance (x, y, World::NORTH) = extend (open,
+                    open && isVerticalJumpPoint (mask, world.getNeighborMask (x, y - 1)),
+                    open ? distance (x, y - 1, World::NORTH) : 0);
+        }
+    }
+
+    auto isHorizontalJumpPoint = [&distance] (size_t x, size_t y)
+    {
+        return distance (x, y, World::NORTH) > 0 || distance (x, y, World::SOUTH) > 0;
+    };
+    for (size_t y = 0; y < m_height; ++y)
+    {
+        for (size_t x = m_width; x-- > 0;)
+        {
+            bool open = (world.getNeighborMask (x, y) & World::EAST) != 0;
+            distance (x, y, World::EAST) = extend (open, open && isHorizontalJumpPoint (x + 1, y),
+                    open ? distance (x + 1, y, World::EAST) : 0);
+        }
+        for (size_t x = 0; x < m_width; ++x)
+        {
+            bool open = (world.getNeighborMask (x, y) & World::WEST) != 0;
+            distance (x, y, World::WEST) = extend (open, open && isHorizontalJumpPoint (x - 1, y),
+                    open ? distance (x - 1, y, World::WEST) : 0);
+        }
+    }
+}
+
+bool JumpTable::load (const std::string& fileName, const World& world)
+{
+    m_width = 0;
+    m_height = 0;
+    m_distances.clear ();
+
+    std::ifstream tableFile (fileName, std::ifstream::in | std::ifstream::binary);
+    fileHeader_t header;
+    if (!tableFile.read (reinterpret_cast<char*> (&header), sizeof (header)) ||
+            std::memcmp (header.magic, JUMP_TABLE_MAGIC, sizeof (header.magic)) != 0 ||
+            header.version != JUMP_TABLE_VERSION ||
+            header.width != world.getWidth () || header.height != world.getHeight () ||
+            header.checksum != world.computeChecksum ())
+    {
+        return false;
+    }
+
+    std::vector<int32_t> distances (header.width * header.height * NUM_DIRECTIONS);
+    if (!tableFile.read (reinterpret_cast<char*> (distances.data ()), distances.size () * sizeof (int32_t)))
+    {
+        return false;
+    }
+
+    m_width = header.width;
+    m_height = header.height;
+    m_distances = std::move (distances);
+    return true;
+}
+
+bool JumpTable::save (const std::string& fileName, const World& world) const
+{
+    if (!fits (world))
+    {
+        return false;
+    }
+
+    fileHeader_t header;
+    std::memcpy (header.magic, JUMP_TABLE_MAGIC, sizeof (header.magic));
+    header.version = JUMP_TABLE_VERSION;
+    header.width = m_width;
+    header.height = m_height;
+    header.checksum = world.computeChecksum ();
+
+    std::ofstream tableFile (fileName, std::ofstream::out | std::ofstream::binary);
+    tableFile.write (reinterpret_cast<const char*> (&header), sizeof (header));
+    tableFile.write (reinterpret_cast<const char*> (m_distances.data ()), m_distances.size () * sizeof (int32_t));
+    return static_cast<bool> (tableFile);
+}
+
+bool JumpTable::fits (const World& world) const
+{
+    return !m_distances.empty () && m_width == world.getWidth () && m_height == world.getHeight ();
+}
+
+} /* namespace pathFind */
@@ -0,0 +1,193 @@
+/*
+ * LPAStar.cc
+ */
+
+#include <algorithm>
+
+#include "algorithms/tools/LPAStar.h"
+
+namespace pathFind
+{
+
+LPAStar::LPAStar (const World& world, const Point& start, const Point& end)
+    : m_world (world),
+      m_start (start),
+      m_end (end),
+      m_startId (world.getID (start.x, start.y)),
+      m_endId (world.getID (end.x, end.y)),
+      m_g (world.getWidth () * world.getHeight (), PathTile::INF),
+      m_rhs (world.getWidth () * world.getHeight (), PathTile::INF),
+      m_expansions (0)
+{
+    m_rhs[m_startId] = 0;
+    m_open.push ({calculateKey (m_startId), m_startId});
+}
+
+bool LPAStar::computePath ()
+{
+    skipStaleEntries ();
+    while (!m_open.empty () &&
+           (m_open.top ().key < calculateKey (m_endId) || m_rhs[m_endId] != m_g[m_endId]))
+    {
+        tileId_t id = m_open.top ().id;
+        m_open.pop ();
+        ++m_expansions;
+
+        Point xy = toPoint (id);
+        if (m_g[id] > m_rhs[id])
+        {
+            // Overconsistent, the better cost is final
+            m_g[id] = m_rhs[id];
+        }
+        else
+        {
+            // Underconsistent, the old cost got worse so start over on this tile
+            m_g[id] = PathTile::INF;
+            updateVertex (id);
+        }
+
+        uint neighbors = m_world.getNeighborMask (xy.x, xy.y);
+        while (neighbors != 0)
+        {
+            Point adjPoint = World::nextNeighbor (xy, neighbors);
+            updateVertex (m_world.getID (adjPoint.x, adjPoint.y));
+        }
+        skipStaleEntries ();
+    }
+    return m_g[m_endId] != PathTile::INF;
+}
+
+void LPAStar::updateTile (uint x, uint y)
+{
+    // The tile's own cost only matters for entering it, but if it turned into a
+    // wall (or back) its neighbors lose (or gain) a way through it. A tile's mask
+    // lists its open neighbors whether or not the tile itself is open.
+    tileId_t id = m_world.getID (x, y);
+    updateVertex (id);
+
+    Point xy {x, y};
+    uint neighbors = m_world.getNeighborMask (x, y);
+    while (neighbors != 0)
+    {
+        Point adjPoint = World::nextNeighbor (xy, neighbors);
+        updateVertex (m_world.getID (adjPoint.x, adjPoint.y));
+    }
+}
+
+uint LPAStar::getPathCost () const
+{
+    if (m_g[m_endId] == PathTile::INF)
+    {
+        return PathTile::INF;
+    }
+    return m_g[m_endId] - m_world (m_end.x, m_end.y).cost;
+}
+
+std::vector<Point> LPAStar::getPath () const
+{
+    std::vector<Point> path;
+    if (m_g[m_endId] == PathTile::INF)
+    {
+        return path;
+    }
+
+    // Walk back along the neighbors with the lowest settled cost
+    Point xy = m_end;
+    tileId_t id = m_endId;
+    while (id != m_startId)
+    {
+        path.push_back (xy);
+        Point best = xy;
+        uint bestCost = PathTile::INF;
+        uint neighbors = m_world.getNeighborMask (xy.x, xy.y);
+        while (neighbors != 0)
+        {
+            Point adjPoint = World::nextNeighbor (xy, neighbors);
+            uint cost = m_g[m_world.getID (adjPoint.x, adjPoint.y)];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                best = adjPoint;
+            }
+        }
+        xy = best;
+        id = m_world.getID (xy.x, xy.y);
+    }
+    path.push_back (m_start);
+    return path;
+}
+
+size_t LPAStar::getExpansions () const
+{
+    return m_expansions;
+}
+
+LPAStar::key_t LPAStar::calculateKey (tileId_t id) const
+{
+    uint cost = std::min (m_g[id], m_rhs[id]);
+    if (cost == PathTile::INF)
+    {
+        return {PathTile::INF, PathTile::INF};
+    }
+    return {cost + heuristic (id), cost};
+}
+
+uint LPAStar::heuristic (tileId_t id) const
+{
+    Point xy = toPoint (id);
+    return  (xy.x < m_end.x ? m_end.x - xy.x : xy.x - m_end.x) +
+            (xy.y < m_end.y ? m_end.y - xy.y : xy.y - m_end.y);
+}
+
+void LPAStar::updateVertex (tileId_t id)
+{
+    if (id != m_startId)
+    {
+        m_rhs[id] = computeRhs (id);
+    }
+    if (m_g[id] != m_rhs[id])
+    {
+        m_open.push ({calculateKey (id), id});
+    }
+}
+
+uint LPAStar::computeRhs (tileId_t id) const
+{
+    Point xy = toPoint (id);
+    uint cost = m_world (xy.x, xy.y).cost;
+    if (cost == 0)
+    {
+        return PathTile::INF;
+    }
+
+    uint best = PathTile::INF;
+    uint neighbors = m_world.getNeighborMask (xy.x, xy.y);
+    while (neighbors != 0)
+    {
+        Point adjPoint = World::nextNeighbor (xy, neighbors);
+        best = std::min (best, m_g[m_world.getID (adjPoint.x, adjPoint.y)]);
+    }
+    return (best == PathTile::INF) ? best : best + cost;
+}
+
+Point LPAStar::toPoint (tileId_t id) const
+{
+    return Point (id % m_world.getWidth (), id / m_world.getWidth ());
+}
+
+void LPAStar::skipStaleEntries ()
+{
+    while (!m_open.empty ())
+    {
+        const entry_t& top = m_open.top ();
+        key_t current = calculateKey (top.id);
+        bool consistent = m_g[top.id] == m_rhs[top.id];
+        if (!consistent && !(top.key < current) && !(current < top.key))
+        {
+            return;
+        }
+        m_open.pop ();
+    }
+}
+
+} /* namespace pathFind */
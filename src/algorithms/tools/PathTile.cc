@@ -11,6 +11,10 @@ typedef unsigned int uint;
 namespace pathFind
 {
 
+// Out of class definition so INF can be bound to references (std::vector,
+// std::fill, ...) in builds without optimisation
+const uint PathTile::INF;
+
 PathTile::PathTile ()
     : m_xy (0, 0),
       m_bestCost (INF),
@@ -0,0 +1,94 @@
+/*
+ * SearchState.cc
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "algorithms/tools/SearchState.h"
+
+namespace pathFind
+{
+
+SearchState::SearchState (size_t worldWidth, size_t worldHeight, size_t expectedTiles)
+    : m_worldWidth (worldWidth),
+      m_worldHeight (worldHeight),
+      m_dense (isDenseBetter (worldWidth * worldHeight, expectedTiles)),
+      m_bestCosts (m_dense ? worldWidth * worldHeight : 0, PathTile::INF),
+      m_bestTiles (m_bestCosts.size (), 0),
+      m_stamps (m_bestCosts.size (), 0),
+      m_generation (1),
+      m_sparseTiles (m_dense ? 0 : expectedTiles)
+{
+}
+
+SearchState::SearchState (const World& world, size_t expectedTiles)
+    : SearchState (world.getWidth (), world.getHeight (), expectedTiles)
+{
+}
+
+size_t SearchState::estimateTiles (const Point& start, const Point& end, bool informed)
+{
+    size_t dx = start.x > end.x ? start.x - end.x : end.x - start.x;
+    size_t dy = start.y > end.y ? start.y - end.y : end.y - start.y;
+    size_t distance = dx + dy;
+    if (informed)
+    {
+        return (distance + 1) * INFORMED_WIDTH;
+    }
+    return 2 * distance * (distance + 1) + 1;
+}
+
+bool SearchState::isDenseBetter (size_t numTiles, size_t expectedTiles)
+{
+    // Ids are stored in 32 bits in the arrays
+    if (numTiles > std::numeric_limits<uint32_t>::max ())
+    {
+        return false;
+    }
+    if (numTiles <= DENSE_MAX_TILES || expectedTiles == 0)
+    {
+        return true;
+    }
+    return expectedTiles * SPARSE_RATIO >= numTiles;
+}
+
+bool SearchState::fits (size_t expectedTiles) const
+{
+    return m_dense == isDenseBetter (m_worldWidth * m_worldHeight, expectedTiles);
+}
+
+PathTile SearchState::getPathTile (const World& world, tileId_t id) const
+{
+    Point xy = getPoint (id);
+    return PathTile (world (xy.x, xy.y), xy, getPoint (getBestTile (id)), getBestCost (id));
+}
+
+void SearchState::reset ()
+{
+    if (!m_dense)
+    {
+        m_sparseTiles.clear ();
+        return;
+    }
+    ++m_generation;
+    // The generation has to fit in the stamps next to the closed flag. Once
+    // it would not, start over with freshly cleared stamps.
+    if (m_generation == (1u << 31))
+    {
+        std::fill (m_stamps.begin (), m_stamps.end (), 0);
+        m_generation = 1;
+    }
+}
+
+void SearchState::getPath (tileId_t id, std::vector<Point>& path) const
+{
+    path.emplace_back (getPoint (id));
+    while (getBestTile (id) != id)
+    {
+        id = getBestTile (id);
+        path.emplace_back (getPoint (id));
+    }
+}
+
+} /* namespace pathFind */
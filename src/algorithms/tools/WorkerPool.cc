@@ -0,0 +1,212 @@
+/*
+ * WorkerPool.cc
+ */
+
+#include <algorithm>
+
+#ifdef __linux__
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+#include "algorithms/tools/WorkerPool.h"
+
+namespace pathFind
+{
+
+const int WorkerPool::NO_CORE;
+
+// One call to run, shared by the workers running its tasks
+struct WorkerPool::phase_t
+{
+    const task_t* task;
+    std::mutex lock;
+    std::condition_variable done;
+    size_t remaining;
+    std::exception_ptr error;
+
+    // Records the first exception a task threw
+    void finish (std::exception_ptr taskError)
+    {
+        std::lock_guard<std::mutex> guard (lock);
+        if (taskError && !error)
+        {
+            error = taskError;
+        }
+        if (--remaining == 0)
+        {
+            done.notify_one ();
+        }
+    }
+};
+
+WorkerPool::WorkerPool (bool pinned)
+    : m_pinned (pinned)
+{
+    #ifdef __linux__
+        // taskset, cgroups and the like may leave only some of the cores
+        cpu_set_t allowed;
+        if (sched_getaffinity (0, sizeof (allowed), &allowed) == 0)
+        {
+            for (int core = 0; core < CPU_SETSIZE; ++core)
+            {
+                if (CPU_ISSET (core, &allowed))
+                {
+                    m_cores.push_back (core);
+                }
+            }
+        }
+    #endif
+    if (m_cores.empty ())
+    {
+        int numCores = std::max (std::thread::hardware_concurrency (), 1u);
+        for (int core = 0; core < numCores; ++core)
+        {
+            m_cores.push_back (core);
+        }
+    }
+}
+
+WorkerPool::~WorkerPool ()
+{
+    for (auto& worker : m_workers)
+    {
+        {
+            std::lock_guard<std::mutex> guard (worker->lock);
+            worker->stop = true;
+        }
+        worker->wake.notify_one ();
+        worker->thread.join ();
+    }
+}
+
+WorkerPool& WorkerPool::getShared ()
+{
+    static WorkerPool pool;
+    return pool;
+}
+
+void WorkerPool::run (uint numTasks, const task_t& task)
+{
+    if (numTasks == 0)
+    {
+        return;
+    }
+
+    phase_t phase;
+    phase.task = &task;
+    phase.remaining = numTasks - 1;
+
+    std::vector<worker_t*> workers;
+    claimWorkers (numTasks - 1, workers);
+    for (uint i = 0; i < workers.size (); ++i)
+    {
+        {
+            std::lock_guard<std::mutex> guard (workers[i]->lock);
+            workers[i]->phase = &phase;
+            workers[i]->index = i + 1;
+        }
+        workers[i]->wake.notify_one ();
+    }
+
+    std::exception_ptr error;
+    try
+    {
+        task (0);
+    }
+    catch (...)
+    {
+        error = std::current_exception ();
+    }
+
+    {
+        std::unique_lock<std::mutex> guard (phase.lock);
+        phase.done.wait (guard, [&phase] { return phase.remaining == 0; });
+        if (!error)
+        {
+            error = phase.error;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> guard (m_lock);
+        m_idle.insert (m_idle.end (), workers.begin (), workers.end ());
+    }
+
+    if (error)
+    {
+        std::rethrow_exception (error);
+    }
+}
+
+size_t WorkerPool::size () const
+{
+    std::lock_guard<std::mutex> guard (m_lock);
+    return m_workers.size ();
+}
+
+void WorkerPool::claimWorkers (size_t count, std::vector<worker_t*>& workers)
+{
+    std::lock_guard<std::mutex> guard (m_lock);
+    size_t fromIdle = std::min (count, m_idle.size ());
+    workers.assign (m_idle.end () - fromIdle, m_idle.end ());
+    m_idle.resize (m_idle.size () - fromIdle);
+
+    while (workers.size () < count)
+    {
+        m_workers.emplace_back (new worker_t ());
+        worker_t& worker = *m_workers.back ();
+        // The first core is left to the threads calling run. Pinning more
+        // workers than there are cores would stack them on the same ones, so
+        // those are left to the scheduler.
+        int core = (m_pinned && m_workers.size () < m_cores.size ()) ? m_cores[m_workers.size ()] : NO_CORE;
+        worker.thread = std::thread (&WorkerPool::workerLoop, this, std::ref (worker), core);
+        workers.push_back (&worker);
+    }
+}
+
+void WorkerPool::workerLoop (worker_t& worker, int core)
+{
+    #ifdef __linux__
+        if (core != NO_CORE)
+        {
+            cpu_set_t cores;
+            CPU_ZERO (&cores);
+            CPU_SET (core, &cores);
+            pthread_setaffinity_np (pthread_self (), sizeof (cores), &cores);
+        }
+    #else
+        (void) core;
+    #endif
+
+    std::unique_lock<std::mutex> guard (worker.lock);
+    while (true)
+    {
+        worker.wake.wait (guard, [&worker] { return worker.phase != nullptr || worker.stop; });
+        if (worker.phase == nullptr)
+        {
+            return;
+        }
+
+        phase_t* phase = worker.phase;
+        uint index = worker.index;
+        guard.unlock ();
+
+        std::exception_ptr error;
+        try
+        {
+            (*phase->task) (index);
+        }
+        catch (...)
+        {
+            error = std::current_exception ();
+        }
+
+        guard.lock ();
+        worker.phase = nullptr;
+        // The phase may be gone as soon as it is told this task finished
+        phase->finish (error);
+    }
+}
+
+} /* namespace pathFind */
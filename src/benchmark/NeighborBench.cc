@@ -0,0 +1,188 @@
+/**
+ * File        : NeighborBench.cc
+ * Description : Measures how fast tiles can be expanded when neighbors are found
+ *               with bounds checks and cost loads versus the precomputed neighbor
+ *               masks of a world. Floods the whole world breadth first both ways
+ *               and reports the expansions per second of each.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <chrono>
+
+#include <boost/lexical_cast.hpp>
+
+#include "common/World.h"
+
+using namespace pathFind;
+
+const std::string WORLD_DIR = "../worlds";
+const std::string WORLD_EXT = ".world";
+
+/**
+ * Floods every tile reachable from start and returns the number of tiles expanded.
+ * Neighbors are found with two bounds checks and a cost load each, which is how
+ * the algorithms found them before neighbor masks.
+ */
+size_t floodChecked (const World& world, const Point& start, std::vector<Point>& queue,
+                     std::vector<uint8_t>& visited);
+
+/**
+ * Same flood as floodChecked but only visits the neighbors set in each tile's mask,
+ * so it never has to touch the cost plane at all.
+ */
+size_t floodMasked (const World& world, const Point& start, std::vector<Point>& queue,
+                    std::vector<uint8_t>& visited);
+
+int main (int args, char* argv[])
+{
+    if (args != 2 && args != 3)
+    {
+        std::cout << "Incorrect inputs. Usage: <filename> (repetitions)" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    uint repetitions = 5;
+    if (args == 3)
+    {
+        try
+        {
+            repetitions = boost::lexical_cast<uint> (argv[2]);
+        }
+        catch (boost::bad_lexical_cast &e)
+        {
+            std::cout << "Repetitions failed to convert to a numeric type" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::stringstream filename;
+    filename << WORLD_DIR << "/" << argv[1] << WORLD_EXT;
+
+    World world;
+    if (!world.loadFile (filename.str ()))
+    {
+        std::cout << "World file doesn't exist." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Start from the first open tile, generated worlds are connected so the
+    // flood reaches every open tile from there.
+    Point start;
+    bool foundStart = false;
+    for (uint y = 0; y < world.getHeight () && !foundStart; ++y)
+    {
+        for (uint x = 0; x < world.getWidth () && !foundStart; ++x)
+        {
+            if (world (x, y).cost != 0)
+            {
+                start = {x, y};
+                foundStart = true;
+            }
+        }
+    }
+    if (!foundStart)
+    {
+        std::cout << "World has no open tiles." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto t1 = std::chrono::high_resolution_clock::now ();
+    world.buildNeighborMasks ();
+    auto t2 = std::chrono::high_resolution_clock::now ();
+    std::cout << "Mask build: "
+              << std::chrono::duration_cast<std::chrono::milliseconds> (t2 - t1).count ()
+              << " ms" << std::endl;
+
+    std::vector<Point> queue;
+    queue.reserve (world.getNumOpenTiles ());
+    std::vector<uint8_t> visited;
+
+    double checkedSeconds = 0, maskedSeconds = 0;
+    size_t checkedExpansions = 0, maskedExpansions = 0;
+    for (uint i = 0; i < repetitions; ++i)
+    {
+        t1 = std::chrono::high_resolution_clock::now ();
+        checkedExpansions += floodChecked (world, start, queue, visited);
+        t2 = std::chrono::high_resolution_clock::now ();
+        checkedSeconds += std::chrono::duration<double> (t2 - t1).count ();
+
+        t1 = std::chrono::high_resolution_clock::now ();
+        maskedExpansions += floodMasked (world, start, queue, visited);
+        t2 = std::chrono::high_resolution_clock::now ();
+        maskedSeconds += std::chrono::duration<double> (t2 - t1).count ();
+    }
+
+    if (checkedExpansions != maskedExpansions)
+    {
+        std::cout << "Floods disagree: " << checkedExpansions << " vs "
+                  << maskedExpansions << " expansions" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Expansions per flood: " << checkedExpansions / repetitions << std::endl;
+    std::cout << "Bounds checked: " << checkedExpansions / checkedSeconds << " expansions/s" << std::endl;
+    std::cout << "Neighbor masks: " << maskedExpansions / maskedSeconds << " expansions/s" << std::endl;
+    std::cout << "Speedup: " << checkedSeconds / maskedSeconds << "x" << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+/****************************************************************************************************/
+// Function Definitions
+
+size_t floodChecked (const World& world, const Point& start, std::vector<Point>& queue,
+                     std::vector<uint8_t>& visited)
+{
+    visited.assign (world.getWidth () * world.getHeight (), 0);
+    queue.clear ();
+    queue.push_back (start);
+    visited[world.getID (start.x, start.y)] = 1;
+
+    for (size_t next = 0; next < queue.size (); ++next)
+    {
+        Point current = queue[next];
+        Point adjPoints[4] = {{current.x + 1, current.y}, {current.x, current.y + 1},
+                              {current.x - 1, current.y}, {current.x, current.y - 1}};
+        for (const Point& adjPoint : adjPoints)
+        {
+            if (adjPoint.x < world.getWidth () && adjPoint.y < world.getHeight ())
+            {
+                World::tile_t worldTile = world (adjPoint.x, adjPoint.y);
+                if (worldTile.cost != 0 && !visited[worldTile.id])
+                {
+                    visited[worldTile.id] = 1;
+                    queue.push_back (adjPoint);
+                }
+            }
+        }
+    }
+    return queue.size ();
+}
+
+size_t floodMasked (const World& world, const Point& start, std::vector<Point>& queue,
+                    std::vector<uint8_t>& visited)
+{
+    visited.assign (world.getWidth () * world.getHeight (), 0);
+    queue.clear ();
+    queue.push_back (start);
+    visited[world.getID (start.x, start.y)] = 1;
+
+    for (size_t next = 0; next < queue.size (); ++next)
+    {
+        Point current = queue[next];
+        uint neighbors = world.getNeighborMask (current.x, current.y);
+        while (neighbors != 0)
+        {
+            Point adjPoint = World::nextNeighbor (current, neighbors);
+            tileId_t id = world.getID (adjPoint.x, adjPoint.y);
+            if (!visited[id])
+            {
+                visited[id] = 1;
+                queue.push_back (adjPoint);
+            }
+        }
+    }
+    return queue.size ();
+}
@@ -0,0 +1,287 @@
+// ChunkCache.cc
+
+#include "common/ChunkCache.h"
+#include "common/RunLength.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace pathFind
+{
+
+const size_t ChunkCache::NUM_PINS;
+const size_t ChunkCache::NO_PIN;
+
+static std::atomic<uint64_t> nextCacheId (1);
+
+// The cache the thread read last and its pin in it, so runs of reads from one
+// cache don't look the pin up again
+static thread_local uint64_t lastCacheId = 0;
+static thread_local size_t lastPin = 0;
+
+class ChunkCache::ThreadPins
+{
+public:
+
+    // Gives back every pin of the caches still around
+    ~ThreadPins ();
+
+    // The pin held in the cache, claiming one if there is none yet
+    size_t get (uint64_t cacheId, const std::shared_ptr<pinTable_t>& table);
+
+private:
+
+    struct held_t
+    {
+        uint64_t cacheId;
+        std::weak_ptr<pinTable_t> table;
+        size_t pin;
+    };
+
+    std::vector<held_t> m_held;
+};
+
+ChunkCache::ThreadPins::~ThreadPins ()
+{
+    for (held_t& held : m_held)
+    {
+        std::shared_ptr<pinTable_t> table = held.table.lock ();
+        if (table && held.pin != NO_PIN)
+        {
+            table->release (held.pin);
+        }
+    }
+}
+
+size_t ChunkCache::ThreadPins::get (uint64_t cacheId, const std::shared_ptr<pinTable_t>& table)
+{
+    for (auto iter = m_held.begin (); iter != m_held.end ();)
+    {
+        if (iter->cacheId == cacheId)
+        {
+            // Try again for a pin once another thread has given one back
+            if (iter->pin == NO_PIN && table->numFree.load () != 0)
+            {
+                iter->pin = table->claim ();
+            }
+            return iter->pin;
+        }
+        // Drop the caches destroyed since
+        if (iter->table.expired ())
+        {
+            iter = m_held.erase (iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+    m_held.push_back (held_t {cacheId, table, table->claim ()});
+    return m_held.back ().pin;
+}
+
+ChunkCache::pinTable_t::pinTable_t (size_t numPins)
+    : pins (numPins),
+      numPinned (0),
+      numFree (numPins),
+      freePins (numPins)
+{
+    // Handed out from the back, lowest first
+    for (size_t pin = 0; pin < numPins; ++pin)
+    {
+        freePins[pin] = numPins - pin - 1;
+    }
+}
+
+size_t ChunkCache::pinTable_t::claim ()
+{
+    std::lock_guard<std::mutex> guard (lock);
+    if (freePins.empty ())
+    {
+        return NO_PIN;
+    }
+    size_t pin = freePins.back ();
+    freePins.pop_back ();
+    --numFree;
+    return pin;
+}
+
+void ChunkCache::pinTable_t::release (size_t pin)
+{
+    if (pins[pin].data)
+    {
+        pins[pin].data.reset ();
+        --numPinned;
+    }
+    std::lock_guard<std::mutex> guard (lock);
+    freePins.push_back (pin);
+    ++numFree;
+}
+
+ChunkCache::ThreadPins& ChunkCache::getThreadPins ()
+{
+    static thread_local ThreadPins threadPins;
+    return threadPins;
+}
+
+ChunkCache::ChunkCache (const std::string& fileName, uint64_t dataOffset, uint64_t dataSize,
+                        size_t chunkSize, size_t memoryBudget,
+                        std::vector<uint64_t> chunkIndex)
+    : m_fd (open (fileName.c_str (), O_RDONLY)),
+      m_dataOffset (dataOffset),
+      m_dataSize (dataSize),
+      m_chunkSize (chunkSize),
+      m_capacity (memoryBudget / chunkSize),
+      m_chunkIndex (std::move (chunkIndex)),
+      m_id (nextCacheId++),
+      m_pinTable (std::make_shared<pinTable_t> (NUM_PINS))
+{
+    if (m_capacity == 0)
+    {
+        m_capacity = 1;
+    }
+}
+
+ChunkCache::~ChunkCache ()
+{
+    if (m_fd >= 0)
+    {
+        close (m_fd);
+    }
+}
+
+bool ChunkCache::isOpen () const
+{
+    return m_fd >= 0;
+}
+
+uint8_t ChunkCache::get (uint64_t offset) const
+{
+    uint64_t index = offset / m_chunkSize;
+    size_t threadPin = getThreadPin ();
+    if (threadPin == NO_PIN)
+    {
+        return (*getChunk (index))[offset - (index * m_chunkSize)];
+    }
+
+    // Holding the pointer keeps the chunk alive even if the cache evicts it in
+    // the meantime
+    pin_t& pin = m_pinTable->pins[threadPin];
+    if (!pin.data || pin.index != index)
+    {
+        if (!pin.data)
+        {
+            ++m_pinTable->numPinned;
+        }
+        pin.data = getChunk (index);
+        pin.index = index;
+    }
+    return (*pin.data)[offset - (index * m_chunkSize)];
+}
+
+size_t ChunkCache::getThreadPin () const
+{
+    if (lastCacheId == m_id)
+    {
+        return lastPin;
+    }
+    size_t pin = getThreadPins ().get (m_id, m_pinTable);
+    // Threads without a pin look again on every read in case one was given back
+    if (pin != NO_PIN)
+    {
+        lastCacheId = m_id;
+        lastPin = pin;
+    }
+    return pin;
+}
+
+size_t ChunkCache::getChunkSize () const
+{
+    return m_chunkSize;
+}
+
+size_t ChunkCache::getCapacity () const
+{
+    return m_capacity;
+}
+
+ChunkCache::chunkPtr_t ChunkCache::getChunk (uint64_t index) const
+{
+    {
+        std::lock_guard<std::mutex> guard (m_lock);
+        auto found = m_lookup.find (index);
+        if (found != m_lookup.end ())
+        {
+            m_lru.splice (m_lru.begin (), m_lru, found->second);
+            return found->second->data;
+        }
+    }
+
+    // Read without holding the lock so other threads can keep hitting the cache
+    chunkPtr_t data = readChunk (index);
+
+    std::lock_guard<std::mutex> guard (m_lock);
+    auto found = m_lookup.find (index);
+    if (found != m_lookup.end ())
+    {
+        // Another thread paged the same chunk in while we were reading it
+        m_lru.splice (m_lru.begin (), m_lru, found->second);
+        return found->second->data;
+    }
+
+    m_lru.push_front (entry_t {index, data});
+    m_lookup[index] = m_lru.begin ();
+    // A pinned chunk may have been evicted already, so the pins are taken
+    // off the capacity whether or not their chunks are still in the list
+    size_t numPins = m_pinTable->numPinned.load ();
+    size_t capacity = (m_capacity > numPins) ? m_capacity - numPins : 1;
+    while (m_lru.size () > capacity)
+    {
+        m_lookup.erase (m_lru.back ().index);
+        m_lru.pop_back ();
+    }
+    return data;
+}
+
+ChunkCache::chunkPtr_t ChunkCache::readChunk (uint64_t index) const
+{
+    uint64_t start = index * m_chunkSize;
+    size_t size = (start + m_chunkSize > m_dataSize) ? m_dataSize - start : m_chunkSize;
+    auto chunk = std::make_shared<std::vector<uint8_t>> (size);
+
+    if (m_chunkIndex.empty ())
+    {
+        readBytes (chunk->data (), size, m_dataOffset + start, index);
+        return chunk;
+    }
+
+    std::vector<uint8_t> encoded (m_chunkIndex[index + 1] - m_chunkIndex[index]);
+    readBytes (encoded.data (), encoded.size (), m_chunkIndex[index], index);
+    if (!runLengthDecode (encoded.data (), encoded.size (), chunk->data (), size))
+    {
+        throw std::runtime_error ("World chunk " + std::to_string (index) + " is corrupt");
+    }
+    return chunk;
+}
+
+void ChunkCache::readBytes (uint8_t* dest, size_t size, uint64_t fileOffset, uint64_t index) const
+{
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t count = pread (m_fd, dest + done, size - done, fileOffset + done);
+        if (count <= 0)
+        {
+            throw std::runtime_error ("Failed to read world chunk " + std::to_string (index));
+        }
+        done += count;
+    }
+}
+
+} /* namespace pathFind */
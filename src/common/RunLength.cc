@@ -0,0 +1,93 @@
+// RunLength.cc
+
+#include "common/RunLength.h"
+
+#include <cstring>
+
+namespace pathFind
+{
+
+// A control byte below RUN_FLAG is followed by (control + 1) literal bytes. A
+// control byte of RUN_FLAG or above is followed by one byte that is repeated
+// (control - RUN_FLAG + MIN_RUN) times.
+const uint8_t RUN_FLAG = 128;
+const size_t MIN_RUN = 3;
+const size_t MAX_RUN = 255 - RUN_FLAG + MIN_RUN;
+const size_t MAX_LITERALS = RUN_FLAG;
+
+void runLengthEncode (const uint8_t* source, size_t size, std::vector<uint8_t>& dest)
+{
+    size_t pos = 0;
+    size_t literalStart = 0;
+    while (pos < size)
+    {
+        size_t run = 1;
+        while (pos + run < size && run < MAX_RUN && source[pos + run] == source[pos])
+        {
+            ++run;
+        }
+
+        if (run < MIN_RUN)
+        {
+            pos += run;
+            // Flush literals early rather than letting one count overflow
+            if (pos - literalStart >= MAX_LITERALS)
+            {
+                dest.push_back (static_cast<uint8_t> (MAX_LITERALS - 1));
+                dest.insert (dest.end (), source + literalStart, source + literalStart + MAX_LITERALS);
+                literalStart += MAX_LITERALS;
+            }
+            continue;
+        }
+
+        if (literalStart < pos)
+        {
+            dest.push_back (static_cast<uint8_t> (pos - literalStart - 1));
+            dest.insert (dest.end (), source + literalStart, source + pos);
+        }
+        dest.push_back (static_cast<uint8_t> (RUN_FLAG + run - MIN_RUN));
+        dest.push_back (source[pos]);
+        pos += run;
+        literalStart = pos;
+    }
+
+    if (literalStart < size)
+    {
+        dest.push_back (static_cast<uint8_t> (size - literalStart - 1));
+        dest.insert (dest.end (), source + literalStart, source + size);
+    }
+}
+
+bool runLengthDecode (const uint8_t* source, size_t sourceSize, uint8_t* dest, size_t destSize)
+{
+    const uint8_t* sourceEnd = source + sourceSize;
+    size_t written = 0;
+    while (source < sourceEnd)
+    {
+        uint8_t control = *source++;
+        if (control < RUN_FLAG)
+        {
+            size_t count = static_cast<size_t> (control) + 1;
+            if (count > static_cast<size_t> (sourceEnd - source) || count > destSize - written)
+            {
+                return false;
+            }
+            std::memcpy (dest + written, source, count);
+            source += count;
+            written += count;
+        }
+        else
+        {
+            size_t count = static_cast<size_t> (control) - RUN_FLAG + MIN_RUN;
+            if (source == sourceEnd || count > destSize - written)
+            {
+                return false;
+            }
+            std::memset (dest + written, *source++, count);
+            written += count;
+        }
+    }
+    return written == destSize;
+}
+
+} /* namespace pathFind */
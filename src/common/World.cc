@@ -1,89 +1,293 @@
 // World.cc
 
 #include "common/World.h"
+#include "common/RunLength.h"
 
+#include <algorithm>
+#include <atomic>
 #include <random>
 #include <functional>
+#include <limits>
 #include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 typedef unsigned int uint;
-typedef unsigned char uchar;
 
 namespace pathFind
 {
 
+// Binary worlds start with this magic so they can be told apart from legacy
+// worlds, which always start with the width written out in ascii.
+const char BINARY_MAGIC[4] = {'P', 'F', 'W', 'B'};
+// Version 2 added the layout of the cost plane, version 3 compressed cost planes
+// and version 4 the component label section
+const uint32_t BINARY_VERSION = 4;
+
+// Set in the header flags when the cost plane is stored as run-length encoded chunks
+const uint32_t FLAG_COMPRESSED = 1;
+
+// The label section is written at a multiple of this, which is a page boundary on
+// most systems. Loading maps it from the page it starts in whatever the page size.
+const uint64_t LABEL_ALIGNMENT = 4096;
+
+// Smallest amount of a chunked world that is paged in at once
+const size_t MIN_CHUNK_SIZE = 64 * 1024;
+
+// Extra neighbor mask bit marking the tile itself as open
+const uint8_t MASK_OPEN = 16;
+
+// Side of the square cells that generateMap carves independently
+const size_t GEN_CELL_SIDE = 256;
+
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+/**
+ * Header of a binary world file. All fields are stored in native byte order.
+ * The cost plane starts at dataOffset so the header may grow in later versions
+ * without breaking older files.
+ */
+struct binaryHeader_t
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t width;
+    uint64_t height;
+    uint32_t maxTileCost;
+    uint32_t flags;
+    uint64_t openTiles;
+    uint64_t checksum;
+    uint64_t dataOffset;
+    uint32_t layout;
+    uint32_t blockShift;
+    uint64_t labelsOffset;
+    uint64_t numComponents;
+};
+
+/**
+ * Compressed cost planes start with this at dataOffset. It is followed by
+ * numChunks + 1 offsets, relative to dataOffset, of where each encoded chunk
+ * starts and where the last one ends, and then by the chunks themselves.
+ */
+struct chunkIndexHeader_t
+{
+    uint64_t chunkSize;
+    uint64_t numChunks;
+};
+
+/**
+ * Derives an independent seed for one part of the world from the world seed
+ * (splitmix64 finalizer).
+ */
+static uint64_t mixSeed (uint64_t seed, uint64_t index)
+{
+    uint64_t z = seed + ((index + 1) * 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Finds the root of a tile's component, halving the path on the way up.
+ */
+static tileId_t findRoot (std::vector<tileId_t>& parent, tileId_t id)
+{
+    while (parent[id] != id)
+    {
+        parent[id] = parent[parent[id]];
+        id = parent[id];
+    }
+    return id;
+}
+
+/**
+ * Joins the components of two tiles. The smaller root always becomes the root of
+ * both so every root is the first tile of its component in row-major order.
+ */
+static void unite (std::vector<tileId_t>& parent, tileId_t first, tileId_t second)
+{
+    first = findRoot (parent, first);
+    second = findRoot (parent, second);
+    if (first < second)
+    {
+        parent[second] = first;
+    }
+    else if (second < first)
+    {
+        parent[first] = second;
+    }
+}
+
 World::World ()
-        : m_width (0),
+        : m_costs (nullptr),
+          m_mapping (nullptr),
+          m_mappingSize (0),
+          m_labels (nullptr),
+          m_labelMapping (nullptr),
+          m_labelMappingSize (0),
+          m_numComponents (0),
+          m_width (0),
           m_height (0),
           m_openTiles (0),
           m_maxTileCost (0)
 {
+    setLayoutFields (ROW_MAJOR, DEFAULT_BLOCK_SHIFT);
 }
 
-World::World (size_t width, size_t height)
-        : m_width (width),
+World::World (size_t width, size_t height, Layout layout, uint blockShift)
+        : m_costs (nullptr),
+          m_mapping (nullptr),
+          m_mappingSize (0),
+          m_labels (nullptr),
+          m_labelMapping (nullptr),
+          m_labelMappingSize (0),
+          m_numComponents (0),
+          m_width (width),
           m_height (height),
           m_openTiles (0),
           m_maxTileCost (0)
 {
+    setLayoutFields (layout, blockShift);
+    m_costPlane.assign (getPlaneSize (), 0);
+    m_costs = m_costPlane.data ();
+}
+
+World::~World ()
+{
+    releaseFile ();
 }
 
 void World::generateMap (float percentCarved, uint maxTileCost)
 {
+    std::random_device rd;
+    generateMap (percentCarved, maxTileCost, (static_cast<uint64_t> (rd ()) << 32) | rd ());
+}
+
+void World::generateMap (float percentCarved, uint maxTileCost, uint64_t seed, uint numThreads)
+{
+    releaseFile ();
     m_maxTileCost = maxTileCost;
     if (percentCarved > 1.0f)
     {
         percentCarved = 1.0f;
     }
+    if (numThreads == 0)
+    {
+        numThreads = 1;
+    }
+
+    m_costPlane.assign (getPlaneSize (), 0);
+    m_costs = m_costPlane.data ();
+
+    // Each cell is carved by its own walker seeded only from the world seed and
+    // the cell's index, so the world comes out the same for any number of threads.
+    size_t cellsPerRow = (m_width + GEN_CELL_SIDE - 1) / GEN_CELL_SIDE;
+    size_t cellsPerColumn = (m_height + GEN_CELL_SIDE - 1) / GEN_CELL_SIDE;
+    size_t numCells = cellsPerRow * cellsPerColumn;
+    std::vector<Point> cellStarts (numCells);
+
+    std::atomic<size_t> nextCell (0);
+    auto carveCells = [&] ()
+    {
+        for (size_t cell = nextCell++; cell < numCells; cell = nextCell++)
+        {
+            cellStarts[cell] = carveCell (cell % cellsPerRow, cell / cellsPerRow, percentCarved,
+                                          mixSeed (seed, cell));
+        }
+    };
 
-    m_tiles = std::vector<tile_t>(m_width * m_height,
-            {0, 0});
+    std::vector<std::thread> threads;
+    for (uint i = 1; i < std::min<size_t> (numThreads, numCells); ++i)
+    {
+        threads.emplace_back (carveCells);
+    }
+    carveCells ();
+    for (auto& thread : threads)
+    {
+        thread.join ();
+    }
 
-    for (uint i = 0; i < m_tiles.size (); ++i)
+    // Walkers never leave their cell so join every cell to the ones to its right
+    // and below. Those links form a spanning tree over the cells which keeps the
+    // whole carved area connected. Each corridor stays inside the two cells it joins.
+    std::minstd_rand0 gen (mixSeed (seed, numCells));
+    for (size_t cell = 0; cell < numCells; ++cell)
     {
-        m_tiles[i].id = i;
+        const Point& from = cellStarts[cell];
+        if ((cell % cellsPerRow) + 1 < cellsPerRow)
+        {
+            const Point& to = cellStarts[cell + 1];
+            carveCorridor (from.x, to.x, from.y, true, gen);
+            carveCorridor (from.y, to.y, to.x, false, gen);
+        }
+        if (cell + cellsPerRow < numCells)
+        {
+            const Point& to = cellStarts[cell + cellsPerRow];
+            carveCorridor (from.y, to.y, from.x, false, gen);
+            carveCorridor (from.x, to.x, to.y, true, gen);
+        }
     }
 
-    std::random_device rd;
-    std::minstd_rand0 gen (rd ());
+    m_openTiles = m_costPlane.size () - std::count (m_costPlane.begin (), m_costPlane.end (), 0);
+}
+
+Point World::carveCell (size_t cellX, size_t cellY, float percentCarved, uint64_t seed)
+{
+    std::minstd_rand0 gen (seed);
 
-    // Starting position in map
-    uint xMiddle = ceil (static_cast<float>(m_width) / 2);
-    uint yMiddle = ceil (static_cast<float>(m_height) / 2);
-    uint x = gen () % xMiddle + (xMiddle / 2);
-    uint y = gen () % yMiddle + (yMiddle / 2);
-    m_tiles[getID (x, y)].cost = (gen () % maxTileCost) + 1;
+    uint left = cellX * GEN_CELL_SIDE;
+    uint top = cellY * GEN_CELL_SIDE;
+    uint right = std::min (m_width, static_cast<size_t> (left + GEN_CELL_SIDE)) - 1;
+    uint bottom = std::min (m_height, static_cast<size_t> (top + GEN_CELL_SIDE)) - 1;
+
+    // Starting position in the middle half of the cell
+    uint cellWidth = right - left + 1;
+    uint cellHeight = bottom - top + 1;
+    uint xMiddle = ceil (static_cast<float>(cellWidth) / 2);
+    uint yMiddle = ceil (static_cast<float>(cellHeight) / 2);
+    uint x = left + gen () % xMiddle + (xMiddle / 2);
+    uint y = top + gen () % yMiddle + (yMiddle / 2);
+    Point start (x, y);
+    m_costPlane[getOffset (x, y)] = (gen () % m_maxTileCost) + 1;
 
     size_t numCarvedTiles = 1;
-    m_openTiles = (m_width * m_height) * percentCarved;
+    size_t toCarve = static_cast<size_t> (cellWidth) * cellHeight * percentCarved;
 
-    // "Drunkard's walk" algorithm for carving out a continuous chunk of the map.
-    while (numCarvedTiles < m_openTiles)
+    // "Drunkard's walk" algorithm for carving out a continuous chunk of the cell.
+    while (numCarvedTiles < toCarve)
     {
         // Pick a random direction to walk in
         switch (gen () % 4)
         {
         case 0:
-            if (x < m_width - 1)
+            if (x < right)
             {
                 ++x;
             }
             break;
         case 1:
-            if (y < m_height - 1)
+            if (y < bottom)
             {
                 ++y;
             }
             break;
         case 2:
-            if (x > 0)
+            if (x > left)
             {
                 --x;
             }
             break;
         case 3:
         default:
-            if (y > 0)
+            if (y > top)
             {
                 --y;
             }
@@ -91,13 +295,218 @@ void World::generateMap (float percentCarved, uint maxTileCost)
         }
 
         // If current tile is a "wall" then carve it out into open space
-        if (m_tiles[getID (x, y)].cost == 0)
+        uint8_t& cost = m_costPlane[getOffset (x, y)];
+        if (cost == 0)
         {
             ++numCarvedTiles;
-            m_tiles[getID (x, y)].cost = (gen () % maxTileCost) + 1;
+            cost = (gen () % m_maxTileCost) + 1;
         }
     }
 
+    return start;
+}
+
+void World::carveCorridor (uint from, uint to, uint fixed, bool horizontal, std::minstd_rand0& gen)
+{
+    uint low = std::min (from, to);
+    uint high = std::max (from, to);
+    for (uint i = low; i <= high; ++i)
+    {
+        uint8_t& cost = m_costPlane[horizontal ? getOffset (i, fixed) : getOffset (fixed, i)];
+        if (cost == 0)
+        {
+            cost = (gen () % m_maxTileCost) + 1;
+        }
+    }
+}
+
+void World::buildNeighborMasks ()
+{
+    size_t stride = m_width + 2;
+    m_neighborMasks.assign (stride * (m_height + 2), 0);
+    for (uint y = 0; y < m_height; ++y)
+    {
+        uint8_t* row = &m_neighborMasks[((y + 1) * stride) + 1];
+        for (uint x = 0; x < m_width; ++x)
+        {
+            row[x] = (getCostAt (getOffset (x, y)) != 0) ? MASK_OPEN : 0;
+        }
+    }
+
+    // The wall border means every tile has all four neighbors in the grid
+    for (size_t y = 1; y <= m_height; ++y)
+    {
+        uint8_t* row = &m_neighborMasks[y * stride];
+        const uint8_t* above = row - stride;
+        const uint8_t* below = row + stride;
+        for (size_t x = 1; x <= m_width; ++x)
+        {
+            uint8_t mask = ((row[x + 1] & MASK_OPEN) ? EAST : 0) |
+                           ((below[x] & MASK_OPEN) ? SOUTH : 0) |
+                           ((row[x - 1] & MASK_OPEN) ? WEST : 0) |
+                           ((above[x] & MASK_OPEN) ? NORTH : 0);
+            row[x] |= mask;
+        }
+    }
+}
+
+bool World::hasNeighborMasks () const
+{
+    return !m_neighborMasks.empty ();
+}
+
+void World::buildComponentLabels (uint numThreads)
+{
+    const tileId_t WALL = ~static_cast<tileId_t> (0);
+
+    size_t numTiles = m_width * m_height;
+    if (numThreads == 0)
+    {
+        numThreads = 1;
+    }
+    numThreads = std::max<size_t> (1, std::min<size_t> (numThreads, m_height));
+
+    // Every thread joins up the tiles within its own band of rows. Roots never
+    // leave the band they were found in so the bands need no locking.
+    std::vector<tileId_t> parent (numTiles);
+    auto labelBand = [&] (uint band)
+    {
+        size_t firstRow = (m_height * band) / numThreads;
+        size_t lastRow = (m_height * (band + 1)) / numThreads;
+        for (size_t y = firstRow; y < lastRow; ++y)
+        {
+            for (size_t x = 0; x < m_width; ++x)
+            {
+                tileId_t id = getID (x, y);
+                if (getCostAt (getOffset (x, y)) == 0)
+                {
+                    parent[id] = WALL;
+                    continue;
+                }
+                parent[id] = id;
+                if (x > 0 && parent[id - 1] != WALL)
+                {
+                    unite (parent, id, id - 1);
+                }
+                if (y > firstRow && parent[id - m_width] != WALL)
+                {
+                    unite (parent, id, id - m_width);
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint band = 1; band < numThreads; ++band)
+    {
+        threads.emplace_back (labelBand, band);
+    }
+    labelBand (0);
+    for (auto& thread : threads)
+    {
+        thread.join ();
+    }
+
+    // Stitch each band to the one above it
+    for (uint band = 1; band < numThreads; ++band)
+    {
+        size_t row = (m_height * band) / numThreads;
+        for (size_t x = 0; x < m_width; ++x)
+        {
+            tileId_t id = getID (x, row);
+            if (parent[id] != WALL && parent[id - m_width] != WALL)
+            {
+                unite (parent, id, id - m_width);
+            }
+        }
+    }
+
+    // Roots come before the rest of their component so one pass numbers them all
+    std::vector<uint32_t> labels (numTiles, 0);
+    m_numComponents = 0;
+    for (tileId_t id = 0; id < numTiles; ++id)
+    {
+        if (parent[id] == WALL)
+        {
+            continue;
+        }
+        tileId_t root = findRoot (parent, id);
+        labels[id] = (root == id) ? ++m_numComponents : labels[root];
+    }
+
+    releaseLabels ();
+    m_labelPlane = std::move (labels);
+    m_labels = m_labelPlane.data ();
+}
+
+bool World::hasComponentLabels () const
+{
+    return m_labels != nullptr;
+}
+
+size_t World::getNumComponents () const
+{
+    return m_numComponents;
+}
+
+bool World::isReachable (uint startX, uint startY, uint endX, uint endY) const
+{
+    if (startX >= m_width || startY >= m_height || endX >= m_width || endY >= m_height)
+    {
+        return false;
+    }
+    if (m_labels == nullptr)
+    {
+        return true;
+    }
+    uint32_t component = getComponent (startX, startY);
+    return component != 0 && component == getComponent (endX, endY);
+}
+
+void World::setCost (uint x, uint y, uint cost)
+{
+    // Costs are stored in a byte, anything larger would wrap around to a
+    // cheaper tile or a wall
+    if (cost > std::numeric_limits<uint8_t>::max ())
+    {
+        throw std::out_of_range ("tile cost " + std::to_string (cost) + " does not fit in a byte");
+    }
+
+    makeWritable ();
+    uint8_t& tileCost = m_costPlane[getOffset (x, y)];
+    bool wasOpen = tileCost != 0;
+    tileCost = static_cast<uint8_t> (cost);
+    bool isOpen = tileCost != 0;
+    // Kept an upper bound, algorithms rely on it to know the world is uniform
+    m_maxTileCost = std::max (m_maxTileCost, static_cast<uint> (tileCost));
+    if (wasOpen == isOpen)
+    {
+        return;
+    }
+
+    if (isOpen)
+    {
+        ++m_openTiles;
+    }
+    else
+    {
+        --m_openTiles;
+    }
+    releaseLabels ();
+    m_numComponents = 0;
+
+    if (!m_neighborMasks.empty ())
+    {
+        // Flip the bit pointing at this tile in each of its neighbors. The border
+        // may pick up bits this way but the border's masks are never read.
+        size_t stride = m_width + 2;
+        uint8_t* center = &m_neighborMasks[((y + 1) * stride) + x + 1];
+        center[0] ^= MASK_OPEN;
+        center[1] ^= WEST;
+        center[stride] ^= NORTH;
+        center[-1] ^= EAST;
+        *(center - stride) ^= SOUTH;
+    }
 }
 
 size_t World::getWidth () const
@@ -120,42 +529,507 @@ uint World::getMaxTileCost () const
     return m_maxTileCost;
 }
 
-World::tile_t World::operator() (uint column, uint row) const
+const uint8_t* World::begin () const
+{
+    return m_costs;
+}
+
+const uint8_t* World::end () const
+{
+    return (m_costs == nullptr) ? m_costs : m_costs + getPlaneSize ();
+}
+
+void World::setLayout (Layout layout, uint blockShift)
+{
+    World target (m_width, m_height, layout, blockShift);
+    for (uint y = 0; y < m_height; ++y)
+    {
+        for (uint x = 0; x < m_width; ++x)
+        {
+            target.m_costPlane[target.getOffset (x, y)] = getCostAt (getOffset (x, y));
+        }
+    }
+
+    // Labels are indexed by tile id so they carry over to the new layout as is
+    std::vector<uint32_t> labels;
+    size_t numComponents = m_numComponents;
+    if (m_labels != nullptr)
+    {
+        labels.assign (m_labels, m_labels + (m_width * m_height));
+    }
+
+    releaseFile ();
+    setLayoutFields (target.m_layout, target.m_blockShift);
+    m_costPlane = std::move (target.m_costPlane);
+    m_costs = m_costPlane.data ();
+
+    if (!labels.empty ())
+    {
+        m_labelPlane = std::move (labels);
+        m_labels = m_labelPlane.data ();
+        m_numComponents = numComponents;
+    }
+}
+
+World::Layout World::getLayout () const
+{
+    return m_layout;
+}
+
+uint World::getBlockShift () const
+{
+    return m_blockShift;
+}
+
+size_t World::getPlaneSize () const
+{
+    if (m_layout == ROW_MAJOR)
+    {
+        return m_width * m_height;
+    }
+    size_t blockSide = static_cast<size_t> (1) << m_blockShift;
+    size_t blocksPerColumn = (m_height + blockSide - 1) >> m_blockShift;
+    return m_blocksPerRow * blocksPerColumn * blockSide * blockSide;
+}
+
+void World::setLayoutFields (Layout layout, uint blockShift)
+{
+    if (blockShift > MAX_BLOCK_SHIFT)
+    {
+        blockShift = MAX_BLOCK_SHIFT;
+    }
+    m_layout = layout;
+    m_blockShift = blockShift;
+    m_blockMask = (1u << blockShift) - 1;
+    m_blocksPerRow = (m_width + m_blockMask) >> blockShift;
+}
+
+bool World::isMapped () const
 {
-    return m_tiles[getID (column, row)];
+    return m_mapping != nullptr;
 }
 
-uint World::getID(uint x, uint y) const
+bool World::isChunked () const
 {
-    return (m_width * y) + x;
+    return m_chunks != nullptr;
 }
 
-std::vector<World::tile_t>::iterator World::begin ()
+uint64_t World::computeChecksum () const
 {
-    return m_tiles.begin ();
+    uint64_t hash = FNV_OFFSET_BASIS;
+    size_t planeSize = getPlaneSize ();
+    for (size_t offset = 0; offset < planeSize; ++offset)
+    {
+        hash ^= getCostAt (offset);
+        hash *= FNV_PRIME;
+    }
+    return hash;
 }
 
-std::vector<World::tile_t>::const_iterator World::begin () const
+bool World::loadFile (const std::string& fileName, bool verifyChecksum, size_t memoryBudget)
 {
-    return m_tiles.begin ();
+    std::ifstream worldFile (fileName, std::ifstream::in | std::ifstream::binary);
+    if (!worldFile)
+    {
+        return false;
+    }
+
+    char magic[sizeof (BINARY_MAGIC)] = {};
+    worldFile.read (magic, sizeof (magic));
+    if (worldFile.gcount () == sizeof (magic) &&
+        std::memcmp (magic, BINARY_MAGIC, sizeof (magic)) == 0)
+    {
+        worldFile.close ();
+        return loadBinary (fileName, verifyChecksum, memoryBudget);
+    }
+
+    // Legacy world, rewind and parse it into memory
+    worldFile.clear ();
+    worldFile.seekg (0);
+    worldFile >> *this;
+    return !worldFile.fail ();
+}
+
+void World::writeBinary (std::ostream& stream, bool compress) const
+{
+    binaryHeader_t header {};
+    std::memcpy (header.magic, BINARY_MAGIC, sizeof (BINARY_MAGIC));
+    header.version = BINARY_VERSION;
+    header.width = m_width;
+    header.height = m_height;
+    header.maxTileCost = m_maxTileCost;
+    header.flags = compress ? FLAG_COMPRESSED : 0;
+    header.openTiles = m_openTiles;
+    header.checksum = computeChecksum ();
+    header.dataOffset = sizeof (binaryHeader_t);
+    header.layout = m_layout;
+    header.blockShift = m_blockShift;
+
+    std::vector<uint8_t> compressedPlane;
+    uint64_t planeBytes = getPlaneSize ();
+    if (compress)
+    {
+        encodeCompressed (compressedPlane);
+        planeBytes = compressedPlane.size ();
+    }
+
+    uint64_t planeEnd = header.dataOffset + planeBytes;
+    if (m_labels != nullptr)
+    {
+        header.labelsOffset = (planeEnd + LABEL_ALIGNMENT - 1) & ~(LABEL_ALIGNMENT - 1);
+        header.numComponents = m_numComponents;
+    }
+    stream.write (reinterpret_cast<const char*> (&header), sizeof (header));
+
+    if (compress)
+    {
+        stream.write (reinterpret_cast<const char*> (compressedPlane.data ()), compressedPlane.size ());
+    }
+    else if (m_costs != nullptr)
+    {
+        stream.write (reinterpret_cast<const char*> (m_costs), getPlaneSize ());
+    }
+    else
+    {
+        // Chunked worlds are copied over a chunk at a time
+        std::vector<char> buffer (m_chunks->getChunkSize ());
+        size_t planeSize = getPlaneSize ();
+        for (size_t start = 0; start < planeSize; start += buffer.size ())
+        {
+            size_t count = std::min (buffer.size (), planeSize - start);
+            for (size_t i = 0; i < count; ++i)
+            {
+                buffer[i] = static_cast<char> (getCostAt (start + i));
+            }
+            stream.write (buffer.data (), count);
+        }
+    }
+
+    if (m_labels != nullptr)
+    {
+        std::vector<char> padding (header.labelsOffset - planeEnd, 0);
+        stream.write (padding.data (), padding.size ());
+        stream.write (reinterpret_cast<const char*> (m_labels), m_width * m_height * sizeof (uint32_t));
+    }
 }
 
-std::vector<World::tile_t>::iterator World::end ()
+void World::encodeCompressed (std::vector<uint8_t>& section) const
 {
-    return m_tiles.end ();
+    size_t planeSize = getPlaneSize ();
+    chunkIndexHeader_t indexHeader {};
+    indexHeader.chunkSize = getChunkSize ();
+    indexHeader.numChunks = (planeSize + indexHeader.chunkSize - 1) / indexHeader.chunkSize;
+
+    // The index has to come first so encode every chunk before adding it
+    std::vector<uint64_t> offsets;
+    offsets.reserve (indexHeader.numChunks + 1);
+    uint64_t indexSize = sizeof (indexHeader) + ((indexHeader.numChunks + 1) * sizeof (uint64_t));
+    std::vector<uint8_t> raw (indexHeader.chunkSize);
+    std::vector<uint8_t> encoded;
+    for (size_t start = 0; start < planeSize; start += indexHeader.chunkSize)
+    {
+        offsets.push_back (indexSize + encoded.size ());
+        size_t count = std::min (static_cast<size_t> (indexHeader.chunkSize), planeSize - start);
+        const uint8_t* chunk = m_costs + start;
+        if (m_costs == nullptr)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                raw[i] = getCostAt (start + i);
+            }
+            chunk = raw.data ();
+        }
+        runLengthEncode (chunk, count, encoded);
+    }
+    offsets.push_back (indexSize + encoded.size ());
+
+    const uint8_t* indexBytes = reinterpret_cast<const uint8_t*> (&indexHeader);
+    const uint8_t* offsetBytes = reinterpret_cast<const uint8_t*> (offsets.data ());
+    section.reserve (indexSize + encoded.size ());
+    section.insert (section.end (), indexBytes, indexBytes + sizeof (indexHeader));
+    section.insert (section.end (), offsetBytes, offsetBytes + (offsets.size () * sizeof (uint64_t)));
+    section.insert (section.end (), encoded.begin (), encoded.end ());
 }
 
-std::vector<World::tile_t>::const_iterator World::end () const
+bool World::readChunkIndex (int fd, uint64_t dataOffset, uint64_t fileSize,
+                            size_t& chunkSize, std::vector<uint64_t>& chunkIndex)
 {
-    return m_tiles.end ();
+    chunkIndexHeader_t indexHeader {};
+    if (pread (fd, &indexHeader, sizeof (indexHeader), dataOffset) < static_cast<ssize_t> (sizeof (indexHeader)))
+    {
+        return false;
+    }
+
+    size_t planeSize = getPlaneSize ();
+    if (indexHeader.chunkSize == 0 ||
+        indexHeader.numChunks != (planeSize + indexHeader.chunkSize - 1) / indexHeader.chunkSize ||
+        indexHeader.numChunks >= fileSize / sizeof (uint64_t))
+    {
+        return false;
+    }
+
+    chunkIndex.resize (indexHeader.numChunks + 1);
+    ssize_t indexBytes = chunkIndex.size () * sizeof (uint64_t);
+    if (pread (fd, chunkIndex.data (), indexBytes, dataOffset + sizeof (indexHeader)) < indexBytes)
+    {
+        return false;
+    }
+
+    // Make the offsets absolute and check they stay in order and within the file
+    uint64_t previous = 0;
+    for (uint64_t& offset : chunkIndex)
+    {
+        offset += dataOffset;
+        if (offset < previous || offset > fileSize)
+        {
+            return false;
+        }
+        previous = offset;
+    }
+
+    chunkSize = indexHeader.chunkSize;
+    return true;
+}
+
+bool World::loadBinary (const std::string& fileName, bool verifyChecksum, size_t memoryBudget)
+{
+    releaseFile ();
+
+    int fd = open (fileName.c_str (), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    // Older headers are shorter, whatever they lack stays zero
+    struct stat fileStat;
+    binaryHeader_t header {};
+    if (fstat (fd, &fileStat) != 0 ||
+        pread (fd, &header, sizeof (header), 0) < static_cast<ssize_t> (offsetof (binaryHeader_t, layout)))
+    {
+        close (fd);
+        return false;
+    }
+
+    if (header.version < 2)
+    {
+        // Older headers end before the layout fields
+        header.layout = ROW_MAJOR;
+        header.blockShift = DEFAULT_BLOCK_SHIFT;
+    }
+    if (header.version < 4)
+    {
+        // The bytes after the header are part of the cost plane
+        header.labelsOffset = 0;
+        header.numComponents = 0;
+    }
+
+    // The dimensions are checked before anything multiplies them, a corrupt
+    // header could make the products wrap around and pass the size checks.
+    // Raw planes have to fit in the file, compressed ones at least have to
+    // be addressable.
+    uint64_t fileSize = fileStat.st_size;
+    bool compressed = (header.version >= 3) && (header.flags & FLAG_COMPRESSED);
+    if (header.height == 0 || header.dataOffset > fileSize ||
+        header.width > std::numeric_limits<uint>::max () || header.height > std::numeric_limits<uint>::max () ||
+        (!compressed && header.width > (fileSize - header.dataOffset) / header.height))
+    {
+        close (fd);
+        return false;
+    }
+
+    m_width = header.width;
+    m_height = header.height;
+    setLayoutFields (static_cast<Layout> (header.layout), header.blockShift);
+    m_costPlane.clear ();
+    m_costPlane.shrink_to_fit ();
+    m_costs = nullptr;
+    size_t planeSize = getPlaneSize ();
+    size_t chunkSize = getChunkSize ();
+    std::vector<uint64_t> chunkIndex;
+    if (header.version > BINARY_VERSION || header.layout > MORTON ||
+        header.blockShift > MAX_BLOCK_SHIFT ||
+        (!compressed && planeSize > fileSize - header.dataOffset) ||
+        (compressed && !readChunkIndex (fd, header.dataOffset, fileSize, chunkSize, chunkIndex)) ||
+        (header.labelsOffset != 0 && !mapLabels (fd, header.labelsOffset, fileSize)))
+    {
+        close (fd);
+        m_width = 0;
+        m_height = 0;
+        setLayoutFields (ROW_MAJOR, DEFAULT_BLOCK_SHIFT);
+        m_costs = m_costPlane.data ();
+        return false;
+    }
+
+    if (memoryBudget == AUTO_MEMORY_BUDGET)
+    {
+        memoryBudget = static_cast<size_t> (sysconf (_SC_PHYS_PAGES)) * sysconf (_SC_PAGE_SIZE) / 2;
+    }
+
+    if (!compressed && planeSize <= memoryBudget)
+    {
+        void* mapping = mmap (nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping stays valid after the descriptor is closed
+        close (fd);
+        if (mapping == MAP_FAILED)
+        {
+            releaseFile ();
+            return false;
+        }
+        m_mapping = mapping;
+        m_mappingSize = fileStat.st_size;
+        m_costs = static_cast<const uint8_t*> (mapping) + header.dataOffset;
+    }
+    else
+    {
+        // Compressed worlds always go through the cache, which decompresses
+        // each chunk the first time it is touched.
+        close (fd);
+        m_chunks.reset (new ChunkCache (fileName, header.dataOffset, planeSize,
+                                        chunkSize, memoryBudget, std::move (chunkIndex)));
+        if (!m_chunks->isOpen ())
+        {
+            releaseFile ();
+            return false;
+        }
+    }
+
+    m_maxTileCost = header.maxTileCost;
+    m_openTiles = header.openTiles;
+    m_numComponents = header.numComponents;
+
+    if (verifyChecksum)
+    {
+        // A corrupt compressed chunk fails to decode before the sums can differ
+        bool valid;
+        try
+        {
+            valid = computeChecksum () == header.checksum;
+        }
+        catch (std::runtime_error& e)
+        {
+            valid = false;
+        }
+        if (!valid)
+        {
+            releaseFile ();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool World::mapLabels (int fd, uint64_t labelsOffset, uint64_t fileSize)
+{
+    uint64_t labelBytes = m_width * m_height * sizeof (uint32_t);
+    if (labelsOffset % sizeof (uint32_t) != 0 || labelsOffset > fileSize ||
+        labelBytes > fileSize - labelsOffset)
+    {
+        return false;
+    }
+
+    // Mapped on its own so the labels stay lazily paged in even when the costs are
+    // chunked. Looking up a label only ever touches one page. Mappings have to
+    // start on a page, so this one starts on the page holding the first label.
+    uint64_t pageSize = static_cast<uint64_t> (sysconf (_SC_PAGE_SIZE));
+    uint64_t mapOffset = labelsOffset - labelsOffset % pageSize;
+    size_t mapSize = labelBytes + (labelsOffset - mapOffset);
+    void* mapping = mmap (nullptr, mapSize, PROT_READ, MAP_PRIVATE, fd, mapOffset);
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+    m_labelMapping = mapping;
+    m_labelMappingSize = mapSize;
+    m_labels = reinterpret_cast<const uint32_t*> (static_cast<const char*> (mapping) + (labelsOffset - mapOffset));
+    return true;
+}
+
+void World::releaseLabels ()
+{
+    if (m_labelMapping != nullptr)
+    {
+        munmap (m_labelMapping, m_labelMappingSize);
+        m_labelMapping = nullptr;
+        m_labelMappingSize = 0;
+    }
+    m_labelPlane.clear ();
+    m_labelPlane.shrink_to_fit ();
+    m_labels = nullptr;
+}
+
+size_t World::getChunkSize () const
+{
+    // Page in whole blocks at a time so a chunk covers a square area of the
+    // world. Row-major worlds just get cut into equal runs of tiles.
+    size_t chunkSize = MIN_CHUNK_SIZE;
+    if (m_layout != ROW_MAJOR)
+    {
+        chunkSize = std::max (chunkSize, static_cast<size_t> (1) << (2 * m_blockShift));
+    }
+    return chunkSize;
+}
+
+void World::makeWritable ()
+{
+    if (m_mapping == nullptr && m_chunks == nullptr)
+    {
+        return;
+    }
+
+    std::vector<uint8_t> plane (getPlaneSize ());
+    for (size_t offset = 0; offset < plane.size (); ++offset)
+    {
+        plane[offset] = getCostAt (offset);
+    }
+
+    // Not releaseFile as the masks and labels still describe this world
+    if (m_mapping != nullptr)
+    {
+        munmap (m_mapping, m_mappingSize);
+        m_mapping = nullptr;
+        m_mappingSize = 0;
+    }
+    m_chunks.reset ();
+    m_costPlane = std::move (plane);
+    m_costs = m_costPlane.data ();
+}
+
+void World::releaseFile ()
+{
+    if (m_mapping != nullptr)
+    {
+        munmap (m_mapping, m_mappingSize);
+        m_mapping = nullptr;
+        m_mappingSize = 0;
+    }
+    m_chunks.reset ();
+    m_costs = m_costPlane.data ();
+
+    // Whatever replaces the costs will need its own masks and labels
+    m_neighborMasks.clear ();
+    releaseLabels ();
+    m_numComponents = 0;
 }
 
 std::ostream& operator<< (std::ostream& stream, const World& world)
 {
     stream << world.m_width << "\n" << world.m_height << "\n" << world.m_maxTileCost << "\n";
-    for (auto& tile : world.m_tiles)
+    if (world.m_layout == World::ROW_MAJOR && world.m_costs != nullptr)
     {
-        stream << static_cast<uchar> (tile.cost);
+        stream.write (reinterpret_cast<const char*> (world.m_costs), world.m_width * world.m_height);
+    }
+    else
+    {
+        // Legacy worlds are always row-major
+        for (uint y = 0; y < world.m_height; ++y)
+        {
+            for (uint x = 0; x < world.m_width; ++x)
+            {
+                stream << static_cast<char> (world (x, y).cost);
+            }
+        }
     }
     stream << "\n";
     return stream;
@@ -163,15 +1037,20 @@ std::ostream& operator<< (std::ostream& stream, const World& world)
 
 std::istream& operator>> (std::istream& stream, World& world)
 {
+    world.releaseFile ();
     stream >> world.m_width >> world.m_height >> world.m_maxTileCost;
     stream.ignore (1);
-    world.m_tiles.resize(world.m_width * world.m_height);
+    world.setLayoutFields (World::ROW_MAJOR, World::DEFAULT_BLOCK_SHIFT);
+    world.m_costPlane.resize(world.m_width * world.m_height);
+    world.m_costs = world.m_costPlane.data ();
+
+    // Pull the whole cost plane in with one read instead of a get () per tile
+    stream.read (reinterpret_cast<char*> (world.m_costPlane.data ()), world.m_costPlane.size ());
 
-    for (uint i = 0; i < world.m_tiles.size (); ++i)
+    world.m_openTiles = 0;
+    for (uint8_t cost : world.m_costPlane)
     {
-        world.m_tiles[i].cost = static_cast<uint> (stream.get ());
-        world.m_tiles[i].id = i;
-        if (world.m_tiles[i].cost != 0)
+        if (cost != 0)
         {
             ++world.m_openTiles;
         }
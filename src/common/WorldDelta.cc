@@ -0,0 +1,138 @@
+// WorldDelta.cc
+
+#include "common/WorldDelta.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace pathFind
+{
+
+const char DELTA_MAGIC[4] = {'P', 'F', 'W', 'D'};
+const uint32_t DELTA_VERSION = 1;
+
+// Updates are packed without padding on disk
+const size_t UPDATE_SIZE = sizeof (tileId_t) + sizeof (uint8_t);
+
+/**
+ * Header of a delta file. All fields are stored in native byte order.
+ */
+struct deltaHeader_t
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t width;
+    uint64_t height;
+    uint64_t numUpdates;
+};
+
+WorldDelta::WorldDelta ()
+    : m_width (0),
+      m_height (0)
+{
+}
+
+WorldDelta::WorldDelta (size_t width, size_t height)
+    : m_width (width),
+      m_height (height)
+{
+}
+
+void WorldDelta::add (uint x, uint y, uint cost)
+{
+    m_updates.push_back ({(static_cast<tileId_t> (m_width) * y) + x, static_cast<uint8_t> (cost)});
+}
+
+bool WorldDelta::loadFile (const std::string& fileName)
+{
+    std::ifstream deltaFile (fileName, std::ifstream::in | std::ifstream::binary | std::ifstream::ate);
+    uint64_t fileSize = deltaFile.tellg ();
+    deltaFile.seekg (0);
+    deltaHeader_t header {};
+    deltaFile.read (reinterpret_cast<char*> (&header), sizeof (header));
+    if (!deltaFile || std::memcmp (header.magic, DELTA_MAGIC, sizeof (DELTA_MAGIC)) != 0 ||
+        header.version > DELTA_VERSION)
+    {
+        return false;
+    }
+
+    // Checked before allocating so a corrupt count can't ask for more than
+    // the file holds
+    if (header.numUpdates > (fileSize - sizeof (header)) / UPDATE_SIZE)
+    {
+        return false;
+    }
+
+    std::vector<char> packed (header.numUpdates * UPDATE_SIZE);
+    deltaFile.read (packed.data (), packed.size ());
+    if (!deltaFile)
+    {
+        return false;
+    }
+
+    m_width = header.width;
+    m_height = header.height;
+    m_updates.resize (header.numUpdates);
+    tileId_t numTiles = static_cast<tileId_t> (m_width) * m_height;
+    for (size_t i = 0; i < m_updates.size (); ++i)
+    {
+        std::memcpy (&m_updates[i].id, &packed[i * UPDATE_SIZE], sizeof (tileId_t));
+        std::memcpy (&m_updates[i].cost, &packed[(i * UPDATE_SIZE) + sizeof (tileId_t)], sizeof (uint8_t));
+        if (m_updates[i].id >= numTiles)
+        {
+            m_updates.clear ();
+            return false;
+        }
+    }
+    return true;
+}
+
+void WorldDelta::write (std::ostream& stream) const
+{
+    deltaHeader_t header {};
+    std::memcpy (header.magic, DELTA_MAGIC, sizeof (DELTA_MAGIC));
+    header.version = DELTA_VERSION;
+    header.width = m_width;
+    header.height = m_height;
+    header.numUpdates = m_updates.size ();
+    stream.write (reinterpret_cast<const char*> (&header), sizeof (header));
+
+    std::vector<char> packed (m_updates.size () * UPDATE_SIZE);
+    for (size_t i = 0; i < m_updates.size (); ++i)
+    {
+        std::memcpy (&packed[i * UPDATE_SIZE], &m_updates[i].id, sizeof (tileId_t));
+        std::memcpy (&packed[(i * UPDATE_SIZE) + sizeof (tileId_t)], &m_updates[i].cost, sizeof (uint8_t));
+    }
+    stream.write (packed.data (), packed.size ());
+}
+
+bool WorldDelta::applyTo (World& world) const
+{
+    if (world.getWidth () != m_width || world.getHeight () != m_height)
+    {
+        return false;
+    }
+
+    for (const update_t& update : m_updates)
+    {
+        world.setCost (update.id % m_width, update.id / m_width, update.cost);
+    }
+    return true;
+}
+
+const std::vector<WorldDelta::update_t>& WorldDelta::getUpdates () const
+{
+    return m_updates;
+}
+
+size_t WorldDelta::getWidth () const
+{
+    return m_width;
+}
+
+size_t WorldDelta::getHeight () const
+{
+    return m_height;
+}
+
+} /* namespace pathFind */
@@ -11,6 +11,7 @@
 
 #include "gui/WorldViewport.h"
 #include "common/Results.h"
+#include "algorithms/SolverRegistry.h"
 
 namespace pathFind
 {
@@ -545,31 +546,59 @@ void WorldViewport::loadWorld ()
 
     std::string worldFileName = "../worlds/" + m_worldName + ".world";
     Log::logInfo("Created world: " + worldFileName);
-    std::ifstream worldFile(worldFileName, std::ifstream::in | std::ifstream::binary);
-    if (!worldFile)
+    if (!m_world.loadFile (worldFileName))
     {
         Log::logError ("WorldViewport either could not find or could not open "
                 + worldFileName);
         return;
     }
-
-    worldFile >> m_world;
+    m_world.buildNeighborMasks ();
 
     resetEndPoints ();
 
     updateGraphicTilesScaleAndPos ();
 }
 
+// Parallel algorithms run with a set number of threads have their results
+// named <algorithm>_<number of threads>, like the executables run with
+// --threads, so those names pick the algorithm and its thread count
+static std::unique_ptr<Solver> createSolver (const std::string& resultName, solveOptions_t& options)
+{
+    const SolverRegistry& registry = SolverRegistry::getDefault ();
+    size_t split = resultName.find_last_of ('_');
+    if (!registry.contains (resultName) && split != std::string::npos && split + 1 < resultName.size () &&
+            resultName.find_first_not_of ("0123456789", split + 1) == std::string::npos)
+    {
+        options.numThreads = std::stoul (resultName.substr (split + 1));
+        return registry.create (resultName.substr (0, split));
+    }
+    return registry.create (resultName);
+}
+
 void WorldViewport::runPathFinding (const std::string& algorithm)
 {
     setMode (VIEW);
-    std::string command;
-    command = "./" + algorithm + " " + m_worldName + " " +
-            std::to_string (m_start.x) + " " +
-            std::to_string (m_start.y) + " " +
-            std::to_string (m_end.x) + " " +
-            std::to_string (m_end.y);
-    system (command.c_str ());
+    // Solve on the world already loaded instead of starting the algorithm's
+    // executable, which would have to load it all over again
+    solveOptions_t options;
+    std::unique_ptr<Solver> solver = createSolver (algorithm, options);
+    if (!solver)
+    {
+        Log::logError ("No algorithm called " + algorithm);
+        return;
+    }
+    solver->prepare (m_world, "../worlds/" + m_worldName + ".world");
+    pathResult_t result = solver->solve (m_world, m_start, m_end, options);
+    if (!result.found)
+    {
+        Log::logError ("No path exists between the start and end points.");
+        return;
+    }
+    #ifdef GEN_STATS
+        writeResults (result.path, result.stats, m_worldName, algorithm, result.ms, result.totalCost);
+    #else
+        writeResults (result.path, m_worldName, algorithm, result.ms, result.totalCost);
+    #endif
     m_threadColors.clear ();
 }
 
@@ -0,0 +1,322 @@
+/**
+ * File        : ClusterGraphTest.cc
+ * Description : Builds the ClusterGraph of seeded worlds and checks every
+ *               distance in it against a search that stays inside the
+ *               cluster, and that entrances link facing tiles both ways. Also
+ *               checks that a saved graph loads back the same and is turned
+ *               away once the world changes or the file is corrupt, and that
+ *               hpaStar finds the same paths whether it built its graph or
+ *               loaded it from the file.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "algorithms/tools/ClusterGraph.h"
+#include "algorithms/SolverRegistry.h"
+
+using namespace pathFind;
+
+// Not multiples of the cluster size so the clusters on the edges are cut short
+const uint WIDTH = 300;
+const uint HEIGHT = 200;
+const uint CLUSTER_SIZE = 32;
+const uint NUM_THREADS = 4;
+const uint NUM_QUERIES = 100;
+
+/**
+ * Checks the distances between the nodes of every cluster and the links
+ * across its borders.
+ * @return An empty string if the graph is right, else the first problem found.
+ */
+std::string checkGraph (const World& world, const ClusterGraph& graph);
+
+// Whether both graphs have the same nodes, links and distances
+bool compareGraphs (const ClusterGraph& expected, const ClusterGraph& loaded);
+
+/**
+ * Tampers with the counts and nodes of a saved graph one at a time.
+ * @return False if any of the tampered files loaded. The file is left as it was.
+ */
+bool checkCorrupted (const World& world, const std::string& graphFile);
+
+// Solves the same random queries for the same seed
+std::vector<pathResult_t> solveQueries (const World& world, Solver& solver, uint64_t seed);
+
+int main ()
+{
+    boost::filesystem::path tempDir = boost::filesystem::temp_directory_path () /
+                                      boost::filesystem::unique_path ("clusterGraphTest-%%%%-%%%%");
+    boost::filesystem::create_directories (tempDir);
+
+    bool passed = true;
+    for (uint64_t seed : {1, 2})
+    {
+        World world (WIDTH, HEIGHT);
+        world.generateMap (0.5f, 9, seed, NUM_THREADS);
+        world.buildNeighborMasks ();
+        std::string worldFile = (tempDir / ("world" + std::to_string (seed) + ".world")).string ();
+        boost::filesystem::path graphFile (worldFile);
+        graphFile.replace_extension (ClusterGraph::CLUSTER_GRAPH_EXT);
+
+        ClusterGraph graph;
+        graph.build (world, CLUSTER_SIZE, NUM_THREADS);
+        std::string problem = checkGraph (world, graph);
+        if (!problem.empty ())
+        {
+            std::cout << "seed " << seed << ": " << problem << std::endl;
+            passed = false;
+        }
+
+        ClusterGraph loaded;
+        if (!graph.save (graphFile.string (), world) || !loaded.load (graphFile.string (), world) ||
+            !compareGraphs (graph, loaded))
+        {
+            std::cout << "seed " << seed << ": the saved graph did not load back the same" << std::endl;
+            passed = false;
+        }
+        boost::filesystem::remove (graphFile);
+
+        // The first solver builds and saves the graph. Once it is gone no
+        // solver holds the graph any more, so the second loads the file.
+        std::unique_ptr<Solver> solver = SolverRegistry::getDefault ().create ("hpaStar");
+        if (!solver->prepare (world, worldFile) || !boost::filesystem::exists (graphFile))
+        {
+            std::cout << "seed " << seed << ": hpaStar did not save its graph" << std::endl;
+            passed = false;
+        }
+        std::vector<pathResult_t> expected = solveQueries (world, *solver, seed);
+        solver = SolverRegistry::getDefault ().create ("hpaStar");
+        solver->prepare (world, worldFile);
+        std::vector<pathResult_t> results = solveQueries (world, *solver, seed);
+        for (uint i = 0; i < results.size (); ++i)
+        {
+            if (results[i].found != expected[i].found || results[i].totalCost != expected[i].totalCost)
+            {
+                std::cout << "seed " << seed << ": hpaStar found other paths with the saved graph" << std::endl;
+                passed = false;
+                break;
+            }
+        }
+
+        if (!checkCorrupted (world, graphFile.string ()))
+        {
+            std::cout << "seed " << seed << ": a corrupt graph file loaded" << std::endl;
+            passed = false;
+        }
+
+        // Walling off a tile changes the distances, the saved graph no longer fits
+        for (uint x = 0; x < WIDTH; ++x)
+        {
+            if (world (x, HEIGHT / 2).cost != 0)
+            {
+                world.setCost (x, HEIGHT / 2, 0);
+                break;
+            }
+        }
+        world.buildNeighborMasks ();
+        ClusterGraph stale;
+        if (stale.load (graphFile.string (), world))
+        {
+            std::cout << "seed " << seed << ": a graph loaded for a world it was not built for" << std::endl;
+            passed = false;
+        }
+    }
+
+    boost::filesystem::remove_all (tempDir);
+
+    if (!passed)
+    {
+        return EXIT_FAILURE;
+    }
+    std::cout << "The cluster graphs are right" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+std::string checkGraph (const World& world, const ClusterGraph& graph)
+{
+    typedef std::pair<uint, tileId_t> entry_t;
+    std::vector<uint> costs (world.getWidth () * world.getHeight ());
+
+    for (uint32_t node = 0; node < graph.getNumNodes (); ++node)
+    {
+        const ClusterGraph::node_t& from = graph.getNode (node);
+        uint cluster = graph.getCluster (from.x, from.y);
+        std::string name = "node (" + std::to_string (from.x) + ", " + std::to_string (from.y) + ")";
+        if (node < graph.getFirstNode (cluster) || node >= graph.getFirstNode (cluster + 1))
+        {
+            return name + " is not listed with its cluster";
+        }
+
+        for (uint32_t link : from.links)
+        {
+            if (link == ClusterGraph::NO_NODE)
+            {
+                continue;
+            }
+            const ClusterGraph::node_t& to = graph.getNode (link);
+            uint distance = (from.x < to.x ? to.x - from.x : from.x - to.x) +
+                            (from.y < to.y ? to.y - from.y : from.y - to.y);
+            if (distance != 1 || graph.getCluster (to.x, to.y) == cluster ||
+                (to.links[0] != node && to.links[1] != node))
+            {
+                return name + " links to a tile that is not across the border from it";
+            }
+        }
+
+        // Dijkstra over the tiles of the cluster only
+        std::fill (costs.begin (), costs.end (), ClusterGraph::INF);
+        std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>> open;
+        costs[world.getID (from.x, from.y)] = 0;
+        open.push ({0, world.getID (from.x, from.y)});
+        while (!open.empty ())
+        {
+            entry_t current = open.top ();
+            open.pop ();
+            if (current.first != costs[current.second])
+            {
+                continue;
+            }
+            Point xy (current.second % world.getWidth (), current.second / world.getWidth ());
+            uint neighbors = world.getNeighborMask (xy.x, xy.y);
+            while (neighbors != 0)
+            {
+                Point adjPoint = World::nextNeighbor (xy, neighbors);
+                World::tile_t adjTile = world (adjPoint.x, adjPoint.y);
+                if (graph.getCluster (adjPoint.x, adjPoint.y) == cluster &&
+                    current.first + adjTile.cost < costs[adjTile.id])
+                {
+                    costs[adjTile.id] = current.first + adjTile.cost;
+                    open.push ({costs[adjTile.id], adjTile.id});
+                }
+            }
+        }
+
+        for (uint32_t other = graph.getFirstNode (cluster); other < graph.getFirstNode (cluster + 1); ++other)
+        {
+            const ClusterGraph::node_t& to = graph.getNode (other);
+            uint expected = costs[world.getID (to.x, to.y)];
+            if (graph.getDistance (node, other) != expected)
+            {
+                return "the distance from " + name + " to (" + std::to_string (to.x) + ", " +
+                       std::to_string (to.y) + ") is " + std::to_string (graph.getDistance (node, other)) +
+                       " instead of " + std::to_string (expected);
+            }
+        }
+    }
+    return std::string ();
+}
+
+bool compareGraphs (const ClusterGraph& expected, const ClusterGraph& loaded)
+{
+    if (loaded.getNumNodes () != expected.getNumNodes ())
+    {
+        return false;
+    }
+    for (uint32_t node = 0; node < expected.getNumNodes (); ++node)
+    {
+        const ClusterGraph::node_t& a = expected.getNode (node);
+        const ClusterGraph::node_t& b = loaded.getNode (node);
+        if (a.x != b.x || a.y != b.y || a.links[0] != b.links[0] || a.links[1] != b.links[1])
+        {
+            return false;
+        }
+        uint cluster = expected.getCluster (a.x, a.y);
+        for (uint32_t other = expected.getFirstNode (cluster); other < expected.getFirstNode (cluster + 1); ++other)
+        {
+            if (loaded.getDistance (node, other) != expected.getDistance (node, other))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool checkCorrupted (const World& world, const std::string& graphFile)
+{
+    std::string original;
+    {
+        std::ifstream in (graphFile, std::ifstream::in | std::ifstream::binary);
+        original.assign (std::istreambuf_iterator<char> (in), std::istreambuf_iterator<char> ());
+    }
+
+    // Where things are in the file: the cluster size and node count in the
+    // header, then the first node of every cluster and the nodes themselves
+    const size_t CLUSTER_SIZE_OFFSET = 8;
+    const size_t NUM_NODES_OFFSET = 40;
+    const size_t HEADER_SIZE = 56;
+    uint64_t clusterSize;
+    std::memcpy (&clusterSize, &original[CLUSTER_SIZE_OFFSET], sizeof (clusterSize));
+    size_t numClusters = ((WIDTH + clusterSize - 1) / clusterSize) * ((HEIGHT + clusterSize - 1) / clusterSize);
+    size_t nodesOffset = HEADER_SIZE + (numClusters + 1) * sizeof (uint32_t);
+    uint32_t firstX;
+    std::memcpy (&firstX, &original[nodesOffset], sizeof (firstX));
+
+    struct corruption_t
+    {
+        size_t offset;
+        uint64_t value;
+        size_t size;
+    };
+    const std::vector<corruption_t> corruptions = {
+        // More nodes than the file holds
+        {NUM_NODES_OFFSET, static_cast<uint64_t> (1) << 40, sizeof (uint64_t)},
+        // The first nodes of the clusters out of order
+        {HEADER_SIZE + sizeof (uint32_t), 0xFFFFFFFF, sizeof (uint32_t)},
+        // A node outside the world
+        {nodesOffset, WIDTH, sizeof (uint32_t)},
+        // A node in the cluster next to its own
+        {nodesOffset, firstX < clusterSize ? firstX + clusterSize : firstX - clusterSize, sizeof (uint32_t)}};
+
+    bool passed = true;
+    for (const corruption_t& corruption : corruptions)
+    {
+        std::string corrupted = original;
+        std::memcpy (&corrupted[corruption.offset], &corruption.value, corruption.size);
+        std::ofstream (graphFile, std::ofstream::out | std::ofstream::binary) << corrupted;
+        ClusterGraph graph;
+        passed &= !graph.load (graphFile, world);
+    }
+    std::ofstream (graphFile, std::ofstream::out | std::ofstream::binary) << original;
+    return passed;
+}
+
+std::vector<pathResult_t> solveQueries (const World& world, Solver& solver, uint64_t seed)
+{
+    std::vector<Point> openTiles;
+    for (uint y = 0; y < world.getHeight (); ++y)
+    {
+        for (uint x = 0; x < world.getWidth (); ++x)
+        {
+            if (world (x, y).cost != 0)
+            {
+                openTiles.emplace_back (x, y);
+            }
+        }
+    }
+
+    std::mt19937_64 gen (seed);
+    std::uniform_int_distribution<size_t> pick (0, openTiles.size () - 1);
+    std::vector<pathResult_t> results;
+    for (uint i = 0; i < NUM_QUERIES; ++i)
+    {
+        Point start = openTiles[pick (gen)];
+        Point end = openTiles[pick (gen)];
+        results.push_back (solver.solve (world, start, end));
+    }
+    return results;
+}
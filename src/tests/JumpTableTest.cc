@@ -0,0 +1,180 @@
+/**
+ * File        : JumpTableTest.cc
+ * Description : Checks JPS and JPS+ on open uniform cost worlds scattered with
+ *               walls, where most of a path is found by jumping, against
+ *               dijkstra. Also checks that a saved JumpTable loads back the
+ *               same, is turned away once the world changes, and that a
+ *               solver prepared from the saved file finds the same paths.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "algorithms/tools/JumpTable.h"
+#include "algorithms/SolverRegistry.h"
+
+using namespace pathFind;
+
+const uint WIDTH = 150;
+const uint HEIGHT = 110;
+const uint NUM_QUERIES = 200;
+const uint DIRECTIONS[] = {World::EAST, World::SOUTH, World::WEST, World::NORTH};
+
+// Every tile open at a cost of 1 except for a seeded scattering of walls
+void makeWorld (World& world, uint wallsPerHundred, uint64_t seed);
+
+// Whether both tables give the same distance for every tile and direction
+bool compareTables (const World& world, const JumpTable& expected, const JumpTable& loaded);
+
+/**
+ * Solves random queries between open tiles with the solver and dijkstra.
+ * @return False if the solver found a path of another cost for any of them.
+ */
+bool checkSolver (const World& world, Solver& solver, uint64_t seed);
+
+int main ()
+{
+    boost::filesystem::path tempDir = boost::filesystem::temp_directory_path () /
+                                      boost::filesystem::unique_path ("jumpTableTest-%%%%-%%%%");
+    boost::filesystem::create_directories (tempDir);
+
+    bool passed = true;
+    uint64_t seed = 1;
+    for (uint wallsPerHundred : {10, 30})
+    {
+        World world (WIDTH, HEIGHT);
+        makeWorld (world, wallsPerHundred, seed);
+        std::string worldFile = (tempDir / ("world" + std::to_string (seed) + ".world")).string ();
+        boost::filesystem::path tableFile (worldFile);
+        tableFile.replace_extension (JumpTable::JUMP_TABLE_EXT);
+
+        JumpTable table;
+        table.build (world);
+        JumpTable loaded;
+        if (!table.save (tableFile.string (), world) || !loaded.load (tableFile.string (), world) ||
+            !compareTables (world, table, loaded))
+        {
+            std::cout << "The saved jump table did not load back the same" << std::endl;
+            passed = false;
+        }
+
+        for (const char* name : {"jps", "jps_plus"})
+        {
+            std::unique_ptr<Solver> solver = SolverRegistry::getDefault ().create (name);
+            solver->prepare (world, worldFile);
+            passed &= checkSolver (world, *solver, seed);
+        }
+
+        // No solver holds the table any more, so this one loads it from the file
+        boost::filesystem::remove (tableFile);
+        std::unique_ptr<Solver> solver = SolverRegistry::getDefault ().create ("jps_plus");
+        if (!solver->prepare (world, worldFile) || !boost::filesystem::exists (tableFile))
+        {
+            std::cout << "jps_plus did not save its jump table" << std::endl;
+            passed = false;
+        }
+        solver.reset ();
+        solver = SolverRegistry::getDefault ().create ("jps_plus");
+        solver->prepare (world, worldFile);
+        passed &= checkSolver (world, *solver, seed);
+
+        // Opening a wall changes the jumps, the saved table no longer fits
+        for (uint x = 0; x < WIDTH; ++x)
+        {
+            if (world (x, HEIGHT / 2).cost == 0)
+            {
+                world.setCost (x, HEIGHT / 2, 1);
+                break;
+            }
+        }
+        world.buildNeighborMasks ();
+        JumpTable stale;
+        if (stale.load (tableFile.string (), world))
+        {
+            std::cout << "A jump table loaded for a world it was not built for" << std::endl;
+            passed = false;
+        }
+        ++seed;
+    }
+
+    boost::filesystem::remove_all (tempDir);
+
+    if (!passed)
+    {
+        return EXIT_FAILURE;
+    }
+    std::cout << "JPS agreed with dijkstra" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+void makeWorld (World& world, uint wallsPerHundred, uint64_t seed)
+{
+    std::mt19937_64 gen (seed);
+    for (uint y = 0; y < world.getHeight (); ++y)
+    {
+        for (uint x = 0; x < world.getWidth (); ++x)
+        {
+            world.setCost (x, y, gen () % 100 < wallsPerHundred ? 0 : 1);
+        }
+    }
+    world.buildNeighborMasks ();
+}
+
+bool compareTables (const World& world, const JumpTable& expected, const JumpTable& loaded)
+{
+    for (uint y = 0; y < world.getHeight (); ++y)
+    {
+        for (uint x = 0; x < world.getWidth (); ++x)
+        {
+            for (uint direction : DIRECTIONS)
+            {
+                if (loaded.getDistance (x, y, direction) != expected.getDistance (x, y, direction))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool checkSolver (const World& world, Solver& solver, uint64_t seed)
+{
+    std::vector<Point> openTiles;
+    for (uint y = 0; y < world.getHeight (); ++y)
+    {
+        for (uint x = 0; x < world.getWidth (); ++x)
+        {
+            if (world (x, y).cost != 0)
+            {
+                openTiles.emplace_back (x, y);
+            }
+        }
+    }
+
+    std::unique_ptr<Solver> reference = SolverRegistry::getDefault ().create ("dijkstra");
+    std::mt19937_64 gen (seed);
+    std::uniform_int_distribution<size_t> pick (0, openTiles.size () - 1);
+    for (uint i = 0; i < NUM_QUERIES; ++i)
+    {
+        Point start = openTiles[pick (gen)];
+        Point end = openTiles[pick (gen)];
+        pathResult_t expected = reference->solve (world, start, end);
+        pathResult_t result = solver.solve (world, start, end);
+        if (result.found != expected.found || result.totalCost != expected.totalCost ||
+            (result.found && result.path.size () != expected.path.size ()))
+        {
+            std::cout << solver.getName () << " from (" << start.x << ", " << start.y << ") to (" << end.x
+                      << ", " << end.y << "): cost " << result.totalCost << " instead of "
+                      << expected.totalCost << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
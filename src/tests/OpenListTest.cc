@@ -0,0 +1,251 @@
+/**
+ * File        : OpenListTest.cc
+ * Description : Floods a seeded world with Dijkstra through each of the open
+ *               lists and checks that tiles come out in order of cost and get
+ *               the same costs as a flood through std::priority_queue. Every
+ *               open list floods twice to check that reset leaves nothing of
+ *               the first flood behind. The MultiQueue is filled and drained
+ *               from several threads at once instead, since it only pops
+ *               roughly in order.
+ */
+
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "algorithms/tools/BucketQueue.h"
+#include "algorithms/tools/DaryHeap.h"
+#include "algorithms/tools/FrontierQueue.h"
+#include "algorithms/tools/LazyQueue.h"
+#include "algorithms/tools/MultiQueue.h"
+#include "algorithms/tools/PriorityQueue.h"
+#include "algorithms/tools/RadixHeap.h"
+#include "common/World.h"
+
+using namespace pathFind;
+
+const uint WIDTH = 150;
+const uint HEIGHT = 110;
+const uint NUM_THREADS = 4;
+const uint VALUES_PER_THREAD = 20000;
+
+// The cost of reaching every tile from start, INF for the ones that can't be
+std::vector<uint> floodReference (const World& world, const Point& start);
+
+/**
+ * Floods the world from each start in turn through the open list.
+ * @return False if a tile came out of order or got another cost than floodReference.
+ */
+template <class OpenList>
+bool checkOpenList (const World& world, const std::vector<Point>& starts, const std::string& name);
+
+bool checkMultiQueue ();
+
+int main ()
+{
+    World world (WIDTH, HEIGHT);
+    world.generateMap (0.5f, 9, 1, NUM_THREADS);
+    world.buildNeighborMasks ();
+
+    // The first and the last open tile, so the floods run in both directions
+    std::vector<Point> starts;
+    for (uint id = 0; id < WIDTH * HEIGHT; ++id)
+    {
+        if (world (id % WIDTH, id / WIDTH).cost != 0)
+        {
+            starts.emplace_back (id % WIDTH, id / WIDTH);
+            break;
+        }
+    }
+    for (uint id = WIDTH * HEIGHT; id-- > 0;)
+    {
+        if (world (id % WIDTH, id / WIDTH).cost != 0)
+        {
+            starts.emplace_back (id % WIDTH, id / WIDTH);
+            break;
+        }
+    }
+
+    bool passed = true;
+    passed &= checkOpenList<PriorityQueue<>> (world, starts, "PriorityQueue");
+    passed &= checkOpenList<DaryHeap<4>> (world, starts, "DaryHeap<4>");
+    passed &= checkOpenList<DaryHeap<8>> (world, starts, "DaryHeap<8>");
+    passed &= checkOpenList<BucketQueue<>> (world, starts, "BucketQueue");
+    passed &= checkOpenList<RadixHeap<>> (world, starts, "RadixHeap");
+    passed &= checkOpenList<LazyQueue<>> (world, starts, "LazyQueue");
+    passed &= checkOpenList<FrontierQueue<>> (world, starts, "FrontierQueue");
+    passed &= checkMultiQueue ();
+
+    if (!passed)
+    {
+        return EXIT_FAILURE;
+    }
+    std::cout << "Every open list popped its tiles in order" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+std::vector<uint> floodReference (const World& world, const Point& start)
+{
+    typedef std::pair<uint, tileId_t> entry_t;
+    std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>> open;
+    std::vector<uint> costs (world.getWidth () * world.getHeight (), PathTile::INF);
+
+    costs[world.getID (start.x, start.y)] = 0;
+    open.push ({0, world.getID (start.x, start.y)});
+    while (!open.empty ())
+    {
+        entry_t current = open.top ();
+        open.pop ();
+        if (current.first != costs[current.second])
+        {
+            continue;
+        }
+
+        Point xy (current.second % world.getWidth (), current.second / world.getWidth ());
+        uint neighbors = world.getNeighborMask (xy.x, xy.y);
+        while (neighbors != 0)
+        {
+            Point adjPoint = World::nextNeighbor (xy, neighbors);
+            World::tile_t adjTile = world (adjPoint.x, adjPoint.y);
+            if (current.first + adjTile.cost < costs[adjTile.id])
+            {
+                costs[adjTile.id] = current.first + adjTile.cost;
+                open.push ({costs[adjTile.id], adjTile.id});
+            }
+        }
+    }
+    return costs;
+}
+
+template <class OpenList>
+bool checkOpenList (const World& world, const std::vector<Point>& starts, const std::string& name)
+{
+    OpenList openTiles (world.getWidth (), world.getHeight ());
+    for (const Point& start : starts)
+    {
+        std::vector<uint> expected = floodReference (world, start);
+        std::vector<uint> costs (expected.size (), PathTile::INF);
+
+        openTiles.reset (ZeroHeuristic ());
+        openTiles.push (world (start.x, start.y), start, 0);
+        uint lastCost = 0;
+        while (!openTiles.empty ())
+        {
+            PathTile current = openTiles.top ();
+            openTiles.pop ();
+            tileId_t id = current.getTile ().id;
+            if (costs[id] != PathTile::INF)
+            {
+                std::cout << name << ": tile " << id << " came out twice" << std::endl;
+                return false;
+            }
+            if (current.getBestCost () < lastCost || current.getBestCost () != expected[id])
+            {
+                std::cout << name << ": tile " << id << " came out with cost " << current.getBestCost ()
+                          << " after " << lastCost << ", its cost is " << expected[id] << std::endl;
+                return false;
+            }
+            costs[id] = current.getBestCost ();
+            lastCost = current.getBestCost ();
+
+            uint neighbors = world.getNeighborMask (current.xy ().x, current.xy ().y);
+            while (neighbors != 0)
+            {
+                Point adjPoint = World::nextNeighbor (current.xy (), neighbors);
+                World::tile_t adjTile = world (adjPoint.x, adjPoint.y);
+                if (costs[adjTile.id] == PathTile::INF)
+                {
+                    openTiles.tryUpdateBestCost (adjTile, adjPoint, current);
+                }
+            }
+        }
+
+        if (costs != expected)
+        {
+            std::cout << name << ": ran out of tiles before every reachable tile came out" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkMultiQueue ()
+{
+    MultiQueue<uint> queue (NUM_THREADS);
+    uint key;
+    uint value;
+    if (queue.tryPop (key, value))
+    {
+        std::cout << "MultiQueue: popped from an empty queue" << std::endl;
+        return false;
+    }
+
+    // Each value is pushed once with a key made from it and has to be popped once
+    std::vector<std::vector<uint>> popped (NUM_THREADS);
+    std::vector<uint> badKeys (NUM_THREADS, 0);
+    std::vector<std::thread> threads;
+    for (uint id = 0; id < NUM_THREADS; ++id)
+    {
+        threads.emplace_back ([&queue, &popped, &badKeys, id] ()
+        {
+            for (uint i = 0; i < VALUES_PER_THREAD; ++i)
+            {
+                uint pushed = i * NUM_THREADS + id;
+                queue.push (pushed % 1000, pushed);
+            }
+            uint poppedKey;
+            uint poppedValue;
+            while (popped[id].size () < VALUES_PER_THREAD)
+            {
+                // Other threads may still be pushing or hold the heaps
+                if (!queue.tryPop (poppedKey, poppedValue))
+                {
+                    std::this_thread::yield ();
+                    continue;
+                }
+                if (poppedKey != poppedValue % 1000)
+                {
+                    ++badKeys[id];
+                }
+                popped[id].push_back (poppedValue);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join ();
+    }
+
+    std::vector<uint> popCounts (NUM_THREADS * VALUES_PER_THREAD, 0);
+    for (uint id = 0; id < NUM_THREADS; ++id)
+    {
+        if (badKeys[id] != 0)
+        {
+            std::cout << "MultiQueue: values came out with the wrong key" << std::endl;
+            return false;
+        }
+        for (uint poppedValue : popped[id])
+        {
+            ++popCounts[poppedValue];
+        }
+    }
+    for (uint count : popCounts)
+    {
+        if (count != 1)
+        {
+            std::cout << "MultiQueue: a value came out " << count << " times" << std::endl;
+            return false;
+        }
+    }
+    if (queue.tryPop (key, value))
+    {
+        std::cout << "MultiQueue: popped more values than were pushed" << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,321 @@
+/**
+ * File        : SearchStateTest.cc
+ * Description : Floods a seeded world with Dijkstra, closing every tile it
+ *               expands in both a SearchState and a CompactSearchState, and
+ *               checks that the two agree on which tiles are closed and on
+ *               the path back to the start from each of them. The floods stop
+ *               partway through and start again from other tiles after a
+ *               reset, so tiles left over from an earlier search are checked
+ *               as well. The FlatHashMap and the sparse SearchState built on
+ *               it are checked against std::unordered_map on random work.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "algorithms/tools/CompactSearchState.h"
+#include "algorithms/tools/FlatHashMap.h"
+#include "algorithms/tools/PriorityQueue.h"
+#include "algorithms/tools/SearchState.h"
+#include "common/World.h"
+
+using namespace pathFind;
+
+const uint WIDTH = 150;
+const uint HEIGHT = 110;
+const uint NUM_THREADS = 4;
+const uint NUM_OPERATIONS = 200000;
+
+// Wide enough that the SearchState keeps sparse tiles, with the ids touched
+// clustered in rows around the middle the way a search touches them
+const size_t SPARSE_WIDTH = 1 << 15;
+const size_t SPARSE_HEIGHT = 1 << 15;
+
+/**
+ * Expands up to maxTiles tiles from start, closing each of them in both states.
+ */
+void flood (const World& world, const Point& start, size_t maxTiles,
+            SearchState& searchState, CompactSearchState& compactState);
+
+// Checks every tile of the world in both states
+bool compareStates (const World& world, const SearchState& searchState,
+                    const CompactSearchState& compactState, const std::string& description);
+
+// Random inserts, lookups and erases, with the map cleared and reused
+bool checkFlatHashMap ();
+
+// Random best costs and closes with resets in between
+bool checkSparseState ();
+
+// A random id from a block of rows in the middle of the sparse world
+tileId_t randomSparseId (std::mt19937_64& gen);
+
+int main ()
+{
+    World world (WIDTH, HEIGHT);
+    world.generateMap (0.5f, 9, 1, NUM_THREADS);
+    world.buildNeighborMasks ();
+
+    std::vector<Point> openTiles;
+    for (uint y = 0; y < HEIGHT; ++y)
+    {
+        for (uint x = 0; x < WIDTH; ++x)
+        {
+            if (world (x, y).cost != 0)
+            {
+                openTiles.emplace_back (x, y);
+            }
+        }
+    }
+
+    SearchState searchState (world);
+    CompactSearchState compactState (world);
+    bool passed = true;
+    // The whole world, then parts of it from the middle and the far end
+    const std::vector<std::pair<size_t, size_t>> floods =
+        {{0, openTiles.size ()}, {openTiles.size () / 2, openTiles.size () / 3}, {openTiles.size () - 1, 100}};
+    for (const auto& floodArgs : floods)
+    {
+        const Point& start = openTiles[floodArgs.first];
+        searchState.reset ();
+        compactState.reset ();
+        flood (world, start, floodArgs.second, searchState, compactState);
+        passed &= compareStates (world, searchState, compactState,
+                                 "flood from (" + std::to_string (start.x) + ", " + std::to_string (start.y) + ")");
+    }
+
+    passed &= checkFlatHashMap ();
+    passed &= checkSparseState ();
+
+    if (!passed)
+    {
+        return EXIT_FAILURE;
+    }
+    std::cout << "The search states agree" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+void flood (const World& world, const Point& start, size_t maxTiles,
+            SearchState& searchState, CompactSearchState& compactState)
+{
+    PriorityQueue<> openTiles (world.getWidth (), world.getHeight ());
+    openTiles.push (world (start.x, start.y), start, 0, start);
+    for (size_t expanded = 0; expanded < maxTiles && !openTiles.empty (); ++expanded)
+    {
+        PathTile current = openTiles.top ();
+        openTiles.pop ();
+        searchState.close (world, current);
+        compactState.close (world, current);
+
+        uint neighbors = world.getNeighborMask (current.xy ().x, current.xy ().y);
+        while (neighbors != 0)
+        {
+            Point adjPoint = World::nextNeighbor (current.xy (), neighbors);
+            World::tile_t adjTile = world (adjPoint.x, adjPoint.y);
+            if (!searchState.isClosed (adjTile.id))
+            {
+                openTiles.tryUpdateBestCost (adjTile, adjPoint, current);
+            }
+        }
+    }
+}
+
+bool compareStates (const World& world, const SearchState& searchState,
+                    const CompactSearchState& compactState, const std::string& description)
+{
+    std::vector<Point> path;
+    std::vector<Point> compactPath;
+    for (uint y = 0; y < world.getHeight (); ++y)
+    {
+        for (uint x = 0; x < world.getWidth (); ++x)
+        {
+            tileId_t id = world.getID (x, y);
+            if (searchState.isClosed (id) != compactState.isClosed (id))
+            {
+                std::cout << description << ": only one state has (" << x << ", " << y << ") closed" << std::endl;
+                return false;
+            }
+            if (!searchState.isClosed (id))
+            {
+                continue;
+            }
+
+            path.clear ();
+            compactPath.clear ();
+            searchState.getPath (id, path);
+            compactState.getPath (id, compactPath);
+            bool samePath = path.size () == compactPath.size ();
+            for (size_t i = 0; samePath && i < path.size (); ++i)
+            {
+                samePath = path[i].x == compactPath[i].x && path[i].y == compactPath[i].y;
+            }
+            if (!samePath)
+            {
+                std::cout << description << ": the paths back from (" << x << ", " << y << ") differ" << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+tileId_t randomSparseId (std::mt19937_64& gen)
+{
+    tileId_t row = SPARSE_HEIGHT / 2 + gen () % 64;
+    tileId_t column = SPARSE_WIDTH / 2 + gen () % 512;
+    return row * SPARSE_WIDTH + column;
+}
+
+bool checkFlatHashMap ()
+{
+    std::mt19937_64 gen (1);
+    FlatHashMap<uint> map;
+    std::unordered_map<tileId_t, uint> expected;
+    for (uint round = 0; round < 2; ++round)
+    {
+        for (uint i = 0; i < NUM_OPERATIONS; ++i)
+        {
+            tileId_t key = randomSparseId (gen);
+            uint value = gen () % 1000;
+            switch (gen () % 4)
+            {
+            case 0:
+                if (map.insert (key, value) != expected.emplace (key, value).second)
+                {
+                    std::cout << "FlatHashMap: insert disagrees on whether " << key << " is new" << std::endl;
+                    return false;
+                }
+                break;
+            case 1:
+                map[key] = value;
+                expected[key] = value;
+                break;
+            case 2:
+                if (map.erase (key) != (expected.erase (key) == 1))
+                {
+                    std::cout << "FlatHashMap: erase disagrees on whether " << key << " was there" << std::endl;
+                    return false;
+                }
+                break;
+            default:
+                {
+                    const uint* found = map.find (key);
+                    auto expectedIter = expected.find (key);
+                    if ((found == nullptr) != (expectedIter == expected.end ()) ||
+                        (found != nullptr && *found != expectedIter->second))
+                    {
+                        std::cout << "FlatHashMap: finds the wrong value for " << key << std::endl;
+                        return false;
+                    }
+                }
+            }
+        }
+
+        if (map.size () != expected.size ())
+        {
+            std::cout << "FlatHashMap: holds " << map.size () << " entries instead of " << expected.size () << std::endl;
+            return false;
+        }
+        for (const auto& entry : expected)
+        {
+            const uint* found = map.find (entry.first);
+            if (found == nullptr || *found != entry.second)
+            {
+                std::cout << "FlatHashMap: lost the value of " << entry.first << std::endl;
+                return false;
+            }
+        }
+
+        map.clear ();
+        for (const auto& entry : expected)
+        {
+            if (map.contains (entry.first))
+            {
+                std::cout << "FlatHashMap: still has " << entry.first << " after clear" << std::endl;
+                return false;
+            }
+        }
+        expected.clear ();
+        if (!map.empty ())
+        {
+            std::cout << "FlatHashMap: not empty after clear" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkSparseState ()
+{
+    typedef struct expectedTile_t
+    {
+        uint bestCost;
+        bool closed;
+        tileId_t bestTile;
+    } expectedTile_t;
+
+    SearchState searchState (SPARSE_WIDTH, SPARSE_HEIGHT, 1000);
+    if (searchState.isDense ())
+    {
+        std::cout << "SearchState: a search of a few tiles in a huge world got dense arrays" << std::endl;
+        return false;
+    }
+    // A workspace holding this state has to be built again for a long search
+    if (!searchState.fits (1000) || searchState.fits (SPARSE_WIDTH * SPARSE_HEIGHT / 4))
+    {
+        std::cout << "SearchState: a sparse state does not know which searches it fits" << std::endl;
+        return false;
+    }
+
+    std::mt19937_64 gen (2);
+    std::unordered_map<tileId_t, expectedTile_t> expected;
+    for (uint round = 0; round < 2; ++round)
+    {
+        for (uint i = 0; i < NUM_OPERATIONS; ++i)
+        {
+            tileId_t id = randomSparseId (gen);
+            if (gen () % 2 == 0)
+            {
+                uint bestCost = gen () % 1000;
+                tileId_t bestTile = randomSparseId (gen);
+                searchState.setBestCost (id, bestCost, bestTile);
+                auto inserted = expected.emplace (id, expectedTile_t {bestCost, false, bestTile});
+                inserted.first->second.bestCost = bestCost;
+                inserted.first->second.bestTile = bestTile;
+            }
+            else
+            {
+                searchState.close (id);
+                expected.emplace (id, expectedTile_t {PathTile::INF, false, id}).first->second.closed = true;
+            }
+        }
+
+        for (const auto& entry : expected)
+        {
+            tileId_t id = entry.first;
+            if (searchState.getBestCost (id) != entry.second.bestCost ||
+                searchState.isClosed (id) != entry.second.closed ||
+                searchState.getBestTile (id) != entry.second.bestTile)
+            {
+                std::cout << "SearchState: sparse tile " << id << " differs" << std::endl;
+                return false;
+            }
+        }
+
+        searchState.reset ();
+        for (const auto& entry : expected)
+        {
+            if (searchState.isReached (entry.first) || searchState.isClosed (entry.first))
+            {
+                std::cout << "SearchState: sparse tile " << entry.first << " was kept by reset" << std::endl;
+                return false;
+            }
+        }
+        expected.clear ();
+    }
+    return true;
+}
@@ -0,0 +1,238 @@
+/**
+ * File        : SolverTest.cc
+ * Description : Runs every algorithm of the default SolverRegistry on seeded
+ *               worlds and checks its answers against dijkstra. Algorithms
+ *               that always find the cheapest path have to match its cost,
+ *               the others have to find a valid path that is no cheaper. Each
+ *               world has a walled in pocket so some queries have no path, and
+ *               half of the worlds carry component labels so both ways of
+ *               ending such queries are checked.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "algorithms/SolverRegistry.h"
+
+using namespace pathFind;
+
+// Not multiples of the block, chunk or cluster sizes so the edges get checked
+const uint WIDTH = 150;
+const uint HEIGHT = 110;
+const uint NUM_RANDOM_QUERIES = 8;
+const uint NUM_THREADS = 4;
+
+// Top left corner of a 7x7 ring of walls around a pocket of open tiles
+const uint POCKET_X = 70;
+const uint POCKET_Y = 50;
+
+// Algorithms that may return a costlier path than dijkstra. parFringe_optimal
+// only raises its threshold optimally, it never reopens a tile it has seen.
+const std::set<std::string> INEXACT_ALGORITHMS = {"bidir", "hpaStar", "parBidir", "parDivide",
+                                                  "parDivideUnsmooth", "parFringe", "parFringe_optimal"};
+
+typedef struct query_t
+{
+    Point start;
+    Point end;
+} query_t;
+
+/**
+ * Generates a world and walls in the pocket, labeling the world afterwards
+ * so setCost does not drop the labels again.
+ */
+void makeWorld (World& world, uint maxTileCost, uint64_t seed, bool labeled);
+
+/**
+ * Random queries between open tiles, then queries out of, into and within
+ * the pocket and one that starts where it ends.
+ */
+std::vector<query_t> makeQueries (const World& world, uint64_t seed);
+
+/**
+ * Checks that the path leads from start to end one open neighbor at a time
+ * and that the cost is that of every tile entered except the end.
+ * @return An empty string if the result is valid, else what is wrong with it.
+ */
+std::string checkPath (const World& world, const query_t& query, const pathResult_t& result);
+
+int main ()
+{
+    const SolverRegistry& registry = SolverRegistry::getDefault ();
+    boost::filesystem::path tempDir = boost::filesystem::temp_directory_path () /
+                                      boost::filesystem::unique_path ("solverTest-%%%%-%%%%");
+    boost::filesystem::create_directories (tempDir);
+
+    solveOptions_t options;
+    options.numThreads = NUM_THREADS;
+
+    uint numFailures = 0;
+    uint worldNum = 0;
+    for (uint64_t seed : {1, 2})
+    {
+        for (uint maxTileCost : {1, 9})
+        {
+            for (bool labeled : {false, true})
+            {
+                World world (WIDTH, HEIGHT);
+                makeWorld (world, maxTileCost, seed, labeled);
+                std::vector<query_t> queries = makeQueries (world, seed);
+                // Every world gets its own file name so no algorithm loads
+                // data it prepared for an earlier world
+                std::string worldFile = (tempDir / ("world" + std::to_string (worldNum++) + ".world")).string ();
+
+                std::unique_ptr<Solver> reference = registry.create ("dijkstra");
+                std::vector<pathResult_t> expected;
+                for (const query_t& query : queries)
+                {
+                    expected.push_back (reference->solve (world, query.start, query.end));
+                }
+
+                for (const std::string& name : registry.getNames ())
+                {
+                    std::unique_ptr<Solver> solver = registry.create (name);
+                    solver->prepare (world, worldFile);
+                    bool exact = INEXACT_ALGORITHMS.count (name) == 0;
+                    for (uint i = 0; i < queries.size (); ++i)
+                    {
+                        const query_t& query = queries[i];
+                        pathResult_t result = solver->solve (world, query.start, query.end, options);
+
+                        std::string problem;
+                        if (result.found != expected[i].found)
+                        {
+                            problem = result.found ? "found a path that does not exist" : "found no path";
+                        }
+                        else if (result.found)
+                        {
+                            problem = checkPath (world, query, result);
+                            if (problem.empty () && exact && result.totalCost != expected[i].totalCost)
+                            {
+                                problem = "cost " + std::to_string (result.totalCost) + " instead of " +
+                                          std::to_string (expected[i].totalCost);
+                            }
+                            else if (problem.empty () && result.totalCost < expected[i].totalCost)
+                            {
+                                problem = "cost " + std::to_string (result.totalCost) + " is below the cheapest " +
+                                          std::to_string (expected[i].totalCost);
+                            }
+                        }
+
+                        if (!problem.empty ())
+                        {
+                            std::cout << name << " (seed " << seed << ", max cost " << maxTileCost
+                                      << (labeled ? ", labeled" : "") << ") from (" << query.start.x << ", "
+                                      << query.start.y << ") to (" << query.end.x << ", " << query.end.y
+                                      << "): " << problem << std::endl;
+                            ++numFailures;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    boost::filesystem::remove_all (tempDir);
+
+    if (numFailures != 0)
+    {
+        std::cout << numFailures << " queries failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Every algorithm agreed with dijkstra" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+void makeWorld (World& world, uint maxTileCost, uint64_t seed, bool labeled)
+{
+    world.generateMap (0.5f, maxTileCost, seed, NUM_THREADS);
+    for (uint y = POCKET_Y; y < POCKET_Y + 7; ++y)
+    {
+        for (uint x = POCKET_X; x < POCKET_X + 7; ++x)
+        {
+            bool ring = x == POCKET_X || x == POCKET_X + 6 || y == POCKET_Y || y == POCKET_Y + 6;
+            world.setCost (x, y, ring ? 0 : 1);
+        }
+    }
+    world.buildNeighborMasks ();
+    if (labeled)
+    {
+        world.buildComponentLabels (NUM_THREADS);
+    }
+}
+
+std::vector<query_t> makeQueries (const World& world, uint64_t seed)
+{
+    std::vector<Point> openTiles;
+    for (uint y = 0; y < world.getHeight (); ++y)
+    {
+        for (uint x = 0; x < world.getWidth (); ++x)
+        {
+            bool inPocket = x >= POCKET_X && x < POCKET_X + 7 && y >= POCKET_Y && y < POCKET_Y + 7;
+            if (world (x, y).cost != 0 && !inPocket)
+            {
+                openTiles.emplace_back (x, y);
+            }
+        }
+    }
+
+    std::mt19937_64 gen (seed);
+    std::uniform_int_distribution<size_t> pick (0, openTiles.size () - 1);
+    std::vector<query_t> queries;
+    for (uint i = 0; i < NUM_RANDOM_QUERIES; ++i)
+    {
+        queries.push_back ({openTiles[pick (gen)], openTiles[pick (gen)]});
+    }
+
+    Point inside (POCKET_X + 3, POCKET_Y + 3);
+    Point outside = openTiles[pick (gen)];
+    queries.push_back ({inside, outside});
+    queries.push_back ({outside, inside});
+    queries.push_back ({Point (POCKET_X + 1, POCKET_Y + 1), Point (POCKET_X + 5, POCKET_Y + 4)});
+    queries.push_back ({outside, outside});
+    return queries;
+}
+
+std::string checkPath (const World& world, const query_t& query, const pathResult_t& result)
+{
+    const std::vector<Point>& path = result.path;
+    if (path.empty ())
+    {
+        return "the path is empty";
+    }
+    if (path.front ().x != query.end.x || path.front ().y != query.end.y ||
+        path.back ().x != query.start.x || path.back ().y != query.start.y)
+    {
+        return "the path does not lead from the start to the end";
+    }
+
+    uint cost = 0;
+    for (uint i = 1; i < path.size (); ++i)
+    {
+        const Point& from = path[i];
+        const Point& to = path[i - 1];
+        uint distance = (from.x < to.x ? to.x - from.x : from.x - to.x) +
+                        (from.y < to.y ? to.y - from.y : from.y - to.y);
+        if (distance != 1 || to.x >= world.getWidth () || to.y >= world.getHeight () || world (to.x, to.y).cost == 0)
+        {
+            return "the path steps from (" + std::to_string (from.x) + ", " + std::to_string (from.y) +
+                   ") to (" + std::to_string (to.x) + ", " + std::to_string (to.y) + ")";
+        }
+        if (i > 1)
+        {
+            cost += world (to.x, to.y).cost;
+        }
+    }
+
+    if (cost != result.totalCost)
+    {
+        return "cost " + std::to_string (result.totalCost) + " but the path costs " + std::to_string (cost);
+    }
+    return std::string ();
+}
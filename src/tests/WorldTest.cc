@@ -0,0 +1,225 @@
+/**
+ * File        : WorldTest.cc
+ * Description : Writes seeded worlds out in the binary format in every layout,
+ *               raw and compressed, and checks that loading them back gives the
+ *               same tiles and component labels whether they are mapped or
+ *               paged in through the chunk cache. Also checks the run-length
+ *               codec on its own, that cut off files are turned away and that
+ *               setCost turns away costs that do not fit in a tile.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "common/RunLength.h"
+#include "common/World.h"
+
+using namespace pathFind;
+
+// Not multiples of the block or chunk sizes so the padding gets checked
+const uint WIDTH = 150;
+const uint HEIGHT = 110;
+const uint NUM_THREADS = 4;
+
+// Small enough that no cost plane fits and every raw world gets chunked
+const size_t SMALL_MEMORY_BUDGET = 4096;
+
+/**
+ * Compares the size, tiles and component labels of two worlds.
+ * @return An empty string if they match, else the first difference found.
+ */
+std::string compareWorlds (const World& expected, const World& loaded);
+
+// Checks every tile of the loaded world against the one it was written from
+bool checkRoundTrip (const World& world, const std::string& fileName, bool compress,
+                     size_t memoryBudget, const std::string& description);
+
+bool checkRunLength ();
+
+// Loading a file cut off partway through has to fail instead of reading past it
+bool checkTruncated (const std::string& fileName, const std::string& description);
+
+int main ()
+{
+    boost::filesystem::path tempDir = boost::filesystem::temp_directory_path () /
+                                      boost::filesystem::unique_path ("worldTest-%%%%-%%%%");
+    boost::filesystem::create_directories (tempDir);
+    std::string fileName = (tempDir / "test.world").string ();
+
+    bool passed = checkRunLength ();
+
+    const std::vector<std::pair<World::Layout, std::string>> layouts =
+        {{World::ROW_MAJOR, "row major"}, {World::BLOCKED, "blocked"}, {World::MORTON, "morton"}};
+    for (const auto& layout : layouts)
+    {
+        World world (WIDTH, HEIGHT, layout.first);
+        world.generateMap (0.5f, 9, 1, NUM_THREADS);
+        world.buildComponentLabels (NUM_THREADS);
+
+        for (bool compress : {false, true})
+        {
+            std::string description = layout.second + (compress ? ", compressed" : "");
+            passed &= checkRoundTrip (world, fileName, compress, World::AUTO_MEMORY_BUDGET, description);
+            passed &= checkRoundTrip (world, fileName, compress, SMALL_MEMORY_BUDGET, description + ", chunked");
+            passed &= checkTruncated (fileName, description);
+        }
+    }
+
+    // The legacy text format has no layout or labels, only the tiles
+    World world (WIDTH, HEIGHT);
+    world.generateMap (0.5f, 9, 2, NUM_THREADS);
+    std::stringstream text;
+    text << world;
+    World parsed;
+    text >> parsed;
+    std::string difference = compareWorlds (world, parsed);
+    if (text.fail () || !difference.empty ())
+    {
+        std::cout << "legacy: " << (text.fail () ? "failed to parse" : difference) << std::endl;
+        passed = false;
+    }
+
+    // A cost that does not fit in a byte must not wrap around to a wall
+    uint costBefore = world (0, 0).cost;
+    size_t openBefore = world.getNumOpenTiles ();
+    bool thrown = false;
+    try
+    {
+        world.setCost (0, 0, 256);
+    }
+    catch (const std::out_of_range&)
+    {
+        thrown = true;
+    }
+    if (!thrown || world (0, 0).cost != costBefore || world.getNumOpenTiles () != openBefore)
+    {
+        std::cout << "setCost took a cost of 256" << std::endl;
+        passed = false;
+    }
+
+    boost::filesystem::remove_all (tempDir);
+
+    if (!passed)
+    {
+        return EXIT_FAILURE;
+    }
+    std::cout << "Every world loaded back unchanged" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+std::string compareWorlds (const World& expected, const World& loaded)
+{
+    if (loaded.getWidth () != expected.getWidth () || loaded.getHeight () != expected.getHeight ())
+    {
+        return "loaded as " + std::to_string (loaded.getWidth ()) + "x" + std::to_string (loaded.getHeight ());
+    }
+    if (loaded.getNumOpenTiles () != expected.getNumOpenTiles () ||
+        loaded.getMaxTileCost () != expected.getMaxTileCost ())
+    {
+        return "the open tiles or the highest cost differ";
+    }
+    if (loaded.hasComponentLabels () != expected.hasComponentLabels () ||
+        loaded.getNumComponents () != expected.getNumComponents ())
+    {
+        return "the component labels differ";
+    }
+
+    for (uint y = 0; y < expected.getHeight (); ++y)
+    {
+        for (uint x = 0; x < expected.getWidth (); ++x)
+        {
+            if (loaded (x, y).cost != expected (x, y).cost ||
+                (expected.hasComponentLabels () && loaded.getComponent (x, y) != expected.getComponent (x, y)))
+            {
+                return "tile (" + std::to_string (x) + ", " + std::to_string (y) + ") differs";
+            }
+        }
+    }
+    return std::string ();
+}
+
+bool checkRoundTrip (const World& world, const std::string& fileName, bool compress,
+                     size_t memoryBudget, const std::string& description)
+{
+    {
+        std::ofstream file (fileName, std::ofstream::binary | std::ofstream::trunc);
+        world.writeBinary (file, compress);
+    }
+
+    World loaded;
+    if (!loaded.loadFile (fileName, true, memoryBudget))
+    {
+        std::cout << description << ": failed to load" << std::endl;
+        return false;
+    }
+
+    std::string difference = compareWorlds (world, loaded);
+    if (difference.empty () && loaded.getLayout () != world.getLayout ())
+    {
+        difference = "loaded in another layout";
+    }
+    if (difference.empty () && loaded.isChunked () != (compress || memoryBudget == SMALL_MEMORY_BUDGET))
+    {
+        difference = loaded.isChunked () ? "chunked" : "not chunked";
+    }
+    if (difference.empty () && loaded.computeChecksum () != world.computeChecksum ())
+    {
+        difference = "the checksums differ";
+    }
+    if (!difference.empty ())
+    {
+        std::cout << description << ": " << difference << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool checkRunLength ()
+{
+    // Long runs, short runs and noise, so both kinds of block are written
+    std::mt19937_64 gen (1);
+    std::vector<uint8_t> source;
+    while (source.size () < 100000)
+    {
+        uint8_t value = gen () % 4;
+        size_t length = gen () % 3 == 0 ? gen () % 1000 : 1;
+        source.insert (source.end (), length, value);
+    }
+
+    std::vector<uint8_t> encoded;
+    runLengthEncode (source.data (), source.size (), encoded);
+    std::vector<uint8_t> decoded (source.size ());
+    if (!runLengthDecode (encoded.data (), encoded.size (), decoded.data (), decoded.size ()) ||
+        decoded != source)
+    {
+        std::cout << "run length: decoded data differs" << std::endl;
+        return false;
+    }
+    if (runLengthDecode (encoded.data (), encoded.size (), decoded.data (), decoded.size () - 1) ||
+        runLengthDecode (encoded.data (), encoded.size () - 1, decoded.data (), decoded.size ()))
+    {
+        std::cout << "run length: corrupt data decoded" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool checkTruncated (const std::string& fileName, const std::string& description)
+{
+    boost::filesystem::resize_file (fileName, boost::filesystem::file_size (fileName) / 2);
+    World loaded;
+    if (loaded.loadFile (fileName))
+    {
+        std::cout << description << ": a truncated file loaded" << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,81 @@
+/**
+ * File        : DeltaGen.cc
+ * Description : Generates a random world delta (.delta) for a world: a number of
+ *               tiles get new costs and a few of them turn from open to wall or back.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+
+#include <boost/lexical_cast.hpp>
+
+#include "common/World.h"
+#include "common/WorldDelta.h"
+
+const std::string WORLD_DIR = "../worlds";
+const std::string WORLD_EXT = ".world";
+const std::string DELTA_EXT = ".delta";
+
+// One in this many changes toggles a tile between open and wall
+const uint TOGGLE_ODDS = 10;
+
+int main (int args, char* argv[])
+{
+    if (args != 4 && args != 5)
+    {
+        std::cout << "Incorrect inputs. Usage: <world name> <delta name> <number of changes> (seed)"
+                << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    size_t numChanges;
+    uint64_t seed = std::random_device () ();
+    try
+    {
+        numChanges = boost::lexical_cast<size_t> (argv[3]);
+        if (args == 5)
+        {
+            seed = boost::lexical_cast<uint64_t> (argv[4]);
+        }
+    }
+    catch (boost::bad_lexical_cast &e)
+    {
+        std::cout << "Number of changes and seed must be numeric" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::stringstream worldFileName;
+    worldFileName << WORLD_DIR << "/" << argv[1] << WORLD_EXT;
+    pathFind::World world;
+    if (!world.loadFile (worldFileName.str ()))
+    {
+        std::cout << "World file doesn't exist." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::mt19937_64 gen (seed);
+    pathFind::WorldDelta delta (world.getWidth (), world.getHeight ());
+    for (size_t i = 0; i < numChanges; ++i)
+    {
+        uint x = gen () % world.getWidth ();
+        uint y = gen () % world.getHeight ();
+        uint cost = world (x, y).cost;
+        if (gen () % TOGGLE_ODDS == 0)
+        {
+            cost = (cost == 0) ? (gen () % world.getMaxTileCost ()) + 1 : 0;
+        }
+        else if (cost != 0)
+        {
+            cost = (gen () % world.getMaxTileCost ()) + 1;
+        }
+        delta.add (x, y, cost);
+    }
+
+    std::ofstream deltaFile (WORLD_DIR + "/" + argv[2] + DELTA_EXT,
+            std::ofstream::out | std::ofstream::binary);
+    delta.write (deltaFile);
+
+    return EXIT_SUCCESS;
+}
@@ -30,18 +30,19 @@ int main (int args, char* argv[])
     std::stringstream fileName;
     fileName << WORLD_DIR << "/" << argv[1] << WORLD_EXT;
 
-    std::ifstream worldFile (fileName.str (),
-            std::ofstream::out | std::ofstream::binary);
-
     pathFind::World world;
-    worldFile >> world;
+    if (!world.loadFile (fileName.str ()))
+    {
+        std::cout << "World file doesn't exist." << std::endl;
+        return EXIT_FAILURE;
+    }
 
     pathFind::Point middle;
     middle.x = world.getWidth() / 2;
     middle.y = world.getHeight() / 2;
     std::deque<pathFind::Point> openList;
     openList.push_back(middle);
-    std::unordered_map<uint, pathFind::Point> closedList;
+    std::unordered_map<pathFind::tileId_t, pathFind::Point> closedList;
     while(world(middle.x, middle.y).cost == 0)
     {
         openList.pop_front();
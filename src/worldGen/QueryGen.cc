@@ -0,0 +1,93 @@
+/**
+ * File        : QueryGen.cc
+ * Description : Generates a query file (.queries) of random start and end
+ *               points on open tiles of a world, for solving in one batch.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+
+#include "common/World.h"
+#include "common/Queries.h"
+
+const std::string WORLD_DIR = "../worlds";
+const std::string WORLD_EXT = ".world";
+
+// Picks a random open tile, there must be at least one
+static pathFind::Point randomOpenTile (const pathFind::World& world, std::mt19937_64& gen)
+{
+    while (true)
+    {
+        uint x = gen () % world.getWidth ();
+        uint y = gen () % world.getHeight ();
+        if (world (x, y).cost != 0)
+        {
+            return pathFind::Point {x, y};
+        }
+    }
+}
+
+int main (int args, char* argv[])
+{
+    if (args != 4 && args != 5)
+    {
+        std::cout << "Incorrect inputs. Usage: <world name> <query file name> <number of queries> (seed)"
+                << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    size_t numQueries;
+    uint64_t seed = std::random_device () ();
+    try
+    {
+        numQueries = boost::lexical_cast<size_t> (argv[3]);
+        if (args == 5)
+        {
+            seed = boost::lexical_cast<uint64_t> (argv[4]);
+        }
+    }
+    catch (boost::bad_lexical_cast &e)
+    {
+        std::cout << "Number of queries and seed must be numeric" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::stringstream worldFileName;
+    worldFileName << WORLD_DIR << "/" << argv[1] << WORLD_EXT;
+    pathFind::World world;
+    if (!world.loadFile (worldFileName.str ()))
+    {
+        std::cout << "World file doesn't exist." << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (world.getNumOpenTiles () == 0)
+    {
+        std::cout << "World has no open tiles." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::mt19937_64 gen (seed);
+    std::vector<pathFind::query_t> queries (numQueries);
+    for (auto& query : queries)
+    {
+        // Worlds with component labels only get queries that have a path
+        do
+        {
+            query.start = randomOpenTile (world, gen);
+            query.end = randomOpenTile (world, gen);
+        } while (!world.isReachable (query.start.x, query.start.y, query.end.x, query.end.y));
+    }
+
+    if (!pathFind::writeQueries (WORLD_DIR + "/" + argv[2] + pathFind::QUERIES_EXT, queries))
+    {
+        std::cout << "Could not write the query file." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+/**
+ * File        : WorldConvert.cc
+ * Description : Converts a world file between the legacy text header format and
+ *               the binary format that can be memory mapped when loaded. Binary
+ *               worlds can also be rearranged into a blocked or Z-order layout and
+ *               compressed chunk by chunk, and have the connected component of
+ *               every tile stored alongside them.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/filesystem.hpp>
+
+#include "common/World.h"
+
+const std::string WORLD_DIR = "../worlds";
+const std::string WORLD_EXT = ".world";
+const std::string TEMP_EXT = ".tmp";
+
+int main (int args, char* argv[])
+{
+    if (args < 2 || args > 6)
+    {
+        std::cout << "Incorrect inputs. Usage: <world name> (binary|compressed|legacy) "
+                << "(row|blocked|morton) (block shift) (labels|nolabels)" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string format = (args >= 3) ? argv[2] : "binary";
+    if (format != "binary" && format != "compressed" && format != "legacy")
+    {
+        std::cout << "Unknown format " << format << ". Must be binary, compressed or legacy." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    pathFind::World::Layout layout = pathFind::World::ROW_MAJOR;
+    std::string layoutName = (args >= 4) ? argv[3] : "row";
+    if (layoutName == "blocked")
+    {
+        layout = pathFind::World::BLOCKED;
+    }
+    else if (layoutName == "morton")
+    {
+        layout = pathFind::World::MORTON;
+    }
+    else if (layoutName != "row")
+    {
+        std::cout << "Unknown layout " << layoutName << ". Must be row, blocked or morton." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    uint blockShift = pathFind::World::DEFAULT_BLOCK_SHIFT;
+    if (args >= 5)
+    {
+        try
+        {
+            blockShift = boost::lexical_cast<uint> (argv[4]);
+        }
+        catch (boost::bad_lexical_cast &e)
+        {
+            std::cout << "Block shift failed to convert to a numeric type" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (blockShift < 1 || blockShift > pathFind::World::MAX_BLOCK_SHIFT)
+        {
+            std::cout << "Block shift is out of bounds. Must be within [1, "
+                    << pathFind::World::MAX_BLOCK_SHIFT << "]." << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Component labels are built for worlds that don't have them yet unless
+    // asked not to
+    std::string labels = (args == 6) ? argv[5] : "labels";
+    if (labels != "labels" && labels != "nolabels")
+    {
+        std::cout << "Unknown label option " << labels << ". Must be labels or nolabels." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::stringstream fileName;
+    fileName << WORLD_DIR << "/" << argv[1] << WORLD_EXT;
+
+    pathFind::World world;
+    if (!world.loadFile (fileName.str (), true))
+    {
+        std::cout << "World file doesn't exist or is corrupt." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // The world may be mapped from the very file we are replacing, so write
+    // the converted world next to it and swap it in afterwards.
+    std::string tempName = fileName.str () + TEMP_EXT;
+    std::ofstream worldFile (tempName, std::ofstream::out | std::ofstream::binary);
+    if (format == "binary" || format == "compressed")
+    {
+        if (world.getLayout () != layout || world.getBlockShift () != blockShift)
+        {
+            world.setLayout (layout, blockShift);
+        }
+        if (labels == "labels" && !world.hasComponentLabels ())
+        {
+            world.buildComponentLabels (std::max (std::thread::hardware_concurrency (), 1u));
+            std::cout << "Components: " << world.getNumComponents () << std::endl;
+        }
+        else if (labels == "nolabels")
+        {
+            world.releaseLabels ();
+        }
+        world.writeBinary (worldFile, format == "compressed");
+    }
+    else
+    {
+        worldFile << world;
+    }
+    worldFile.close ();
+
+    if (!worldFile)
+    {
+        std::cout << "Failed to write " << tempName << std::endl;
+        boost::filesystem::remove (tempName);
+        return EXIT_FAILURE;
+    }
+
+    boost::filesystem::rename (tempName, fileName.str ());
+
+    return EXIT_SUCCESS;
+}
@@ -1,12 +1,15 @@
 /**
  * File        : worldGen.cc
- * Description : Generates a random world and stores it into a world file (.world)
+ * Description : Generates a random world and stores it into a binary world file (.world)
  */
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <sstream>
+#include <random>
+#include <thread>
 
 #include <boost/lexical_cast.hpp>
 #include <boost/filesystem.hpp>
@@ -19,12 +22,12 @@ const std::string PATH_EXT = ".path";
 
 int main (int args, char* argv[])
 {
-    // Program should be started with 3 command line parameters for creating
-    // a world file
-    if (args != 4 && args != 5)
+    // Program should be started with at least 3 command line parameters for
+    // creating a world file
+    if (args < 4 || args > 8)
     {
-        std::cout << "Incorrect inputs. Usage: <filename> <width> <height> (max_cost)"
-                << std::endl;
+        std::cout << "Incorrect inputs. Usage: <filename> <width> <height> (max_cost) "
+                << "(percent_carved) (seed) (threads)" << std::endl;
         return EXIT_FAILURE;
     }
 
@@ -61,7 +64,7 @@ int main (int args, char* argv[])
     }
 
     uint maxCost = 255;
-    if (args == 5)
+    if (args >= 5)
     {
         try
         {
@@ -78,10 +81,72 @@ int main (int args, char* argv[])
         }
     }
 
+    float percentCarved = 0.5f;
+    if (args >= 6)
+    {
+        try
+        {
+            percentCarved = boost::lexical_cast<float> (argv[5]);
+            if (percentCarved > 1.0f || percentCarved <= 0.0f)
+            {
+                std::cout << "percent_carved is out of bounds. Must be within (0, 1]." << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        catch (boost::bad_lexical_cast &e)
+        {
+            std::cout << "percent_carved failed to convert to a numeric type" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    uint64_t seed;
+    if (args >= 7)
+    {
+        try
+        {
+            seed = boost::lexical_cast<uint64_t> (argv[6]);
+        }
+        catch (boost::bad_lexical_cast &e)
+        {
+            std::cout << "Seed failed to convert to a numeric type" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        std::random_device rd;
+        seed = (static_cast<uint64_t> (rd ()) << 32) | rd ();
+    }
+
+    uint numThreads = std::max (std::thread::hardware_concurrency (), 1u);
+    if (args == 8)
+    {
+        try
+        {
+            numThreads = boost::lexical_cast<uint> (argv[7]);
+            if (numThreads < 1)
+            {
+                std::cout << "threads is out of bounds. Must be at least 1." << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        catch (boost::bad_lexical_cast &e)
+        {
+            std::cout << "threads failed to convert to a numeric type" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
     pathFind::World world (width, height);
-    world.generateMap (0.5f, maxCost);
+    world.generateMap (percentCarved, maxCost, seed, numThreads);
+    // Stored with the world so that queries with no path are rejected right away
+    world.buildComponentLabels (numThreads);
+
+    // Print the seed so that a world generated with a random one can be recreated
+    std::cout << "Seed: " << seed << std::endl;
 
-    worldFile << world;
+    world.writeBinary (worldFile);
 
     worldFile.close ();
 